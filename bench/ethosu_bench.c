@@ -0,0 +1,342 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Driver overhead microbenchmark, run against the host simulator. The
+ * simulated NPU completes command streams immediately, so the measured times
+ * are spent in the driver and not waiting for the NPU.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_sim.h"
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define BENCH_DEFAULT_ITERATIONS 1000
+#define BENCH_MAX_NPUS 4
+#define BENCH_MAX_CMS_WORDS 4096
+#define BENCH_REGION_SIZE 4096
+
+#define BENCH_COP_FOURCC ('1' << 24 | 'P' << 16 | 'O' << 8 | 'C')
+#define BENCH_COP_COMMAND_STREAM 2
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+enum bench_metric
+{
+    BENCH_RESERVE,
+    BENCH_INVOKE_ASYNC,
+    BENCH_IRQ_HANDLER,
+    BENCH_WAIT,
+    BENCH_RELEASE,
+    BENCH_SOFT_RESET,
+    BENCH_METRIC_COUNT
+};
+
+struct bench_samples
+{
+    uint64_t *ns;
+    size_t count;
+};
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static const char *metric_names[BENCH_METRIC_COUNT] = {
+    "reserve_driver", "invoke_async", "irq_handler", "wait", "release_driver", "soft_reset"};
+
+static const size_t cms_words_sweep[]  = {4, 256, BENCH_MAX_CMS_WORDS};
+static const int num_base_addr_sweep[] = {1, 2, ETHOSU_MAX_BASE_ADDR};
+static const int num_npus_sweep[]      = {1, 2, BENCH_MAX_NPUS};
+
+// Custom data: padding, FOURCC, COMMAND_STREAM header and command stream words. The
+// padding places the command stream on the 16 byte alignment required by the NPU.
+static uint32_t custom_data_buf[4 + BENCH_MAX_CMS_WORDS] __attribute__((aligned(16)));
+static uint32_t *const custom_data = &custom_data_buf[2];
+static uint8_t regions[ETHOSU_MAX_BASE_ADDR][BENCH_REGION_SIZE] __attribute__((aligned(16)));
+
+static struct ethosu_driver drivers[BENCH_MAX_NPUS];
+static struct ethosu_sim *sims[BENCH_MAX_NPUS];
+
+/******************************************************************************
+ * Static functions
+ ******************************************************************************/
+
+static uint64_t bench_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static uint64_t bench_percentile(const struct bench_samples *samples, const unsigned int percentile)
+{
+    return samples->ns[(samples->count - 1) * percentile / 100];
+}
+
+static void bench_sample(struct bench_samples *samples, const enum bench_metric metric, const uint64_t ns)
+{
+    samples[metric].ns[samples[metric].count++] = ns;
+}
+
+static int bench_custom_data(const size_t cms_words)
+{
+    custom_data[0] = BENCH_COP_FOURCC;
+    custom_data[1] = BENCH_COP_COMMAND_STREAM | (uint32_t)cms_words << 16;
+
+    // The simulator does not execute the command stream, zero words are NPU_OP_STOP
+    memset(&custom_data[2], 0, cms_words * sizeof(uint32_t));
+
+    return (int)((2 + cms_words) * sizeof(uint32_t));
+}
+
+static int bench_start(const int num_npus)
+{
+    const struct ethosu_sim_config config = {.latency_us = 0, .cycles_per_us = 1000};
+
+    for (int i = 0; i < num_npus; i++)
+    {
+        sims[i] = ethosu_sim_create(&config);
+        if (sims[i] == NULL || ethosu_init(&drivers[i], ethosu_sim_base_address(sims[i]), NULL, 0, 0, 0) < 0 ||
+            ethosu_sim_start(sims[i], &drivers[i]) < 0)
+        {
+            printf("Failed to initialize NPU %d\n", i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void bench_stop(const int num_npus)
+{
+    for (int i = 0; i < num_npus; i++)
+    {
+        ethosu_deinit(&drivers[i]);
+        ethosu_sim_destroy(sims[i]);
+    }
+}
+
+static uint64_t bench_irq_handler(struct ethosu_sim *sim, const uint32_t irq_handled)
+{
+    struct ethosu_sim_stats stats;
+
+    do
+    {
+        sched_yield();
+        ethosu_sim_get_stats(sim, &stats);
+    } while (stats.irq_handled != irq_handled);
+
+    return stats.irq_handler_ns;
+}
+
+static int bench_run(struct bench_samples *samples,
+                     const int iterations,
+                     const int num_npus,
+                     const int custom_data_size,
+                     const int num_base_addr)
+{
+    struct ethosu_driver *drv[BENCH_MAX_NPUS];
+    struct ethosu_sim *sim[BENCH_MAX_NPUS];
+    struct ethosu_sim_stats stats[BENCH_MAX_NPUS];
+    uint64_t base_addr[ETHOSU_MAX_BASE_ADDR];
+    size_t base_addr_size[ETHOSU_MAX_BASE_ADDR];
+    uint64_t start;
+
+    for (int i = 0; i < num_base_addr; i++)
+    {
+        base_addr[i]      = (uintptr_t)regions[i];
+        base_addr_size[i] = BENCH_REGION_SIZE;
+    }
+
+    for (int i = 0; i < BENCH_METRIC_COUNT; i++)
+    {
+        samples[i].count = 0;
+    }
+
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int n = 0; n < num_npus; n++)
+        {
+            start  = bench_time_ns();
+            drv[n] = ethosu_reserve_driver();
+            bench_sample(samples, BENCH_RESERVE, bench_time_ns() - start);
+
+            if (drv[n] == NULL)
+            {
+                printf("Failed to reserve driver\n");
+                return -1;
+            }
+
+            sim[n] = sims[drv[n] - drivers];
+            ethosu_sim_get_stats(sim[n], &stats[n]);
+
+            start = bench_time_ns();
+            if (ethosu_invoke_async(
+                    drv[n], custom_data, custom_data_size, base_addr, base_addr_size, num_base_addr, NULL) < 0)
+            {
+                printf("Failed to invoke inference\n");
+                return -1;
+            }
+            bench_sample(samples, BENCH_INVOKE_ASYNC, bench_time_ns() - start);
+        }
+
+        for (int n = 0; n < num_npus; n++)
+        {
+            // Wait for the interrupt first, so that only the driver overhead of ethosu_wait() is measured
+            bench_sample(samples, BENCH_IRQ_HANDLER, bench_irq_handler(sim[n], stats[n].irq_handled + 1));
+
+            start = bench_time_ns();
+            if (ethosu_wait(drv[n], true) != 0)
+            {
+                printf("Inference failed\n");
+                return -1;
+            }
+            bench_sample(samples, BENCH_WAIT, bench_time_ns() - start);
+
+            start = bench_time_ns();
+            ethosu_release_driver(drv[n]);
+            bench_sample(samples, BENCH_RELEASE, bench_time_ns() - start);
+
+            start = bench_time_ns();
+            if (ethosu_soft_reset(drv[n]) < 0)
+            {
+                printf("Failed to soft reset NPU\n");
+                return -1;
+            }
+            bench_sample(samples, BENCH_SOFT_RESET, bench_time_ns() - start);
+        }
+    }
+
+    return 0;
+}
+
+static void bench_report(struct bench_samples *samples,
+                         const int num_npus,
+                         const size_t cms_words,
+                         const int num_base_addr)
+{
+    for (int i = 0; i < BENCH_METRIC_COUNT; i++)
+    {
+        qsort(samples[i].ns, samples[i].count, sizeof(uint64_t), bench_compare);
+
+        printf("%4d %9zu %9d  %-16s %9llu %9llu %9llu %9llu\n",
+               num_npus,
+               cms_words * sizeof(uint32_t),
+               num_base_addr,
+               metric_names[i],
+               (unsigned long long)bench_percentile(&samples[i], 50),
+               (unsigned long long)bench_percentile(&samples[i], 90),
+               (unsigned long long)bench_percentile(&samples[i], 99),
+               (unsigned long long)samples[i].ns[samples[i].count - 1]);
+    }
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    const int iterations = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_ITERATIONS;
+    struct bench_samples samples[BENCH_METRIC_COUNT];
+    int ret = 0;
+
+    if (iterations <= 0)
+    {
+        printf("Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 0; i < BENCH_METRIC_COUNT; i++)
+    {
+        samples[i].ns = malloc((size_t)iterations * BENCH_MAX_NPUS * sizeof(uint64_t));
+        if (samples[i].ns == NULL)
+        {
+            printf("Failed to allocate samples\n");
+            return 1;
+        }
+    }
+
+    printf("%d iterations, times in ns\n", iterations);
+    printf("%4s %9s %9s  %-16s %9s %9s %9s %9s\n", "npus", "cms_bytes", "base_addr", "function", "p50", "p90",
+           "p99", "max");
+
+    for (size_t n = 0; n < ARRAY_SIZE(num_npus_sweep) && ret == 0; n++)
+    {
+        const int num_npus = num_npus_sweep[n];
+
+        if (bench_start(num_npus) < 0)
+        {
+            ret = 1;
+            break;
+        }
+
+        for (size_t c = 0; c < ARRAY_SIZE(cms_words_sweep) && ret == 0; c++)
+        {
+            const int custom_data_size = bench_custom_data(cms_words_sweep[c]);
+
+            for (size_t b = 0; b < ARRAY_SIZE(num_base_addr_sweep) && ret == 0; b++)
+            {
+                if (bench_run(samples, iterations, num_npus, custom_data_size, num_base_addr_sweep[b]) < 0)
+                {
+                    ret = 1;
+                    break;
+                }
+
+                bench_report(samples, num_npus, cms_words_sweep[c], num_base_addr_sweep[b]);
+            }
+        }
+
+        bench_stop(num_npus);
+    }
+
+    for (int i = 0; i < BENCH_METRIC_COUNT; i++)
+    {
+        free(samples[i].ns);
+    }
+
+    return ret;
+}
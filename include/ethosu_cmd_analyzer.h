@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ETHOSU_CMD_ANALYZER_H
+#define ETHOSU_CMD_ANALYZER_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+struct ethosu_operation
+{
+    uint32_t offset; // Byte offset of the operation command in the command stream
+    uint32_t opcode; // Opcode of the operation command
+};
+
+/******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+
+/**
+ * Walk a command stream and compute the bytes read and written by the NPU
+ * relative to each base address. The ranges are conservative: every byte the
+ * NPU may access is covered, but padding and skipped elements inside a range
+ * are included.
+ *
+ * Accesses that can not be bounded statically, like strided or indexed DMA
+ * transfers, extend the range of the affected region to SIZE_MAX. Command
+ * streams with branches can not be analyzed and leave 'complete' false.
+ *
+ * This function does not access the NPU and can be built and run on the host.
+ *
+ * @param cmd_stream        Command stream
+ * @param cms_length        Size in bytes of command stream
+ * @param footprint         Footprint to be filled in
+ * @return 0 on success, else negative error code
+ */
+int ethosu_analyze_command_stream(const uint8_t *cmd_stream,
+                                  const uint32_t cms_length,
+                                  struct ethosu_footprint *footprint);
+
+/**
+ * List the NPU operations of a command stream, that is the kernel operations
+ * and the DMA transfers, in the order they appear in the command stream. The
+ * offsets can be compared with the QREAD register to tell which operation the
+ * NPU is working on.
+ *
+ * This function does not access the NPU and can be built and run on the host.
+ *
+ * @param cmd_stream        Command stream
+ * @param cms_length        Size in bytes of command stream
+ * @param ops               Operations to be filled in, may be NULL if max_ops is 0
+ * @param max_ops           Size of the ops array
+ * @return Number of operations in the command stream, which may be larger than
+ *         max_ops, or negative error code
+ */
+int ethosu_command_stream_operations(const uint8_t *cmd_stream,
+                                     const uint32_t cms_length,
+                                     struct ethosu_operation *ops,
+                                     const uint32_t max_ops);
+
+/**
+ * Check if two jobs may access the same memory in a conflicting way, that is
+ * if any byte written by one job is read or written by the other job.
+ * Incomplete footprints are assumed to conflict.
+ *
+ * @param a                 Footprint of first job
+ * @param a_base_addr       Base addresses of first job
+ * @param a_num_base_addr   Number of base addresses of first job
+ * @param b                 Footprint of second job
+ * @param b_base_addr       Base addresses of second job
+ * @param b_num_base_addr   Number of base addresses of second job
+ * @return true if the jobs conflict, else false
+ */
+bool ethosu_footprint_conflict(const struct ethosu_footprint *a,
+                               const uint64_t *a_base_addr,
+                               const int a_num_base_addr,
+                               const struct ethosu_footprint *b,
+                               const uint64_t *b_base_addr,
+                               const int b_num_base_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ETHOSU_CMD_ANALYZER_H
@@ -23,6 +23,7 @@
  * Includes
  ******************************************************************************/
 
+#include "ethosu_trace.h"
 #include "ethosu_types.h"
 
 #include <stdbool.h>
@@ -47,6 +48,40 @@ extern "C" {
 #define ETHOSU_SEMAPHORE_WAIT_INFERENCE ETHOSU_SEMAPHORE_WAIT_FOREVER
 #endif
 
+// Maximum number of base addresses (regions) used by a command stream
+#define ETHOSU_MAX_BASE_ADDR 8
+
+// Maximum number of PMU event counters of any NPU
+#define ETHOSU_PMU_MAX_COUNTERS 8
+
+// Maximum number of inference jobs that can be queued per driver
+#ifndef ETHOSU_JOB_QUEUE_SIZE
+#define ETHOSU_JOB_QUEUE_SIZE 1
+#endif
+
+// Number of fast memory slots per driver, shared by networks that never run at the same time
+#ifndef ETHOSU_FAST_MEMORY_SLOTS
+#define ETHOSU_FAST_MEMORY_SLOTS 4
+#endif
+
+// Fast memory slot of a network using the whole fast memory
+#define ETHOSU_FAST_MEMORY_SLOT_NONE (-1)
+
+// Number of fast memory regions per driver, including the fast memory passed to ethosu_init()
+#ifndef ETHOSU_FAST_MEMORY_REGIONS
+#define ETHOSU_FAST_MEMORY_REGIONS 2
+#endif
+
+// Default time in microseconds the NPU is kept powered after the last power request is released
+#ifndef ETHOSU_POWER_IDLE_TIMEOUT
+#define ETHOSU_POWER_IDLE_TIMEOUT 0
+#endif
+
+// Default time in microseconds a job with deferred completion may run, 0 for no timeout
+#ifndef ETHOSU_JOB_TIMEOUT
+#define ETHOSU_JOB_TIMEOUT 0
+#endif
+
 /******************************************************************************
  * Types
  ******************************************************************************/
@@ -55,38 +90,215 @@ enum ethosu_job_state
 {
     ETHOSU_JOB_IDLE = 0,
     ETHOSU_JOB_RUNNING,
-    ETHOSU_JOB_DONE
+    ETHOSU_JOB_DONE,
+    ETHOSU_JOB_PENDING
 };
 
 enum ethosu_job_result
 {
     ETHOSU_JOB_RESULT_OK = 0,
     ETHOSU_JOB_RESULT_TIMEOUT,
-    ETHOSU_JOB_RESULT_ERROR
+    ETHOSU_JOB_RESULT_ERROR,
+    ETHOSU_JOB_RESULT_ABORTED
 };
 
+struct ethosu_driver;
+struct ethosu_network;
+struct ethosu_pmu_capture;
+struct ethosu_pmu_timeline;
+
+/**
+ * Job completion callback.
+ *
+ * @param drv       Pointer to driver handle the job was run on
+ * @param result    Result of the job, @see ethosu_wait for values
+ * @param user_arg  User argument provided when the job was submitted
+ */
+typedef void (*ethosu_job_callback)(struct ethosu_driver *drv, int result, void *user_arg);
+
 struct ethosu_job
 {
     volatile enum ethosu_job_state state;
     volatile enum ethosu_job_result result;
     const void *custom_data_ptr;
     int custom_data_size;
+    const uint8_t *cmd_stream;
+    uint32_t cms_length;
     const uint64_t *base_addr;
     const size_t *base_addr_size;
     int num_base_addr;
     void *user_arg;
+    struct ethosu_network *network; // Prepared network, NULL if not prepared
+    ethosu_job_callback callback;
+    bool deferred;                            // Completed through ethosu_defer_completion() instead of ethosu_wait()
+    bool begun;                               // ethosu_inference_begin() has been called
+    uint64_t fast_addr[ETHOSU_MAX_BASE_ADDR]; // Fast memory address per base address, 0 if not placed
+    int8_t fast_region[ETHOSU_MAX_BASE_ADDR]; // Fast memory region per base address, -1 if not placed
+    int8_t weight_stage;                      // Weight staging buffer used for base address 0, -1 if not staged
+};
+
+enum ethosu_region_access
+{
+    ETHOSU_REGION_ACCESS_DEFAULT    = 0, ///< Unknown, treated as read-write
+    ETHOSU_REGION_ACCESS_READ       = 1, ///< Only read by the NPU
+    ETHOSU_REGION_ACCESS_WRITE      = 2, ///< Only written by the NPU
+    ETHOSU_REGION_ACCESS_READ_WRITE = 3, ///< Read and written by the NPU
+    ETHOSU_REGION_ACCESS_NONE       = 4  ///< Not accessed, no cache maintenance needed
+};
+
+struct ethosu_region
+{
+    uint32_t access; // Access flags, see enum ethosu_region_access
+    size_t offset;   // Offset from base address of accessed range
+    size_t size;     // Size in bytes of accessed range, 0 for the whole region
+};
+
+struct ethosu_range
+{
+    size_t offset; // Offset from base address
+    size_t size;   // Size in bytes, 0 if not accessed, SIZE_MAX if not bounded
+};
+
+struct ethosu_footprint
+{
+    bool complete;                                   // False if the command stream could not be analyzed
+    struct ethosu_range read[ETHOSU_MAX_BASE_ADDR];  // Bytes read by the NPU per base address
+    struct ethosu_range write[ETHOSU_MAX_BASE_ADDR]; // Bytes written by the NPU per base address
+};
+
+struct ethosu_region_profile
+{
+    uint32_t region_mask;                                    // Base addresses with a REGIONCFG set by the profile
+    uint8_t region_cfg[ETHOSU_MAX_BASE_ADDR];                // REGIONCFG memory config 0-3 per base address
+    uint32_t mem_attr_mask;                                  // Memory configs with attributes set by the profile
+    uint32_t mem_attr[ETHOSU_MEM_ATTR_COUNT];                // MEM_ATTR, or AXI_LIMIT memtype on Ethos-U55/U65
+    uint32_t axi_limit_mask;                                 // AXI limit sets with limits set by the profile
+    struct ethosu_axi_limit axi_limit[ETHOSU_AXI_LIMIT_MAX]; // AXI limits per limit set
+};
+
+struct ethosu_network
+{
+    const void *custom_data_ptr;                       // Custom operator payload
+    int custom_data_size;                              // Size in bytes of custom operator payload
+    const uint8_t *cmd_stream;                         // Command stream found in payload
+    uint32_t cms_length;                               // Size in bytes of command stream
+    bool prepared;                                     // Set by ethosu_prepare()
+    bool has_optimizer_config;                         // Payload holds the optimizer config below
+    uint32_t optimizer_cfg;                            // NPU config the command stream was compiled for
+    uint32_t optimizer_id;                             // NPU architecture the command stream was compiled for
+    struct ethosu_region region[ETHOSU_MAX_BASE_ADDR]; // NPU access per base address
+    struct ethosu_footprint footprint;                 // Command stream footprint
+    uint32_t pmu_group;                                // Next PMU capture event group
+    int fast_memory_slot;                              // Assigned fast memory slot, or ETHOSU_FAST_MEMORY_SLOT_NONE
+    size_t fast_memory_size;                           // Size in bytes of fast memory used in the slot
+    void *fast_memory_backing;                         // Fast memory contents while not resident, NULL if not kept
+    size_t fast_memory_backing_size;                   // Size in bytes of the backing buffer
+    struct ethosu_driver *fast_memory_owner;           // Driver the contents are resident on, NULL if not resident
+    uint32_t fast_memory_place;                        // Base addresses placed in fast memory, 0 for the default
+    bool weight_staging;                               // Copy weights to the weight staging buffers on invoke
+    const struct ethosu_region_profile *profile;       // Memory configs of the jobs, NULL for the defaults
+    uint64_t cycles;                                   // Estimated NPU cycles per inference, 0 if unknown
+};
+
+struct ethosu_fast_memory_slot
+{
+    size_t offset;                   // Offset in bytes from the start of the fast memory
+    size_t size;                     // Size in bytes, the largest size of the networks assigned to the slot
+    struct ethosu_network *resident; // Network with a backing buffer resident in the slot, or NULL
+};
+
+struct ethosu_fast_memory_load
+{
+    uint64_t source;  // Address the data was copied from
+    uint64_t address; // Fast memory address the data was copied to
+    size_t size;      // Size in bytes, 0 if nothing is loaded
+};
+
+struct ethosu_fast_memory_region
+{
+    uint64_t address;                                          // Start address
+    size_t size;                                               // Size in bytes, 0 if the region is not used
+    int region_cfg;                                            // REGIONCFG of placed base addresses, -1 for default
+    uint32_t latency;                                          // Relative access latency, lowest is filled first
+    const struct ethosu_network *loaded;                       // Network with read-only data loaded, or NULL
+    struct ethosu_fast_memory_load load[ETHOSU_MAX_BASE_ADDR]; // Read-only data loaded per base address
+};
+
+struct ethosu_weight_stage
+{
+    uint64_t source; // Address the weights were copied from
+    size_t size;     // Size in bytes of the copied weights, 0 if empty
+};
+
+struct ethosu_weight_stats
+{
+    uint32_t copies; // Invokes that copied the weights to a staging buffer
+    uint32_t hits;   // Invokes that found the weights already staged
+    uint32_t misses; // Invokes of staging networks that read the weights in place
+};
+
+struct ethosu_fast_memory_stats
+{
+    size_t size;       // Size in bytes of the fast memory
+    size_t used;       // Size in bytes of the fast memory used by the slots
+    size_t high_water; // Highest size used since the driver was initialized
+};
+
+struct ethosu_power_stats
+{
+    uint32_t power_ups;   // Power requests powering up the NPU
+    uint32_t fast_path;   // Power ups where the NPU was still powered and the soft reset was skipped
+    uint32_t warm_starts; // Power ups where the NPU was found in a clean state and the soft reset was skipped
+    uint32_t power_downs; // Clock and power gating re-enabled
 };
 
 struct ethosu_driver
 {
     struct ethosu_device dev;
     struct ethosu_driver *next;
-    struct ethosu_job job;
+    struct ethosu_job job[ETHOSU_JOB_QUEUE_SIZE]; // Ring of queued jobs
+    volatile uint32_t job_head;                   // Index of oldest job, advanced on completion
+    volatile uint32_t job_tail;                   // Index of next free slot, advanced on submit
     void *semaphore;
+    void *drain_semaphore;  // Given by ethosu_complete_jobs() while draining
+    void *job_mutex;        // Serializes submitting and starting jobs between threads
+    volatile bool draining; // ethosu_release_driver() waits for deferred jobs to be finished
+    uint32_t job_timeout;   // Microseconds a deferred job may run, 0 for no timeout
     uint64_t fast_memory;
     size_t fast_memory_size;
+    struct ethosu_fast_memory_slot fast_memory_slot[ETHOSU_FAST_MEMORY_SLOTS]; // Fast memory arena layout
+    size_t fast_memory_high_water;                                             // Highest fast memory size used
+    struct ethosu_network *fast_memory_resident;                               // Network using the whole fast memory
+    struct ethosu_fast_memory_region fast_region[ETHOSU_FAST_MEMORY_REGIONS];  // Region 0 is the fast memory
+    uint64_t weight_stage_base;                                                // Weight staging buffers, 0 if disabled
+    size_t weight_stage_size;                                                  // Size in bytes per staging buffer
+    int weight_stage_cfg;                                                      // REGIONCFG of staged weights
+    int weight_stage_last;                                                     // Most recently filled buffer
+    struct ethosu_weight_stage weight_stage[2];                                // Weights held per staging buffer
+    struct ethosu_weight_stats weight_stats;
+    uint32_t mem_attr[ETHOSU_MEM_ATTR_COUNT];                                  // Memory attributes without a profile
+    struct ethosu_axi_limit axi_limit[ETHOSU_AXI_LIMIT_MAX];                   // AXI limits without a profile
     uint32_t power_request_counter;
+    uint32_t power_idle_timeout; // Microseconds to keep the NPU powered after the last request
+    bool power_idle;             // NPU kept powered without any power request
+    bool reset_required;         // NPU state unknown, soft reset before the next power up
+    struct ethosu_power_stats power_stats;
+    struct ethosu_pmu_capture *pmu_capture;                        // Automatic PMU capture, NULL if disabled
+    volatile uint32_t pmu_cycle_overflow;                          // PMCCNTR overflows since the last reset
+    volatile uint32_t pmu_event_overflow[ETHOSU_PMU_MAX_COUNTERS]; // PMEVCNTR overflows since the last reset
+    struct ethosu_pmu_timeline *pmu_timeline;                      // PMU timeline, NULL if disabled
+    int log_severity;                                              // Runtime log severity, -1 for the global one
+    bool optimizer_verified;                                       // Optimizer config below matches the NPU
+    uint32_t optimizer_cfg;                                        // Last optimizer config verified
+    uint32_t optimizer_id;                                         // Last optimizer architecture verified
+#if ETHOSU_TRACE_ENABLE
+    struct ethosu_trace trace; // Latest trace records
+#endif
     bool reserved;
+    bool releasing; // ethosu_release_driver() is finishing the jobs of the reservation
+    bool scheduled;
+    uint32_t sched_claimed;        // Queue slots selected by ethosu_sched_invoke() for jobs not yet queued
+    volatile uint32_t sched_given; // Scheduler semaphore gives by the interrupt handler
 };
 
 struct ethosu_driver_version
@@ -198,9 +410,34 @@ int ethosu_semaphore_take(void *sem, uint64_t timeout);
  */
 int ethosu_semaphore_give(void *sem);
 
+/**
+ * Copy data to or from fast memory, for backing buffers, for base addresses
+ * placed in fast memory and for staged weights. Called when a job is submitted,
+ * started or finished up, and by ethosu_fast_memory_save(), and must not return
+ * before the copy is complete. The default implementation uses memcpy.
+ *
+ * Jobs that copy are never started from the interrupt handler, so the copy
+ * runs in thread context, or wherever ethosu_complete_jobs() is called for jobs
+ * invoked with a callback. It may block, for example waiting for a DMA.
+ *
+ * The driver cleans and invalidates the fast memory around the copy. An
+ * implementation using DMA is responsible for the cache maintenance of the
+ * memory outside the fast memory.
+ *
+ * @param drv       Pointer to driver handle
+ * @param dst       Destination address
+ * @param src       Source address
+ * @param size      Size in bytes
+ */
+void ethosu_fast_memory_copy(struct ethosu_driver *drv, void *dst, const void *src, size_t size);
+
 /**
  * Callback invoked just before the inference is started.
  *
+ * Called by the thread submitting the job, or for a queued job by the thread
+ * or deferred context finishing the previous job. When the driver is built with
+ * ETHOSU_IRQ_START_JOBS it may also be called from the interrupt handler.
+ *
  * @param drv       Pointer to driver handle
  * @param user_arg  User argument provided to ethosu_invoke_*()
  */
@@ -214,6 +451,68 @@ void ethosu_inference_begin(struct ethosu_driver *drv, void *user_arg);
  */
 void ethosu_inference_end(struct ethosu_driver *drv, void *user_arg);
 
+/**
+ * Request deferred completion of jobs invoked with
+ * ethosu_invoke_prepared_callback(). Called from the interrupt handler instead
+ * of giving the driver semaphore, from ethosu_wait() when a waited for job was
+ * blocking completed deferred jobs, from ethosu_job_timeout(), and from
+ * ethosu_release_driver() to fail the deferred jobs still queued.
+ *
+ * An override should schedule ethosu_complete_jobs() to run in a deferred
+ * context, for example a work queue. The default implementation calls
+ * ethosu_complete_jobs() directly, which then runs in interrupt context: the
+ * cache invalidation, ethosu_inference_end(), the soft reset after a failed job,
+ * the start of the next queued job and the completion callback are all called
+ * from the interrupt handler, and the driver job mutex is locked from it.
+ *
+ * @param drv       Pointer to driver handle
+ */
+void ethosu_defer_completion(struct ethosu_driver *drv);
+
+/**
+ * Start a one-shot timer that calls ethosu_job_timeout() after timeout_us
+ * microseconds. Called when a job with deferred completion is started on the
+ * NPU and a job timeout has been configured.
+ *
+ * The default implementation has no timer and returns -1, in which case the
+ * job has no timeout.
+ *
+ * @param drv           Pointer to driver handle
+ * @param timeout_us    Timeout in microseconds
+ * @return 0 if the timer was started, else negative error code
+ */
+int ethosu_job_timer_start(struct ethosu_driver *drv, uint32_t timeout_us);
+
+/**
+ * Stop the timer started by ethosu_job_timer_start(). Called when the job has
+ * completed or was aborted.
+ *
+ * @param drv       Pointer to driver handle
+ */
+void ethosu_job_timer_stop(struct ethosu_driver *drv);
+
+/**
+ * Start a one-shot timer that calls ethosu_power_idle_timeout() after
+ * timeout_us microseconds. Called when the last power request is released and
+ * an idle timeout has been configured.
+ *
+ * The default implementation has no timer and returns -1, in which case the
+ * NPU is power gated right away.
+ *
+ * @param drv           Pointer to driver handle
+ * @param timeout_us    Timeout in microseconds
+ * @return 0 if the timer was started, else negative error code
+ */
+int ethosu_power_timer_start(struct ethosu_driver *drv, uint32_t timeout_us);
+
+/**
+ * Stop the timer started by ethosu_power_timer_start(). Called when the NPU is
+ * powered up again before the timer has expired.
+ *
+ * @param drv       Pointer to driver handle
+ */
+void ethosu_power_timer_stop(struct ethosu_driver *drv);
+
 /**
  * Remapping command stream and base pointer addresses.
  *
@@ -291,6 +590,244 @@ int ethosu_request_power(struct ethosu_driver *drv);
  */
 void ethosu_release_power(struct ethosu_driver *drv);
 
+/**
+ * Set the time the NPU is kept powered after the last power request has been
+ * released. A request within this time skips the soft reset, if the NPU was
+ * left in a clean state. 0 power gates the NPU right away.
+ *
+ * Requires ethosu_power_timer_start() and ethosu_power_timer_stop() to be
+ * implemented.
+ *
+ * @param drv           Pointer to driver handle
+ * @param timeout_us    Idle timeout in microseconds
+ */
+void ethosu_set_power_idle_timeout(struct ethosu_driver *drv, uint32_t timeout_us);
+
+/**
+ * Power gate the NPU if it is still idle. To be called by the timer started
+ * with ethosu_power_timer_start(), from a context that does not preempt other
+ * driver calls for the same NPU.
+ *
+ * @param drv       Pointer to driver handle
+ */
+void ethosu_power_idle_timeout(struct ethosu_driver *drv);
+
+/**
+ * Get power management statistics.
+ *
+ * @param drv       Pointer to driver handle
+ * @param stats     Statistics to be filled in
+ */
+void ethosu_get_power_stats(struct ethosu_driver *drv, struct ethosu_power_stats *stats);
+
+/**
+ * Assign a part of the fast memory to a prepared network. Networks assigned to
+ * different slots get fast memory areas that do not overlap, while networks
+ * that never run at the same time can share a slot. The slots are laid out one
+ * after another, each as large as the largest network assigned to it.
+ *
+ * A network without a slot uses the whole fast memory. The layout can only be
+ * changed while no jobs are queued on the NPU.
+ *
+ * @param drv       Pointer to driver handle
+ * @param net       Prepared network
+ * @param slot      Slot index, less than ETHOSU_FAST_MEMORY_SLOTS
+ * @param size      Size in bytes of the fast memory used by the network
+ * @return 0 on success, else -1 if the slots do not fit in the fast memory
+ */
+int ethosu_fast_memory_assign(struct ethosu_driver *drv, struct ethosu_network *net, int slot, size_t size);
+
+/**
+ * Remove all fast memory slots. Networks assigned to a slot fail to invoke
+ * until they have been assigned again. Only allowed while no jobs are queued.
+ *
+ * @param drv       Pointer to driver handle
+ * @return 0 on success, else -1
+ */
+int ethosu_fast_memory_reset(struct ethosu_driver *drv);
+
+/**
+ * Get fast memory usage, including the high-water mark of the slots.
+ *
+ * @param drv       Pointer to driver handle
+ * @param stats     Statistics to be filled in
+ */
+void ethosu_get_fast_memory_stats(struct ethosu_driver *drv, struct ethosu_fast_memory_stats *stats);
+
+/**
+ * Keep the fast memory contents of a prepared network in a backing buffer
+ * while other networks use its fast memory area. The contents are saved when
+ * another network is started in the area, and restored before the network is
+ * started again. Repeated invocations of the resident network copy nothing.
+ *
+ * The first size bytes of the area are kept, and are restored from the backing
+ * buffer the first time the network runs. A resident network is only invoked
+ * on the NPU it is resident on. Pass NULL to stop keeping the contents.
+ *
+ * @param net       Prepared network, not resident on any NPU
+ * @param backing   Backing buffer, or NULL
+ * @param size      Size in bytes of the backing buffer
+ * @return 0 on success, else -1
+ */
+int ethosu_fast_memory_set_backing(struct ethosu_network *net, void *backing, size_t size);
+
+/**
+ * Save the fast memory contents of all networks resident on the NPU to their
+ * backing buffers, for example before the fast memory is powered off or used
+ * for something else. Only allowed while no jobs are queued.
+ *
+ * @param drv       Pointer to driver handle
+ * @return 0 on success, else -1
+ */
+int ethosu_fast_memory_save(struct ethosu_driver *drv);
+
+/**
+ * Add a fast memory region, for example a second SRAM bank. Region 0 is the
+ * fast memory passed to ethosu_init(), with latency 0 and the REGIONCFG
+ * selected by ethosu_config_select(). Only allowed while no jobs are queued.
+ *
+ * @param drv           Pointer to driver handle
+ * @param address       Start address, aligned to the cache line size
+ * @param size          Size in bytes
+ * @param region_cfg    REGIONCFG memory config, selecting the AXI port, of base
+ *                      addresses placed in the region, or -1 for the one
+ *                      selected by ethosu_config_select()
+ * @param latency       Relative access latency, regions with a lower latency
+ *                      are filled first
+ * @return Region index on success, else -1
+ */
+int ethosu_fast_memory_add_region(
+    struct ethosu_driver *drv, const void *address, size_t size, int region_cfg, uint32_t latency);
+
+/**
+ * Select the base addresses of a prepared network that are placed in fast
+ * memory. Each base address is placed, in index order, in the region with the
+ * lowest latency that still has room for it, preferring the fullest region on
+ * a tie. The data read by the NPU is copied in before the job is started, and
+ * the data written by the NPU is copied back once the job is done. Read-only
+ * data, such as weights, is only copied again if another network has used the
+ * region in between. Base address 2 is scratch data and is never copied.
+ *
+ * By default only base address 2 is placed, in region 0, and the address is
+ * written back to the base address array passed to the invoke.
+ *
+ * @param net               Prepared network
+ * @param base_addr_mask    Bit mask of base address indices, 0 for the default
+ * @return 0 on success, else -1
+ */
+int ethosu_fast_memory_place(struct ethosu_network *net, uint32_t base_addr_mask);
+
+/**
+ * Set up double buffered weight staging, a copy of the weights into fast
+ * memory. The buffer, typically SRAM, is split in two. When a network with
+ * weight staging enabled is invoked, its weights are copied with
+ * ethosu_fast_memory_copy() to a buffer that is not used by any queued job, and
+ * base address 0 is moved there. The copy is a synchronous part of the invoke,
+ * not a prefetch, so it only overlaps NPU work when the job is queued behind
+ * another one. Weight staging therefore requires ETHOSU_JOB_QUEUE_SIZE of at
+ * least 2. Weights that are still staged are not copied again. Only allowed
+ * while no jobs are queued.
+ *
+ * @param drv           Pointer to driver handle
+ * @param buffer        Staging buffer aligned to the cache line size, or NULL to disable
+ * @param size          Size in bytes of the staging buffer, both halves together
+ * @param region_cfg    REGIONCFG of staged weights, or -1 for the one selected
+ *                      by ethosu_config_select()
+ * @return 0 on success, else -1, also if ETHOSU_JOB_QUEUE_SIZE is less than 2
+ */
+int ethosu_weight_staging_init(struct ethosu_driver *drv, void *buffer, size_t size, int region_cfg);
+
+/**
+ * Enable weight staging for a prepared network. The size of the weights is
+ * taken from the region access of base address 0. Weights that do not fit in
+ * half the staging buffer, or that are placed in fast memory, are read in
+ * place.
+ *
+ * @param net       Prepared network
+ * @param enable    True to stage the weights on invoke
+ * @return 0 on success, else -1
+ */
+int ethosu_set_weight_staging(struct ethosu_network *net, bool enable);
+
+/**
+ * Get weight staging statistics.
+ *
+ * @param drv       Pointer to driver handle
+ * @param stats     Statistics to be filled in
+ */
+void ethosu_get_weight_stats(struct ethosu_driver *drv, struct ethosu_weight_stats *stats);
+
+/**
+ * Attach a region profile to a prepared network, overriding the compile time
+ * REGIONCFG, memory attributes and AXI limits while its jobs run. Base
+ * addresses without a REGIONCFG in the profile use ethosu_config_select(), and
+ * memory configs and AXI limit sets not in the profile use the defaults of the
+ * driver. Base addresses placed in
+ * fast memory or staged use the REGIONCFG of the fast memory region or the
+ * staging buffer. The profile is read when a job starts. It is not copied, and
+ * must stay valid while the network is invoked.
+ *
+ * @param net       Prepared network
+ * @param profile   Region profile, or NULL for the defaults
+ * @return 0 on success, else -1
+ */
+int ethosu_set_region_profile(struct ethosu_network *net, const struct ethosu_region_profile *profile);
+
+/**
+ * Set the estimated number of NPU cycles per inference of a prepared network,
+ * used by the scheduler to select the NPU with the least work left. The
+ * estimate is also updated from the cycle counter when the PMU capture is
+ * enabled.
+ *
+ * @param net       Prepared network
+ * @param cycles    Estimated NPU cycles per inference, 0 if unknown
+ * @return 0 on success, else -1
+ */
+int ethosu_set_network_cycles(struct ethosu_network *net, uint64_t cycles);
+
+/**
+ * Set the AXI limits of the driver, used by jobs of networks without AXI limits
+ * in their region profile. There are four limit sets on Ethos-U55/U65, AXI_LIMIT0
+ * to AXI_LIMIT3 selected by the memory config, and two on Ethos-U85, AXI_SRAM
+ * and AXI_EXT. The limits are programmed when the next job starts.
+ *
+ * @param drv       Pointer to driver handle
+ * @param index     AXI limit set
+ * @param limit     AXI limits
+ * @return 0 on success, else -1
+ */
+int ethosu_set_axi_limit(struct ethosu_driver *drv, int index, const struct ethosu_axi_limit *limit);
+
+/**
+ * Get the AXI limits of the driver, initially the compile time defaults.
+ *
+ * @param drv       Pointer to driver handle
+ * @param index     AXI limit set
+ * @param limit     AXI limits to be filled in
+ * @return 0 on success, -1 if there is no such limit set
+ */
+int ethosu_get_axi_limit(struct ethosu_driver *drv, int index, struct ethosu_axi_limit *limit);
+
+/**
+ * Set the runtime log severity of the driver. Messages above the compile time
+ * ETHOSU_LOG_SEVERITY are not compiled in, and are not enabled by this call.
+ * Drivers without a severity of their own follow this severity.
+ *
+ * @param severity  ETHOSU_LOG_ERR, ETHOSU_LOG_WARN, ETHOSU_LOG_INFO or ETHOSU_LOG_DEBUG
+ * @return 0 on success, else -1
+ */
+int ethosu_set_log_severity(int severity);
+
+/**
+ * Set the runtime log severity of one NPU driver, for example to debug one NPU
+ * while the others keep their severity.
+ *
+ * @param drv       Pointer to driver handle
+ * @param severity  ETHOSU_LOG_ERR to ETHOSU_LOG_DEBUG, or -1 to follow the global severity
+ * @return 0 on success, else -1
+ */
+int ethosu_set_driver_log_severity(struct ethosu_driver *drv, int severity);
+
 /**
  * Get Ethos-U driver version.
  *
@@ -334,6 +871,12 @@ int ethosu_invoke_v3(struct ethosu_driver *drv,
  * Invoke command stream using async interface.
  * Must be followed by call(s) to ethosu_wait() upon successful return.
  *
+ * If the NPU is busy the job is queued, and started when the previous job is
+ * finished by ethosu_wait() or ethosu_complete_jobs(). With
+ * ETHOSU_IRQ_START_JOBS it is instead started from the interrupt handler as
+ * soon as the previous job has completed. Up to ETHOSU_JOB_QUEUE_SIZE jobs can
+ * be outstanding per driver.
+ *
  * @see ethosu_invoke_v3 for documentation.
  */
 int ethosu_invoke_async(struct ethosu_driver *drv,
@@ -349,27 +892,228 @@ int ethosu_invoke_async(struct ethosu_driver *drv,
  * Poll status or finish up if inference is complete (block=false)
  * (This function is only intended to be used in conjuction with ethosu_invoke_async)
  *
+ * Jobs are completed in the order they were submitted, each call finishing up
+ * the oldest job in the queue.
+ *
  * @param drv       Pointer to driver handle
  * @param block     If call should block if inference is running
  * @return -2 on inference not invoked, -1 on inference error, 0 on success, 1 on inference running
  */
 int ethosu_wait(struct ethosu_driver *drv, bool block);
 
+/**
+ * Prepare a network for repeated invocation.
+ *
+ * The custom operator payload is parsed and the optimizer configuration is
+ * verified against the hardware once, so that subsequent invocations of the
+ * network can skip this work. The optimizer configuration is recorded, and
+ * verified again when the network is invoked on another NPU. The payload must
+ * remain valid for as long as the network is used.
+ *
+ * @param drv               Pointer to driver handle
+ * @param net               Network handle to be filled in
+ * @param custom_data_ptr   Custom data payload
+ * @param custom_data_size  Size in bytes of custom data
+ * @return 0 on success, else negative error code
+ */
+int ethosu_prepare(struct ethosu_driver *drv,
+                   struct ethosu_network *net,
+                   const void *custom_data_ptr,
+                   const int custom_data_size);
+
+/**
+ * Describe how the NPU accesses a region of a prepared network, limiting the
+ * cache maintenance done for each inference. Regions only read by the NPU are
+ * cleaned before the inference, regions written by the NPU are invalidated
+ * after the inference, and regions only written are also invalidated before
+ * the inference. The accessed range must be aligned to the cache line size.
+ *
+ * @param net               Network handle, prepared with ethosu_prepare(), else the call fails
+ * @param index             Base address index
+ * @param access            Access flags, see enum ethosu_region_access
+ * @param offset            Offset from base address of accessed range
+ * @param size              Size in bytes of accessed range, 0 for the whole region
+ * @return 0 on success, else negative error code
+ */
+int ethosu_set_region_access(
+    struct ethosu_network *net, const int index, const uint32_t access, const size_t offset, const size_t size);
+
+/**
+ * Invoke prepared network.
+ *
+ * @param drv               Pointer to driver handle
+ * @param net               Network handle, prepared with ethosu_prepare()
+ * @param base_addr         Array of base address pointers
+ * @param base_addr_size    Size in bytes of each address in base_addr
+ * @param num_base_addr     Number of elements in base_addr array
+ * @param user_arg          User argument, will be passed to
+ *                          ethosu_inference_begin() and ethosu_inference_end()
+ * @return 0 on success, else negative error code
+ */
+int ethosu_invoke_prepared(struct ethosu_driver *drv,
+                           struct ethosu_network *net,
+                           uint64_t *const base_addr,
+                           const size_t *base_addr_size,
+                           const int num_base_addr,
+                           void *user_arg);
+
+/**
+ * Invoke prepared network using async interface.
+ * Must be followed by call(s) to ethosu_wait() upon successful return.
+ *
+ * @see ethosu_invoke_prepared for documentation.
+ */
+int ethosu_invoke_prepared_async(struct ethosu_driver *drv,
+                                 struct ethosu_network *net,
+                                 uint64_t *const base_addr,
+                                 const size_t *base_addr_size,
+                                 const int num_base_addr,
+                                 void *user_arg);
+
+/**
+ * Invoke prepared network with a completion callback.
+ *
+ * The job completes without a waiting thread, and is only ever finished up by
+ * ethosu_complete_jobs(). ethosu_wait() returns 1 for such a job. When the NPU
+ * has finished, the interrupt handler calls ethosu_defer_completion(), and
+ * ethosu_complete_jobs() then finishes up the job and invokes the callback.
+ * The job times out as set by ethosu_set_job_timeout().
+ *
+ * @see ethosu_invoke_prepared for documentation.
+ * @param callback          Job completion callback
+ */
+int ethosu_invoke_prepared_callback(struct ethosu_driver *drv,
+                                    struct ethosu_network *net,
+                                    uint64_t *const base_addr,
+                                    const size_t *base_addr_size,
+                                    const int num_base_addr,
+                                    void *user_arg,
+                                    ethosu_job_callback callback);
+
+/**
+ * Finish up completed jobs invoked with ethosu_invoke_prepared_callback(),
+ * invoking their completion callbacks in submission order.
+ *
+ * @param drv       Pointer to driver handle
+ * @return Number of completed jobs
+ */
+int ethosu_complete_jobs(struct ethosu_driver *drv);
+
+/**
+ * Set the time a job with deferred completion may run on the NPU before it
+ * times out, in microseconds. 0 disables the timeout.
+ *
+ * Requires ethosu_job_timer_start() and ethosu_job_timer_stop() to be
+ * implemented.
+ *
+ * @param drv           Pointer to driver handle
+ * @param timeout_us    Job timeout in microseconds
+ */
+void ethosu_set_job_timeout(struct ethosu_driver *drv, uint32_t timeout_us);
+
+/**
+ * Time out the running job with deferred completion. The NPU is stopped, and
+ * the job is finished up by ethosu_complete_jobs() with -1, which resets the
+ * NPU. To be called by the
+ * timer started with ethosu_job_timer_start(), from a context that does not
+ * preempt other driver calls and is not preempted by ethosu_irq_handler() for
+ * the same NPU.
+ *
+ * @param drv       Pointer to driver handle
+ */
+void ethosu_job_timeout(struct ethosu_driver *drv);
+
 /**
  * Reserves a driver to execute inference with. Call will block until a driver
- * is available.
+ * is available. Same as ethosu_reserve_driver_priority() with priority 0.
  *
  * @return Pointer to driver handle.
  */
 struct ethosu_driver *ethosu_reserve_driver(void);
 
+/**
+ * Reserves a driver to execute inference with. Call will block until a driver
+ * is available. Released drivers are handed over to the waiting thread with
+ * the highest priority, and in order of arrival between threads with the same
+ * priority. A waiting thread blocks on a semaphore reused from earlier
+ * waiters, or created if none is left.
+ *
+ * @param priority  Priority of the caller, higher is served first
+ * @return Pointer to driver handle, NULL if the semaphore to wait on could not
+ *         be created
+ */
+struct ethosu_driver *ethosu_reserve_driver_priority(int priority);
+
 /**
  * Release driver that was previously reserved with @see ethosu_reserve_driver.
+ * Completed jobs are finished up. Jobs still queued are aborted, and finished
+ * up like failed jobs, releasing their power requests and invoking their
+ * callbacks with -1. ethosu_inference_end() is only called for aborted jobs
+ * that had been started. Jobs with deferred completion are failed through
+ * ethosu_defer_completion(), and the call blocks until ethosu_complete_jobs()
+ * has finished them, so it must not be called from that context.
+ *
+ * The jobs are finished without holding the driver mutex, so the callbacks and
+ * ethosu_inference_end() may reserve, invoke and release drivers. Releasing
+ * the same driver from a callback while it is being released has no effect.
  *
  * @param drv       Pointer to driver handle
  */
 void ethosu_release_driver(struct ethosu_driver *drv);
 
+/**
+ * Hand over drivers to the scheduler. The drivers are reserved, and the call
+ * will block until the requested number of drivers is available. Fails if
+ * fewer drivers than requested have been registered.
+ *
+ * @param num_drivers       Number of drivers for the scheduler to use
+ * @return 0 on success, else negative error code
+ */
+int ethosu_sched_init(int num_drivers);
+
+/**
+ * Complete all scheduled jobs and release the drivers used by the scheduler.
+ */
+void ethosu_sched_deinit(void);
+
+/**
+ * Invoke prepared network on the least loaded NPU handed over to the
+ * scheduler. NPUs with the least estimated NPU cycles left are selected first,
+ * when the cycle estimates of the queued jobs on all NPUs able to run the job
+ * are known, @see ethosu_set_network_cycles. Otherwise, and on a tie, NPUs
+ * with the shortest job queue are selected first, preferring an NPU that is
+ * already powered.
+ *
+ * The callback is invoked when the job has completed, from the context
+ * calling ethosu_sched_poll().
+ *
+ * @param net               Network handle, prepared with ethosu_prepare()
+ * @param base_addr         Array of base address pointers
+ * @param base_addr_size    Size in bytes of each address in base_addr
+ * @param num_base_addr     Number of elements in base_addr array
+ * @param user_arg          User argument, will be passed to
+ *                          ethosu_inference_begin(), ethosu_inference_end()
+ *                          and the callback
+ * @param callback          Job completion callback
+ * @return 0 on success, else negative error code
+ */
+int ethosu_sched_invoke(struct ethosu_network *net,
+                        uint64_t *const base_addr,
+                        const size_t *base_addr_size,
+                        const int num_base_addr,
+                        void *user_arg,
+                        ethosu_job_callback callback);
+
+/**
+ * Finish up completed scheduled jobs, invoking their completion callbacks.
+ * Must only be called from one thread at a time.
+ *
+ * @param block     If call should block until all scheduled jobs have completed,
+ *                  finishing up each job as soon as its NPU has completed it
+ * @return Number of completed jobs
+ */
+int ethosu_sched_poll(bool block);
+
 /**
  * Static inline for backwards-compatibility.
  *
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ETHOSU_LOG_BUFFER_H
+#define ETHOSU_LOG_BUFFER_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+// Logs are formatted synchronously by default
+#ifndef ETHOSU_LOG_DEFERRED
+#define ETHOSU_LOG_DEFERRED 0
+#endif
+
+// Number of log records buffered before the oldest are overwritten
+#ifndef ETHOSU_LOG_BUFFER_SIZE
+#define ETHOSU_LOG_BUFFER_SIZE 32
+#endif
+
+// Maximum number of arguments stored per log message
+#define ETHOSU_LOG_MAX_ARGS 8
+
+// Log record flags
+#define ETHOSU_LOG_FLAG_NUM_ARGS_MASK 0xff
+#define ETHOSU_LOG_FLAG_STDERR (1 << 8)   // Message is written to stderr
+#define ETHOSU_LOG_FLAG_TRUNCATED (1 << 9) // Message had more than ETHOSU_LOG_MAX_ARGS arguments
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+/**
+ * Log record, holding the address of the format string and the arguments. The
+ * layout is the same for 32 and 64 bit CPUs, so that a memory dump of the
+ * records can be decoded on the host together with the application image.
+ */
+struct ethosu_log_record
+{
+    volatile uint32_t sequence;        // Record number plus one, 0 while the record is written
+    uint32_t flags;                    // Number of arguments and ETHOSU_LOG_FLAG_*
+    uint64_t format;                   // Address of the format string
+    uint64_t arg[ETHOSU_LOG_MAX_ARGS]; // Arguments, signed integers sign extended and doubles as bits
+};
+
+/******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+
+#if ETHOSU_LOG_DEFERRED
+
+/**
+ * Format the log records written since the last call, oldest first, to stdout
+ * or stderr. This is meant to be called from a low priority thread, and must
+ * not be called from more than one thread at a time.
+ *
+ * @return Number of log messages written
+ */
+uint32_t ethosu_log_flush(void);
+
+/**
+ * Copy the latest log records, oldest first, for example to be decoded on the
+ * host by tools/ethosu_log_decode.py. Records being written are skipped. The
+ * records are left in the buffer.
+ *
+ * @param records       Records to be filled in
+ * @param max_records   Size of the records array
+ * @return Number of records copied
+ */
+uint32_t ethosu_log_read(struct ethosu_log_record *records, uint32_t max_records);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ETHOSU_LOG_BUFFER_H
@@ -0,0 +1,134 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ETHOSU_SIM_H
+#define ETHOSU_SIM_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+enum ethosu_sim_fault
+{
+    ETHOSU_SIM_FAULT_NONE = 0,  ///< Command streams complete normally
+    ETHOSU_SIM_FAULT_HANG,      ///< Command streams never complete, until the NPU is reset
+    ETHOSU_SIM_FAULT_BUS_ERROR  ///< Command streams complete with a bus error
+};
+
+struct ethosu_sim_config
+{
+    uint32_t latency_us;    ///< Time from command stream start to completion interrupt
+    uint32_t cycles_per_us; ///< NPU clock frequency in MHz, advances the PMU counters
+    uint32_t config;        ///< CONFIG register, 0 for a default matching the build configuration
+    uint32_t id;            ///< ID register, 0 for a default matching the build configuration
+    bool secure;            ///< Security level reported after reset
+    bool privileged;        ///< Privilege level reported after reset
+};
+
+struct ethosu_sim_stats
+{
+    uint32_t started;        ///< Command streams started
+    uint32_t completed;      ///< Completion interrupts raised
+    uint32_t resets;         ///< Soft resets
+    uint32_t stopped;        ///< Running command streams stopped by a stop request
+    uint32_t irq_handled;    ///< Completion interrupts handled by ethosu_irq_handler()
+    uint32_t pmu_irqs;       ///< PMU overflow interrupts raised while a command stream was running
+    uint64_t irq_handler_ns; ///< Time spent in the last ethosu_irq_handler() call
+};
+
+struct ethosu_sim;
+
+/******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+
+/**
+ * Create a simulated NPU register map. The register map is only modeled as
+ * far as the driver uses it, command streams are not executed.
+ *
+ * @param config            Simulator configuration
+ * @return Pointer to simulator handle, NULL on failure
+ */
+struct ethosu_sim *ethosu_sim_create(const struct ethosu_sim_config *config);
+
+/**
+ * Stop the simulator thread and free the simulator.
+ *
+ * @param sim               Pointer to simulator handle
+ */
+void ethosu_sim_destroy(struct ethosu_sim *sim);
+
+/**
+ * Base address of the simulated register map, to be passed to ethosu_init().
+ *
+ * @param sim               Pointer to simulator handle
+ * @return Register map base address
+ */
+void *ethosu_sim_base_address(struct ethosu_sim *sim);
+
+/**
+ * Start the simulator thread, which raises the interrupt by calling
+ * ethosu_irq_handler() for the driver. Call after ethosu_init().
+ *
+ * @param sim               Pointer to simulator handle
+ * @param drv               Pointer to driver handle
+ * @return 0 on success, else negative error code
+ */
+int ethosu_sim_start(struct ethosu_sim *sim, struct ethosu_driver *drv);
+
+/**
+ * Set the latency of command streams started after this call.
+ *
+ * @param sim               Pointer to simulator handle
+ * @param latency_us        Time from command stream start to completion interrupt
+ */
+void ethosu_sim_set_latency(struct ethosu_sim *sim, uint32_t latency_us);
+
+/**
+ * Inject a fault into command streams completing after this call.
+ *
+ * @param sim               Pointer to simulator handle
+ * @param fault             Fault to inject
+ */
+void ethosu_sim_set_fault(struct ethosu_sim *sim, enum ethosu_sim_fault fault);
+
+/**
+ * Get simulator statistics.
+ *
+ * @param sim               Pointer to simulator handle
+ * @param stats             Statistics to be filled in
+ */
+void ethosu_sim_get_stats(struct ethosu_sim *sim, struct ethosu_sim_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ETHOSU_SIM_H
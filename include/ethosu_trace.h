@@ -0,0 +1,129 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ETHOSU_TRACE_H
+#define ETHOSU_TRACE_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+// Tracing is compiled out by default
+#ifndef ETHOSU_TRACE_ENABLE
+#define ETHOSU_TRACE_ENABLE 0
+#endif
+
+// Number of trace records buffered per driver
+#ifndef ETHOSU_TRACE_SIZE
+#define ETHOSU_TRACE_SIZE 64
+#endif
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+struct ethosu_driver;
+
+/**
+ * Trace events. The values are stored in the trace records and decoded by
+ * tools/ethosu_trace_decode.py, and must not be changed.
+ */
+enum ethosu_trace_event
+{
+    ETHOSU_TRACE_INVOKE              = 1,  // Job queued. arg0=custom data, arg1=number of base addresses
+    ETHOSU_TRACE_COP_PARSE_BEGIN     = 2,  // arg0=custom data, arg1=custom data size
+    ETHOSU_TRACE_COP_PARSE_END       = 3,  // arg0=result, arg1=command stream length
+    ETHOSU_TRACE_POWER_REQUEST       = 4,  // arg0=power requests before, arg1=NPU kept powered while idle
+    ETHOSU_TRACE_POWER_RELEASE       = 5,  // arg0=power requests before
+    ETHOSU_TRACE_PROGRAM_BEGIN       = 6,  // NPU registers programmed. arg0=command stream, arg1=length
+    ETHOSU_TRACE_PROGRAM_END         = 7,  // arg0=number of base addresses
+    ETHOSU_TRACE_IRQ_BEGIN           = 8,  // No arguments
+    ETHOSU_TRACE_IRQ_END             = 9,  // arg0=job result, -1 if no job completed
+    ETHOSU_TRACE_WAIT_BEGIN          = 10, // arg0=job state, arg1=blocking
+    ETHOSU_TRACE_WAIT_WAKEUP         = 11, // arg0=return value
+    ETHOSU_TRACE_RELEASE             = 12, // Driver released. arg0=jobs left in the queue
+    ETHOSU_TRACE_FAST_MEMORY_SAVE    = 13, // Fast memory saved to backing buffer. arg0=custom data, arg1=size
+    ETHOSU_TRACE_FAST_MEMORY_RESTORE = 14, // Fast memory restored from backing buffer. arg0=custom data, arg1=size
+    ETHOSU_TRACE_RESERVE             = 15, // Driver reserved. arg0=priority, arg1=1 if released by another thread
+};
+
+/**
+ * Trace record. The layout is the same for 32 and 64 bit CPUs, so that a
+ * memory dump of the records can be decoded on the host.
+ */
+struct ethosu_trace_record
+{
+    volatile uint32_t sequence; // Record number plus one, 0 while the record is written
+    uint32_t event;             // enum ethosu_trace_event
+    uint64_t timestamp;         // From ethosu_trace_timestamp()
+    uint64_t drv;               // Address of the driver
+    uint64_t arg[2];            // Event arguments
+};
+
+/**
+ * Ring of the latest trace records of a driver. Records are reserved with an
+ * atomic increment, so that the interrupt handler can trace while a thread is
+ * writing a record. The oldest records are overwritten.
+ */
+struct ethosu_trace
+{
+    volatile uint32_t head; // Number of records reserved
+    struct ethosu_trace_record record[ETHOSU_TRACE_SIZE];
+};
+
+/******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+
+#if ETHOSU_TRACE_ENABLE
+
+/**
+ * Timestamp of the trace records, for example a cycle counter. The default
+ * implementation returns 0.
+ *
+ * @return Timestamp, in a unit of the platform's choosing
+ */
+uint64_t ethosu_trace_timestamp(void);
+
+/**
+ * Copy the trace records of a driver, oldest first. Records being written
+ * are skipped. The records are left in the ring.
+ *
+ * @param drv           Pointer to driver handle
+ * @param records       Records to be filled in
+ * @param max_records   Size of the records array
+ * @return Number of records copied
+ */
+uint32_t ethosu_trace_read(struct ethosu_driver *drv, struct ethosu_trace_record *records, uint32_t max_records);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ETHOSU_TRACE_H
@@ -24,6 +24,25 @@
 
 #include <stdint.h>
 
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+// Maximum number of AXI configuration registers cached per device
+#define ETHOSU_AXI_CFG_MAX 8
+
+// Number of memory configs selectable by REGIONCFG
+#define ETHOSU_MEM_ATTR_COUNT 4
+
+// Maximum number of AXI limit sets, AXI_LIMIT0-3 or AXI_SRAM and AXI_EXT
+#define ETHOSU_AXI_LIMIT_MAX 4
+
+// Log severity levels
+#define ETHOSU_LOG_ERR 0
+#define ETHOSU_LOG_WARN 1
+#define ETHOSU_LOG_INFO 2
+#define ETHOSU_LOG_DEBUG 3
+
 /******************************************************************************
  * Types
  ******************************************************************************/
@@ -35,6 +54,15 @@ struct ethosu_device
     volatile struct NPU_REG *reg; // Register map
     uint32_t secure;
     uint32_t privileged;
+    uint32_t axi_cfg[ETHOSU_AXI_CFG_MAX]; // AXI and memory attribute register values, written after reset
+    int log_severity;                     // Runtime log severity, ETHOSU_LOG_ERR to ETHOSU_LOG_DEBUG
+};
+
+struct ethosu_axi_limit
+{
+    uint8_t max_outstanding_read;  ///< Maximum number of outstanding AXI read transactions
+    uint8_t max_outstanding_write; ///< Maximum number of outstanding AXI write transactions
+    uint8_t max_beats;             ///< Burst split alignment, 0=64B, 1=128B, 2=256B
 };
 
 enum ethosu_error_codes
@@ -71,7 +99,7 @@ struct ethosu_id
 
 struct ethosu_config
 {
-    uint32_t macs_per_cc;        ///< MACs per clock cycle
+    uint32_t macs_per_cc;        ///< Log2 of MACs per clock cycle
     uint32_t cmd_stream_version; ///< NPU command stream version
     uint32_t custom_dma;         ///< Custom DMA enabled
 };
@@ -21,8 +21,10 @@
 /*****************************************************************************
  * Includes
  *****************************************************************************/
+#include <stdbool.h>
 #include <stdint.h>
 
+#include "ethosu_cmd_analyzer.h"
 #include "ethosu_driver.h"
 
 #ifdef __cplusplus
@@ -51,6 +53,33 @@ extern "C" {
 
 #define ETHOSU_PMU_CCNT_Msk (1UL << 31)
 
+// Number of samples buffered per driver by the automatic PMU capture
+#ifndef ETHOSU_PMU_CAPTURE_SIZE
+#define ETHOSU_PMU_CAPTURE_SIZE 16
+#endif
+
+// Maximum number of events multiplexed by the automatic PMU capture
+#ifndef ETHOSU_PMU_CAPTURE_MAX_EVENTS
+#define ETHOSU_PMU_CAPTURE_MAX_EVENTS (4 * ETHOSU_PMU_NCOUNTERS)
+#endif
+
+// Bytes per AXI data beat, used for the bandwidth metrics
+#ifndef ETHOSU_PMU_AXI_BEAT_BYTES
+#if defined(ETHOSU55)
+#define ETHOSU_PMU_AXI_BEAT_BYTES 8
+#else
+#define ETHOSU_PMU_AXI_BEAT_BYTES 16
+#endif
+#endif
+
+// Fixed point scale of the derived metrics, a ratio of 1.0 is ETHOSU_PMU_METRIC_SCALE
+#define ETHOSU_PMU_METRIC_SCALE 10000
+
+// Number of QREAD samples recorded per job by the PMU timeline
+#ifndef ETHOSU_PMU_TIMELINE_SIZE
+#define ETHOSU_PMU_TIMELINE_SIZE 256
+#endif
+
 /*****************************************************************************
  * Types
  *****************************************************************************/
@@ -321,6 +350,135 @@ enum ethosu_pmu_event_type
 #error No NPU target defined
 #endif
 
+/** \brief PMU counter values captured for one job
+ */
+struct ethosu_pmu_sample
+{
+    uint32_t sequence;                                      ///< Job number since the capture was enabled
+    int result;                                             ///< 0 if the job succeeded, else -1
+    const void *custom_data_ptr;                            ///< Custom operator payload of the job
+    void *user_arg;                                         ///< User argument of the job
+    uint64_t cycles;                                        ///< PMCCNTR at job completion
+    enum ethosu_pmu_event_type event[ETHOSU_PMU_NCOUNTERS]; ///< Event counted by each PMEVCNTR
+    uint64_t count[ETHOSU_PMU_NCOUNTERS];                   ///< PMEVCNTR at job completion
+};
+
+/** \brief Automatic PMU capture state, owned by the user
+ *
+ * The events are split in groups of ETHOSU_PMU_NCOUNTERS, and each job counts
+ * one group. The groups are rotated between the jobs of a prepared network,
+ * and between all other jobs.
+ *
+ * The samples are a ring written by the interrupt handler and read by a
+ * single reader. The indices run modulo twice the ring size to tell a full
+ * ring from an empty one.
+ */
+struct ethosu_pmu_capture
+{
+    enum ethosu_pmu_event_type event[ETHOSU_PMU_CAPTURE_MAX_EVENTS]; ///< Events to count, in groups
+    uint32_t num_groups;                                             ///< Number of event groups
+    uint32_t group;                                                  ///< Next group of jobs without a prepared network
+    uint32_t active;                                                 ///< Index of the first event of the running job
+    uint32_t sequence;                                               ///< Number of the next job
+    volatile uint32_t dropped;                                       ///< Samples dropped because the ring was full
+    volatile uint32_t head;                                          ///< Index of next sample to write
+    volatile uint32_t tail;                                          ///< Index of oldest sample
+    struct ethosu_pmu_sample sample[ETHOSU_PMU_CAPTURE_SIZE];
+};
+
+/** \brief Event counts aggregated from multiplexed capture samples
+ *
+ * Each event is only counted by the jobs that ran its event group. The count
+ * per inference is estimated from the jobs that counted the event.
+ */
+struct ethosu_pmu_profile
+{
+    const void *custom_data_ptr;                                     ///< Network to aggregate, NULL for all
+    uint32_t inferences;                                             ///< Samples aggregated
+    uint64_t cycles;                                                 ///< Sum of the cycle counts
+    uint32_t num_events;                                             ///< Number of events seen
+    enum ethosu_pmu_event_type event[ETHOSU_PMU_CAPTURE_MAX_EVENTS]; ///< Events seen
+    uint64_t count[ETHOSU_PMU_CAPTURE_MAX_EVENTS];                   ///< Sum of the counts per event
+    uint32_t counted[ETHOSU_PMU_CAPTURE_MAX_EVENTS];                 ///< Samples counting each event
+};
+
+/** \brief Metrics derived from the PMU events, comparable between NPU variants
+ *
+ * All metrics are per cycle. The Ethos-U85 SRAM and EXT ports take the place
+ * of AXI0 and AXI1 of Ethos-U55 and Ethos-U65.
+ */
+enum ethosu_pmu_metric
+{
+    ETHOSU_PMU_METRIC_NPU_ACTIVE,        ///< NPU active cycles
+    ETHOSU_PMU_METRIC_MAC_UTILIZATION,   ///< MAC active cycles, upper bound of the fraction of peak MAC throughput
+    ETHOSU_PMU_METRIC_AXI0_READ,         ///< Bytes read on AXI0
+    ETHOSU_PMU_METRIC_AXI0_WRITE,        ///< Bytes written on AXI0
+    ETHOSU_PMU_METRIC_AXI1_READ,         ///< Bytes read on AXI1
+    ETHOSU_PMU_METRIC_AXI1_WRITE,        ///< Bytes written on AXI1
+    ETHOSU_PMU_METRIC_STALL_BLOCKDEP,    ///< Command stream stalled on block dependencies
+    ETHOSU_PMU_METRIC_STALL_MAC_WEIGHTS, ///< MAC stalled waiting for weights
+    ETHOSU_PMU_METRIC_STALL_MAC_ACC,     ///< MAC stalled waiting for the accumulators
+    ETHOSU_PMU_METRIC_STALL_MAC_IFM,     ///< MAC stalled waiting for input feature map data
+    ETHOSU_PMU_METRIC_STALL_AO_OFM,      ///< Output unit stalled waiting for the output buffer
+    ETHOSU_PMU_METRIC_STALL_WD,          ///< Weight decoder stalled
+    ETHOSU_PMU_METRIC_COUNT
+};
+
+/** \brief Derived metrics per inference
+ */
+struct ethosu_pmu_metrics
+{
+    uint64_t cycles;                        ///< Cycles per inference
+    uint32_t valid;                         ///< Bit mask of the metrics that could be derived
+    uint32_t value[ETHOSU_PMU_METRIC_COUNT]; ///< Metrics scaled by ETHOSU_PMU_METRIC_SCALE
+};
+
+/** \brief AXI limits tried by ETHOSU_PMU_Tune_AXI_Limits(), and the result
+ */
+struct ethosu_pmu_axi_tune
+{
+    struct ethosu_axi_limit limit[ETHOSU_AXI_LIMIT_MAX]; ///< AXI limits per limit set, filled in by the user
+    int result;                                          ///< 0 if all inferences succeeded, else -1
+    uint64_t cycles;                                     ///< Mean cycles of the inferences
+    uint64_t read_stalled;                               ///< Mean read transaction requests stalled, all AXI ports
+    uint64_t write_stalled;                              ///< Mean write transaction requests stalled, all AXI ports
+};
+
+enum ethosu_pmu_timeline_state
+{
+    ETHOSU_PMU_TIMELINE_ARMED,     ///< Waiting for the job to record
+    ETHOSU_PMU_TIMELINE_RECORDING, ///< Job running, samples being added
+    ETHOSU_PMU_TIMELINE_DONE       ///< Job completed, samples can be read
+};
+
+/** \brief Command stream position and cycle count sampled during a job
+ */
+struct ethosu_pmu_timeline_sample
+{
+    uint32_t qread;  ///< QREAD, byte offset of the next command read by the NPU
+    uint64_t cycles; ///< PMCCNTR, reset when the job was started
+};
+
+/** \brief PMU timeline of one job, owned by the user
+ *
+ * The first sample is taken when the job is started and the last sample when
+ * it completes. The cycle counter is reset when the job is started. In between the platform timer adds samples with
+ * ETHOSU_PMU_Timeline_Sample(). The last slot is kept for the completion
+ * sample, further timer samples are dropped.
+ */
+struct ethosu_pmu_timeline
+{
+    const void *custom_data_ptr;                   ///< Network to record, NULL for any. Set to the recorded network.
+    uint32_t period_us;                            ///< Sampling period requested from the platform timer
+    volatile enum ethosu_pmu_timeline_state state; ///< Recording state
+    int result;                                    ///< 0 if the job succeeded, else -1
+    const uint8_t *cmd_stream;                     ///< Command stream of the recorded job
+    uint32_t cms_length;                           ///< Size in bytes of the command stream
+    uint32_t num_samples;                          ///< Samples recorded
+    uint32_t dropped;                              ///< Samples dropped because the timeline was full
+    struct ethosu_pmu_timeline_sample sample[ETHOSU_PMU_TIMELINE_SIZE];
+};
+
 /*****************************************************************************
  * Functions
  *****************************************************************************/
@@ -371,6 +529,8 @@ void ETHOSU_PMU_EVCNTR_ALL_Reset(struct ethosu_driver *drv);
  * \note   Enables one or more of the following:
  *         - event counters (bit 0-ETHOSU_PMU_NCOUNTERS)
  *         - cycle counter  (bit 31)
+ * \note   Also enables the overflow interrupt of the counters, which
+ *         ethosu_irq_handler() uses to extend the counters to 64 bits.
  */
 void ETHOSU_PMU_CNTR_Enable(struct ethosu_driver *drv, uint32_t mask);
 
@@ -430,11 +590,28 @@ uint32_t ETHOSU_PMU_Get_EVCNTR(struct ethosu_driver *drv, uint32_t num);
  */
 void ETHOSU_PMU_Set_EVCNTR(struct ethosu_driver *drv, uint32_t num, uint32_t val);
 
+/**
+ * \brief   Read cycle counter extended to 64 bits
+ * \return                Cycle count including the overflows since the counter was reset
+ * \note   The overflows are counted by ethosu_irq_handler().
+ */
+uint64_t ETHOSU_PMU_Get_CCNTR_Total(struct ethosu_driver *drv);
+
+/**
+ * \brief   Read event counter extended to 64 bits
+ * \param [in]    num     Event counter (0-ETHOSU_PMU_NCOUNTERS)
+ * \return                Event count including the overflows since the counter was reset
+ * \note   The overflows are counted by ethosu_irq_handler().
+ */
+uint64_t ETHOSU_PMU_Get_EVCNTR_Total(struct ethosu_driver *drv, uint32_t num);
+
 /**
  * \brief   Read counter overflow status
  * \return  Counter overflow status bits for the following:
  *          - event counters (bit 0-ETHOSU_PMU_NCOUNTERS))
  *          - cycle counter  (bit 31)
+ * \note   Overflows are cleared by ethosu_irq_handler() when the overflow
+ *         interrupt is enabled for the counter.
  */
 uint32_t ETHOSU_PMU_Get_CNTR_OVS(struct ethosu_driver *drv);
 
@@ -508,6 +685,177 @@ uint32_t ETHOSU_PMU_Get_QREAD(struct ethosu_driver *drv);
  */
 uint32_t ETHOSU_PMU_Get_STATUS(struct ethosu_driver *drv);
 
+/**
+ * \brief   Enable automatic PMU capture
+ * \param [in]   capture      Capture state, must stay valid until the capture is disabled and
+ *                            the queued jobs have completed
+ * \param [in]   events       Events to count
+ * \param [in]   num_events   Number of events, at most ETHOSU_PMU_CAPTURE_MAX_EVENTS
+ * \return  0 on success, -1 on failure
+ * \note   The driver programs the PMU when each job is started and stores the
+ *         cycle and event counters in the capture ring when the job completes.
+ *         More events than ETHOSU_PMU_NCOUNTERS are multiplexed, with each job
+ *         counting the next group of ETHOSU_PMU_NCOUNTERS events.
+ *         Must be called while no jobs are queued on the driver.
+ */
+int ETHOSU_PMU_Capture_Enable(struct ethosu_driver *drv,
+                              struct ethosu_pmu_capture *capture,
+                              const enum ethosu_pmu_event_type *events,
+                              uint32_t num_events);
+
+/**
+ * \brief   Disable automatic PMU capture
+ * \note   Samples already in the capture ring can still be read.
+ */
+void ETHOSU_PMU_Capture_Disable(struct ethosu_driver *drv);
+
+/**
+ * \brief   Read the oldest sample from the capture ring
+ * \param [out]  sample       Sample read
+ * \return  true if a sample was read, false if the ring was empty
+ * \note   May be called from any single thread concurrently with the interrupt
+ *         handler adding samples.
+ */
+bool ETHOSU_PMU_Capture_Read(struct ethosu_pmu_capture *capture, struct ethosu_pmu_sample *sample);
+
+/**
+ * \brief   Initialize a profile of multiplexed events
+ * \param [in]   custom_data_ptr   Custom operator payload of the network to aggregate, NULL for all
+ */
+void ETHOSU_PMU_Profile_Init(struct ethosu_pmu_profile *profile, const void *custom_data_ptr);
+
+/**
+ * \brief   Add a capture sample to a profile
+ * \note   Samples of failed jobs and of other networks are ignored.
+ */
+void ETHOSU_PMU_Profile_Add(struct ethosu_pmu_profile *profile, const struct ethosu_pmu_sample *sample);
+
+/**
+ * \brief   Estimated count of an event per inference
+ * \return  Average count of the samples that counted the event, 0 if none did
+ */
+uint64_t ETHOSU_PMU_Profile_Get_Count(const struct ethosu_pmu_profile *profile, enum ethosu_pmu_event_type event);
+
+/**
+ * \brief   Events needed to derive all metrics
+ * \param [out]  events       Events, may be NULL if max_events is 0
+ * \param [in]   max_events   Size of the events array
+ * \return  Number of events needed, which may be larger than max_events
+ * \note   The events can be passed to ETHOSU_PMU_Capture_Enable(), which
+ *         multiplexes them over several inferences.
+ */
+uint32_t ETHOSU_PMU_Get_Metric_Events(enum ethosu_pmu_event_type *events, uint32_t max_events);
+
+/**
+ * \brief   Derive metrics from a profile
+ * \param [out]  metrics   Derived metrics
+ * \return  0 on success, -1 if the profile holds no cycles
+ * \note   A metric is only valid if the profile counted its event.
+ *         Does not access the NPU.
+ */
+int ETHOSU_PMU_Get_Metrics(const struct ethosu_pmu_profile *profile, struct ethosu_pmu_metrics *metrics);
+
+/**
+ * \brief   Name of a metric
+ * \return  Name, or NULL for an invalid metric
+ */
+const char *ETHOSU_PMU_Get_Metric_Name(enum ethosu_pmu_metric metric);
+
+/**
+ * \brief   Find the fastest of several AXI limit settings for a network
+ * \param [in]   capture          Capture state used for the measurements
+ * \param [in]   net              Prepared network
+ * \param [in]   base_addr        Base addresses passed to ethosu_invoke_prepared()
+ * \param [in]   base_addr_size   Sizes passed to ethosu_invoke_prepared()
+ * \param [in]   num_base_addr    Number of base addresses
+ * \param [in,out] tune           AXI limits to try, with the results filled in
+ * \param [in]   num_tune         Number of AXI limit settings
+ * \param [in]   num_runs         Number of inferences per setting, at least 1
+ * \return  Index of the setting with the fewest mean cycles, -1 on failure
+ * \note   Runs num_runs inferences per setting, with the limits programmed for
+ *         all AXI limit sets, and captures the cycles and the stalled AXI
+ *         transaction requests. The settings are compared on the mean of the
+ *         runs, and on a tie the setting with the fewest stalls wins. A setting
+ *         with any failed run is skipped. The region profile of the network is
+ *         restored afterwards, also on failure, and the best limits can be
+ *         applied with ethosu_set_axi_limit() or a region profile.
+ *         PMU capture must be disabled. The network runs with a temporary
+ *         region profile meanwhile, so it must not be invoked concurrently,
+ *         on this or any other driver.
+ */
+int ETHOSU_PMU_Tune_AXI_Limits(struct ethosu_driver *drv,
+                               struct ethosu_pmu_capture *capture,
+                               struct ethosu_network *net,
+                               uint64_t *const base_addr,
+                               const size_t *base_addr_size,
+                               int num_base_addr,
+                               struct ethosu_pmu_axi_tune *tune,
+                               uint32_t num_tune,
+                               uint32_t num_runs);
+
+/**
+ * \brief   Arm a PMU timeline for the next job
+ * \param [in]   timeline          Timeline state, must stay valid until the timeline is disabled
+ * \param [in]   custom_data_ptr   Custom operator payload of the network to record, NULL for any
+ * \param [in]   period_us         Sampling period passed to ethosu_pmu_timeline_timer_start()
+ * \return  0 on success, -1 on failure
+ * \note   The next job started for the network is recorded. The timeline can
+ *         be armed again once its state is ETHOSU_PMU_TIMELINE_DONE.
+ */
+int ETHOSU_PMU_Timeline_Enable(struct ethosu_driver *drv,
+                               struct ethosu_pmu_timeline *timeline,
+                               const void *custom_data_ptr,
+                               uint32_t period_us);
+
+/**
+ * \brief   Disable the PMU timeline
+ * \note   A recording in progress is stopped and left incomplete.
+ */
+void ETHOSU_PMU_Timeline_Disable(struct ethosu_driver *drv);
+
+/**
+ * \brief   Sample QREAD and the cycle counter of the running job
+ * \note   Called by the platform timer started with ethosu_pmu_timeline_timer_start().
+ *         Must not preempt, or be preempted by, ethosu_irq_handler().
+ */
+void ETHOSU_PMU_Timeline_Sample(struct ethosu_driver *drv);
+
+/**
+ * \brief   Attribute the cycles of a recorded timeline to the operations of its command stream
+ * \param [in]   ops       Operations listed by ethosu_command_stream_operations() for the
+ *                         command stream of the timeline
+ * \param [in]   num_ops   Number of operations
+ * \param [out]  cycles    Cycles per operation, num_ops entries
+ * \return  0 on success, -1 if the timeline has not been recorded
+ * \note   The cycles between two samples are attributed to the last operation
+ *         read by the NPU at the later sample, and cycles before the first
+ *         operation to the first operation. The NPU reads commands ahead of
+ *         the operation it executes, so the breakdown is only as accurate as
+ *         the sampling period. Does not access the NPU.
+ */
+int ETHOSU_PMU_Timeline_Get_Cycles(const struct ethosu_pmu_timeline *timeline,
+                                   const struct ethosu_operation *ops,
+                                   uint32_t num_ops,
+                                   uint64_t *cycles);
+
+/**
+ * \brief   Start a periodic timer for the PMU timeline (weak function)
+ * \param [in]   period_us   Period in microseconds
+ * \return  0 if the timer was started, else -1
+ * \note   Called when the recorded job is started, possibly from the interrupt
+ *         handler. The timer calls ETHOSU_PMU_Timeline_Sample() every period
+ *         until ethosu_pmu_timeline_timer_stop() is called. The default
+ *         implementation has no timer, in which case only the start and the
+ *         end of the job are sampled.
+ */
+int ethosu_pmu_timeline_timer_start(struct ethosu_driver *drv, uint32_t period_us);
+
+/**
+ * \brief   Stop the timer started by ethosu_pmu_timeline_timer_start() (weak function)
+ * \note   Called when the recorded job completes, from the interrupt handler.
+ */
+void ethosu_pmu_timeline_timer_stop(struct ethosu_driver *drv);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,880 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_cmd_analyzer.h"
+#include "ethosu_interface.h"
+#include "ethosu_log.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define CMD_OPCODE_MASK 0x3FF
+#define CMD_CONTROL_SHIFT 14
+#define CMD_CONTROL_MASK 0x3
+#define CMD_PARAM_SHIFT 16
+#define CMD1_ADDR_HI_MASK 0xFF
+
+// Feature maps are split in up to four tiles, each with its own base address
+#define FM_NUM_TILES 4
+
+// Bit fields of NPU_SET_IFM_PRECISION and NPU_SET_IFM2_PRECISION parameter
+#define IFM_PRECISION_SHIFT 2
+#define IFM_PRECISION_MASK 0x3
+#define IFM_STORAGE_SHIFT 14
+#define IFM_STORAGE_MASK 0x3
+
+// Bit fields of NPU_SET_OFM_PRECISION parameter
+#define OFM_PRECISION_SHIFT 1
+#define OFM_PRECISION_MASK 0x3
+#define OFM_REVERSE_TRANSPOSE_SHIFT 9
+#define OFM_REVERSE_TRANSPOSE_MASK 0x1F
+#define OFM_STORAGE_SHIFT 14
+#define OFM_STORAGE_MASK 0x3
+
+// Common to all feature maps
+#define FM_FORMAT_SHIFT 6
+#define FM_FORMAT_MASK 0x3
+
+// Bit fields of NPU_SET_KERNEL_STRIDE parameter
+#define KERNEL_STRIDE_X_LSB (1U << 0)
+#define KERNEL_STRIDE_Y_LSB (1U << 1)
+#define KERNEL_DILATION_X (1U << 3)
+#define KERNEL_DILATION_Y (1U << 4)
+#define KERNEL_STRIDE_X_MSB (1U << 6)
+#define KERNEL_STRIDE_Y_MSB (1U << 9)
+
+// Bit fields of NPU_SET_DMA0_SRC_REGION and NPU_SET_DMA0_DST_REGION parameter
+#define DMA_REGION_MASK 0x7
+#define DMA_REGION_MODE_SHIFT 8
+#define DMA_STRIDE_MODE_SHIFT 9
+#define DMA_STRIDE_MODE_MASK 0x3
+#define DMA_IDX_MODE_SHIFT 11
+
+// Bit fields of NPU_SET_IFM2_BROADCAST parameter
+#if defined(ETHOSU85)
+#define IFM2_BROADCAST_MODE_MASK 0xF
+#else
+#define IFM2_BROADCAST_CONSTANT (1U << 7)
+#endif
+
+// NPU_SET_IFM_UPSCALE parameter
+#define IFM_UPSCALE_MASK 0x3
+
+// NPU_OP_ELEMENTWISE parameter
+#define ELEMENTWISE_MODE_MASK 0x3F
+
+// Region field of NPU_SET_xFM_REGION, NPU_SET_WEIGHT_REGION and NPU_SET_SCALE_REGION
+#define REGION_MASK 0x7
+
+// NPU_OP_CONV parameter, weights are read from IFM2
+#define CONV_WEIGHTS_IFM2 (1U << 0)
+
+#if defined(ETHOSU85)
+#define NUM_WEIGHT_STREAMS 4
+#define NUM_SCALE_STREAMS 1
+#elif defined(ETHOSU65)
+#define NUM_WEIGHT_STREAMS 2
+#define NUM_SCALE_STREAMS 2
+#else
+#define NUM_WEIGHT_STREAMS 1
+#define NUM_SCALE_STREAMS 1
+#endif
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+struct fm_state
+{
+    uint32_t region;
+    uint64_t base[FM_NUM_TILES];
+    uint64_t stride_x;
+    uint64_t stride_y;
+    uint64_t stride_c;
+    uint32_t width0_m1;
+    uint32_t height0_m1;
+    uint32_t height1_m1;
+    uint32_t depth_m1;
+    uint32_t precision; // Parameter of NPU_SET_xFM_PRECISION
+};
+
+struct fm_shape
+{
+    uint64_t width;
+    uint64_t height;
+    uint64_t depth;
+};
+
+// Register state as programmed by the command stream
+struct cms_state
+{
+    struct fm_state ifm;
+    struct fm_state ifm2;
+    struct fm_state ofm;
+    uint32_t ofm_width_m1;
+    uint32_t ofm_height_m1;
+    uint32_t ifm_upscale;
+    uint32_t ifm2_broadcast;
+    uint32_t kernel_width_m1;
+    uint32_t kernel_height_m1;
+    uint32_t kernel_stride;
+    uint32_t weight_region;
+    uint64_t weight_base[NUM_WEIGHT_STREAMS];
+    uint64_t weight_length[NUM_WEIGHT_STREAMS];
+    uint32_t scale_region;
+    uint64_t scale_base[NUM_SCALE_STREAMS];
+    uint64_t scale_length[NUM_SCALE_STREAMS];
+    uint32_t dma_src_region;
+    uint32_t dma_dst_region;
+    uint32_t dma_idx_region;
+    uint64_t dma_src;
+    uint64_t dma_dst;
+    uint64_t dma_len;
+};
+
+/******************************************************************************
+ * Static functions
+ ******************************************************************************/
+
+static uint32_t read_word(const uint8_t *cmd_stream, const uint32_t index)
+{
+    uint32_t word;
+
+    // The command stream is not guaranteed to be word aligned on the host
+    memcpy(&word, &cmd_stream[index * sizeof(uint32_t)], sizeof(word));
+
+    return word;
+}
+
+static void range_unbounded(struct ethosu_range *range)
+{
+    range->offset = 0;
+    range->size   = SIZE_MAX;
+}
+
+static void range_add(struct ethosu_range *range, const uint64_t offset, const uint64_t size)
+{
+    uint64_t start = offset;
+    uint64_t end   = offset + size;
+
+    if (size == 0 || range->size == SIZE_MAX)
+    {
+        return;
+    }
+
+    if (end < offset || end > SIZE_MAX)
+    {
+        range_unbounded(range);
+        return;
+    }
+
+    if (range->size != 0)
+    {
+        start = start < range->offset ? start : range->offset;
+        end   = end > range->offset + range->size ? end : range->offset + range->size;
+    }
+
+    range->offset = (size_t)start;
+    range->size   = (size_t)(end - start);
+}
+
+/*
+ * Bytes spanned by a block of 'rows' x 'cols' x 'depth' elements, starting
+ * at the tile base address.
+ */
+static uint64_t fm_extent(const struct fm_state *fm,
+                          const uint64_t rows,
+                          const uint64_t cols,
+                          const uint64_t depth,
+                          const uint32_t element_size)
+{
+    uint64_t channels;
+
+    if (((fm->precision >> FM_FORMAT_SHIFT) & FM_FORMAT_MASK) == ACTIVATION_FORMAT_NHCWB16)
+    {
+        channels = ((depth + 15) / 16 - 1) * fm->stride_c + 16 * element_size;
+    }
+    else
+    {
+        channels = depth * element_size;
+    }
+
+    return (rows - 1) * fm->stride_y + (cols - 1) * fm->stride_x + channels;
+}
+
+/*
+ * Add the tiles of a feature map to the region ranges. Tile 0 is top left,
+ * tile 1 top right, tile 2 bottom left and tile 3 bottom right.
+ */
+static void fm_access(struct ethosu_range *ranges,
+                      const struct fm_state *fm,
+                      const struct fm_shape *shape,
+                      const uint32_t element_size,
+                      const bool tile_3x1)
+{
+    const uint64_t width0  = (uint64_t)fm->width0_m1 + 1;
+    const uint64_t height0 = (uint64_t)fm->height0_m1 + 1;
+    const uint64_t height1 = (uint64_t)fm->height1_m1 + 1;
+    uint64_t rows[FM_NUM_TILES];
+    uint64_t cols[FM_NUM_TILES];
+
+    rows[0] = shape->height < height0 ? shape->height : height0;
+    cols[0] = shape->width < width0 ? shape->width : width0;
+    rows[1] = shape->height < height1 ? shape->height : height1;
+    cols[1] = shape->width > width0 ? shape->width - width0 : 0;
+    rows[2] = shape->height > height0 ? shape->height - height0 : 0;
+    cols[2] = cols[0];
+    rows[3] = shape->height > height1 ? shape->height - height1 : 0;
+    cols[3] = cols[1];
+
+    if (tile_3x1)
+    {
+        // Tiles side by side, bound each of them by the full feature map
+        for (int i = 1; i < FM_NUM_TILES; i++)
+        {
+            rows[i] = cols[1] != 0 ? shape->height : 0;
+            cols[i] = cols[1] != 0 ? shape->width : 0;
+        }
+    }
+
+    for (int i = 0; i < FM_NUM_TILES; i++)
+    {
+        if (rows[i] != 0 && cols[i] != 0)
+        {
+            range_add(&ranges[fm->region], fm->base[i], fm_extent(fm, rows[i], cols[i], shape->depth, element_size));
+        }
+    }
+}
+
+/*
+ * Number of IFM elements along one dimension needed to produce 'ofm_dim'
+ * OFM elements. Padding is ignored, which can only make the result larger.
+ */
+static uint64_t ifm_dim(const uint64_t ofm_dim,
+                        const uint32_t stride,
+                        const uint32_t kernel_m1,
+                        const uint32_t dilation,
+                        const bool upscale)
+{
+    uint64_t last = (ofm_dim - 1) * stride + (uint64_t)kernel_m1 * dilation;
+
+    if (upscale)
+    {
+        last >>= 1;
+    }
+
+    return last + 1;
+}
+
+static bool ifm2_is_read(const struct cms_state *state, const uint32_t mode)
+{
+    // Unary operations
+    if (mode == ELEMENTWISE_MODE_LRELU || mode == ELEMENTWISE_MODE_ABS || mode == ELEMENTWISE_MODE_CLZ)
+    {
+        return false;
+    }
+
+#if defined(ETHOSU85)
+    return (state->ifm2_broadcast & IFM2_BROADCAST_MODE_MASK) != BROADCAST_MODE_SCALAR;
+#else
+    return (state->ifm2_broadcast & IFM2_BROADCAST_CONSTANT) == 0;
+#endif
+}
+
+static void cms_op_kernel(const struct cms_state *state,
+                          struct ethosu_footprint *footprint,
+                          const uint32_t opcode,
+                          const uint32_t param)
+{
+    const uint32_t ifm_element  = 1U << ((state->ifm.precision >> IFM_PRECISION_SHIFT) & IFM_PRECISION_MASK);
+    const uint32_t ifm2_element = 1U << ((state->ifm2.precision >> IFM_PRECISION_SHIFT) & IFM_PRECISION_MASK);
+    const uint32_t ofm_element  = 1U << ((state->ofm.precision >> OFM_PRECISION_SHIFT) & OFM_PRECISION_MASK);
+    bool ifm_tile_3x1           = false;
+    bool ifm2_tile_3x1          = false;
+    bool ofm_tile_3x1           = false;
+    bool ifm_bounded            = true;
+    bool ofm_bounded            = true;
+    bool weights_ifm2           = false;
+    struct fm_shape ofm;
+    struct fm_shape ifm;
+
+    ofm.width  = (uint64_t)state->ofm_width_m1 + 1;
+    ofm.height = (uint64_t)state->ofm_height_m1 + 1;
+    ofm.depth  = (uint64_t)state->ofm.depth_m1 + 1;
+
+    ifm.depth = (uint64_t)state->ifm.depth_m1 + 1;
+
+#if defined(ETHOSU85)
+    ifm_tile_3x1  = ((state->ifm.precision >> IFM_STORAGE_SHIFT) & IFM_STORAGE_MASK) == ACTIVATION_STORAGE_TILE3X1;
+    ifm2_tile_3x1 = ((state->ifm2.precision >> IFM_STORAGE_SHIFT) & IFM_STORAGE_MASK) == ACTIVATION_STORAGE_TILE3X1;
+    ofm_tile_3x1  = ((state->ofm.precision >> OFM_STORAGE_SHIFT) & OFM_STORAGE_MASK) == ACTIVATION_STORAGE_TILE3X1;
+
+    // Reversed or transposed output is not bounded by the OFM tile layout
+    if (((state->ofm.precision >> OFM_REVERSE_TRANSPOSE_SHIFT) & OFM_REVERSE_TRANSPOSE_MASK) != 0)
+    {
+        ofm_bounded = false;
+    }
+
+    // The IFM size of a resize depends on the scale factors
+    if (opcode == CMD0_OPCODE_NPU_OP_RESIZE)
+    {
+        ifm_bounded = false;
+    }
+
+    weights_ifm2 = opcode == CMD0_OPCODE_NPU_OP_CONV && (param & CONV_WEIGHTS_IFM2) != 0;
+#endif
+
+    if (opcode == CMD0_OPCODE_NPU_OP_ELEMENTWISE)
+    {
+        ifm.width  = ofm.width;
+        ifm.height = ofm.height;
+    }
+    else
+    {
+        const uint32_t stride_x = (((state->kernel_stride & KERNEL_STRIDE_X_MSB) ? 2 : 0) |
+                                   ((state->kernel_stride & KERNEL_STRIDE_X_LSB) ? 1 : 0)) +
+                                  1;
+        const uint32_t stride_y = (((state->kernel_stride & KERNEL_STRIDE_Y_MSB) ? 2 : 0) |
+                                   ((state->kernel_stride & KERNEL_STRIDE_Y_LSB) ? 1 : 0)) +
+                                  1;
+        const uint32_t dilation_x = (state->kernel_stride & KERNEL_DILATION_X) ? 2 : 1;
+        const uint32_t dilation_y = (state->kernel_stride & KERNEL_DILATION_Y) ? 2 : 1;
+        const bool upscale        = state->ifm_upscale != IFM_UPSCALE_MODE_NONE;
+
+        ifm.width  = ifm_dim(ofm.width, stride_x, state->kernel_width_m1, dilation_x, upscale);
+        ifm.height = ifm_dim(ofm.height, stride_y, state->kernel_height_m1, dilation_y, upscale);
+    }
+
+    if (ifm_bounded)
+    {
+        fm_access(footprint->read, &state->ifm, &ifm, ifm_element, ifm_tile_3x1);
+    }
+    else
+    {
+        range_unbounded(&footprint->read[state->ifm.region]);
+    }
+
+    if (weights_ifm2)
+    {
+        range_unbounded(&footprint->read[state->ifm2.region]);
+    }
+    else if (opcode == CMD0_OPCODE_NPU_OP_ELEMENTWISE && ifm2_is_read(state, param & ELEMENTWISE_MODE_MASK))
+    {
+        fm_access(footprint->read, &state->ifm2, &ifm, ifm2_element, ifm2_tile_3x1);
+    }
+
+    if (ofm_bounded)
+    {
+        fm_access(footprint->write, &state->ofm, &ofm, ofm_element, ofm_tile_3x1);
+    }
+    else
+    {
+        range_unbounded(&footprint->write[state->ofm.region]);
+    }
+
+    if ((opcode == CMD0_OPCODE_NPU_OP_CONV && !weights_ifm2) || opcode == CMD0_OPCODE_NPU_OP_DEPTHWISE)
+    {
+        for (int i = 0; i < NUM_WEIGHT_STREAMS; i++)
+        {
+            range_add(&footprint->read[state->weight_region], state->weight_base[i], state->weight_length[i]);
+        }
+
+        for (int i = 0; i < NUM_SCALE_STREAMS; i++)
+        {
+            range_add(&footprint->read[state->scale_region], state->scale_base[i], state->scale_length[i]);
+        }
+    }
+}
+
+static void cms_op_dma(const struct cms_state *state, struct ethosu_footprint *footprint)
+{
+    const uint32_t src_region = state->dma_src_region & DMA_REGION_MASK;
+    const uint32_t dst_region = state->dma_dst_region & DMA_REGION_MASK;
+    const bool src_external =
+        ((state->dma_src_region >> DMA_REGION_MODE_SHIFT) & 1) == DMA_REGION_MODE_EXTERNAL;
+    const bool dst_external =
+        ((state->dma_dst_region >> DMA_REGION_MODE_SHIFT) & 1) == DMA_REGION_MODE_EXTERNAL;
+    bool bounded =
+        ((state->dma_src_region >> DMA_STRIDE_MODE_SHIFT) & DMA_STRIDE_MODE_MASK) == DMA_STRIDE_MODE_D1;
+
+#if defined(ETHOSU85)
+    // Gather and scatter transfers depend on the contents of the index tensor
+    if (((state->dma_src_region >> DMA_IDX_MODE_SHIFT) & 1) == DMA_IDX_MODE_ENABLED ||
+        ((state->dma_dst_region >> DMA_IDX_MODE_SHIFT) & 1) == DMA_IDX_MODE_ENABLED)
+    {
+        range_unbounded(&footprint->read[state->dma_idx_region & DMA_REGION_MASK]);
+        bounded = false;
+    }
+#elif defined(ETHOSU65)
+    bounded = bounded &&
+              ((state->dma_dst_region >> DMA_STRIDE_MODE_SHIFT) & DMA_STRIDE_MODE_MASK) == DMA_STRIDE_MODE_D1;
+#endif
+
+    if (src_external)
+    {
+        if (bounded)
+        {
+            range_add(&footprint->read[src_region], state->dma_src, state->dma_len);
+        }
+        else
+        {
+            range_unbounded(&footprint->read[src_region]);
+        }
+    }
+
+    if (dst_external)
+    {
+        if (bounded)
+        {
+            range_add(&footprint->write[dst_region], state->dma_dst, state->dma_len);
+        }
+        else
+        {
+            range_unbounded(&footprint->write[dst_region]);
+        }
+    }
+}
+
+/*
+ * Handle a command without payload. Returns 1 when the end of the command
+ * stream has been reached.
+ */
+static int cms_cmd0(struct cms_state *state,
+                    struct ethosu_footprint *footprint,
+                    const uint32_t opcode,
+                    const uint32_t param)
+{
+    switch (opcode)
+    {
+    case CMD0_OPCODE_NPU_OP_STOP:
+        return 1;
+    case CMD0_OPCODE_NPU_OP_CONV:
+    case CMD0_OPCODE_NPU_OP_DEPTHWISE:
+    case CMD0_OPCODE_NPU_OP_POOL:
+    case CMD0_OPCODE_NPU_OP_ELEMENTWISE:
+#if defined(ETHOSU85)
+    case CMD0_OPCODE_NPU_OP_RESIZE:
+#endif
+        cms_op_kernel(state, footprint, opcode, param);
+        break;
+    case CMD0_OPCODE_NPU_OP_DMA_START:
+        cms_op_dma(state, footprint);
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM_PRECISION:
+        state->ifm.precision = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM_UPSCALE:
+        state->ifm_upscale = param & IFM_UPSCALE_MASK;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM_DEPTH_M1:
+        state->ifm.depth_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM_WIDTH0_M1:
+        state->ifm.width0_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM_HEIGHT0_M1:
+        state->ifm.height0_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM_HEIGHT1_M1:
+        state->ifm.height1_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM_REGION:
+        state->ifm.region = param & REGION_MASK;
+        break;
+    case CMD0_OPCODE_NPU_SET_OFM_WIDTH_M1:
+        state->ofm_width_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_OFM_HEIGHT_M1:
+        state->ofm_height_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_OFM_DEPTH_M1:
+        state->ofm.depth_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_OFM_PRECISION:
+        state->ofm.precision = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_OFM_WIDTH0_M1:
+        state->ofm.width0_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_OFM_HEIGHT0_M1:
+        state->ofm.height0_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_OFM_HEIGHT1_M1:
+        state->ofm.height1_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_OFM_REGION:
+        state->ofm.region = param & REGION_MASK;
+        break;
+    case CMD0_OPCODE_NPU_SET_KERNEL_WIDTH_M1:
+        state->kernel_width_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_KERNEL_HEIGHT_M1:
+        state->kernel_height_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_KERNEL_STRIDE:
+        state->kernel_stride = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_WEIGHT_REGION:
+        state->weight_region = param & REGION_MASK;
+        break;
+    case CMD0_OPCODE_NPU_SET_SCALE_REGION:
+        state->scale_region = param & REGION_MASK;
+        break;
+    case CMD0_OPCODE_NPU_SET_DMA0_SRC_REGION:
+        state->dma_src_region = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_DMA0_DST_REGION:
+        state->dma_dst_region = param;
+        break;
+#if defined(ETHOSU85)
+    case CMD0_OPCODE_NPU_SET_DMA0_IDX_REGION:
+        state->dma_idx_region = param & REGION_MASK;
+        break;
+#endif
+    case CMD0_OPCODE_NPU_SET_IFM2_BROADCAST:
+        state->ifm2_broadcast = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM2_PRECISION:
+        state->ifm2.precision = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM2_WIDTH0_M1:
+        state->ifm2.width0_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM2_HEIGHT0_M1:
+        state->ifm2.height0_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM2_HEIGHT1_M1:
+        state->ifm2.height1_m1 = param;
+        break;
+    case CMD0_OPCODE_NPU_SET_IFM2_REGION:
+        state->ifm2.region = param & REGION_MASK;
+        break;
+    default:
+        // Commands not affecting memory accesses
+        break;
+    }
+
+    return 0;
+}
+
+/*
+ * Handle a command with 32-bit payload. Returns -1 if the command stream can
+ * not be analyzed.
+ */
+static int cms_cmd1(struct cms_state *state, const uint32_t opcode, const uint64_t value)
+{
+    switch (opcode)
+    {
+    case CMD1_OPCODE_NPU_SET_IFM_BASE0:
+    case CMD1_OPCODE_NPU_SET_IFM_BASE1:
+    case CMD1_OPCODE_NPU_SET_IFM_BASE2:
+    case CMD1_OPCODE_NPU_SET_IFM_BASE3:
+        state->ifm.base[opcode - CMD1_OPCODE_NPU_SET_IFM_BASE0] = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_IFM_STRIDE_X:
+        state->ifm.stride_x = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_IFM_STRIDE_Y:
+        state->ifm.stride_y = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_IFM_STRIDE_C:
+        state->ifm.stride_c = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_OFM_BASE0:
+    case CMD1_OPCODE_NPU_SET_OFM_BASE1:
+    case CMD1_OPCODE_NPU_SET_OFM_BASE2:
+    case CMD1_OPCODE_NPU_SET_OFM_BASE3:
+        state->ofm.base[opcode - CMD1_OPCODE_NPU_SET_OFM_BASE0] = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_OFM_STRIDE_X:
+        state->ofm.stride_x = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_OFM_STRIDE_Y:
+        state->ofm.stride_y = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_OFM_STRIDE_C:
+        state->ofm.stride_c = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_WEIGHT_BASE:
+        state->weight_base[0] = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_WEIGHT_LENGTH:
+        state->weight_length[0] = (uint32_t)value;
+        break;
+    case CMD1_OPCODE_NPU_SET_SCALE_BASE:
+        state->scale_base[0] = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_SCALE_LENGTH:
+        state->scale_length[0] = (uint32_t)value;
+        break;
+#if defined(ETHOSU65)
+    case CMD1_OPCODE_NPU_SET_WEIGHT1_BASE:
+        state->weight_base[1] = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_WEIGHT1_LENGTH:
+        state->weight_length[1] = (uint32_t)value;
+        break;
+    case CMD1_OPCODE_NPU_SET_SCALE1_BASE:
+        state->scale_base[1] = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_SCALE1_LENGTH:
+        state->scale_length[1] = (uint32_t)value;
+        break;
+#elif defined(ETHOSU85)
+    case CMD1_OPCODE_NPU_SET_WEIGHT1_BASE:
+    case CMD1_OPCODE_NPU_SET_WEIGHT2_BASE:
+    case CMD1_OPCODE_NPU_SET_WEIGHT3_BASE:
+        state->weight_base[1 + (opcode - CMD1_OPCODE_NPU_SET_WEIGHT1_BASE) / 2] = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_WEIGHT1_LENGTH:
+    case CMD1_OPCODE_NPU_SET_WEIGHT2_LENGTH:
+    case CMD1_OPCODE_NPU_SET_WEIGHT3_LENGTH:
+        state->weight_length[1 + (opcode - CMD1_OPCODE_NPU_SET_WEIGHT1_LENGTH) / 2] = (uint32_t)value;
+        break;
+    case CMD1_OPCODE_NPU_OP_BRANCH:
+        // Register state at each operation depends on the path taken
+        LOG_DEBUG("Command stream branch can not be analyzed");
+        return -1;
+#endif
+    case CMD1_OPCODE_NPU_SET_DMA0_SRC:
+        state->dma_src = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_DMA0_DST:
+        state->dma_dst = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_DMA0_LEN:
+        state->dma_len = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_IFM2_BASE0:
+    case CMD1_OPCODE_NPU_SET_IFM2_BASE1:
+    case CMD1_OPCODE_NPU_SET_IFM2_BASE2:
+    case CMD1_OPCODE_NPU_SET_IFM2_BASE3:
+        state->ifm2.base[opcode - CMD1_OPCODE_NPU_SET_IFM2_BASE0] = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_IFM2_STRIDE_X:
+        state->ifm2.stride_x = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_IFM2_STRIDE_Y:
+        state->ifm2.stride_y = value;
+        break;
+    case CMD1_OPCODE_NPU_SET_IFM2_STRIDE_C:
+        state->ifm2.stride_c = value;
+        break;
+    default:
+        // Commands not affecting memory accesses
+        break;
+    }
+
+    return 0;
+}
+
+static bool is_operation(const uint32_t opcode)
+{
+    switch (opcode)
+    {
+    case CMD0_OPCODE_NPU_OP_CONV:
+    case CMD0_OPCODE_NPU_OP_DEPTHWISE:
+    case CMD0_OPCODE_NPU_OP_POOL:
+    case CMD0_OPCODE_NPU_OP_ELEMENTWISE:
+#if defined(ETHOSU85)
+    case CMD0_OPCODE_NPU_OP_RESIZE:
+#endif
+    case CMD0_OPCODE_NPU_OP_DMA_START:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool ranges_overlap(const uint64_t a_base,
+                           const struct ethosu_range *a,
+                           const uint64_t b_base,
+                           const struct ethosu_range *b)
+{
+    if (a->size == 0 || b->size == 0)
+    {
+        return false;
+    }
+
+    if (a->size == SIZE_MAX || b->size == SIZE_MAX)
+    {
+        return true;
+    }
+
+    return a_base + a->offset < b_base + b->offset + b->size && b_base + b->offset < a_base + a->offset + a->size;
+}
+
+static bool footprint_writes_to(const struct ethosu_footprint *writer,
+                                const uint64_t *writer_base_addr,
+                                const int writer_num_base_addr,
+                                const struct ethosu_footprint *other,
+                                const uint64_t *other_base_addr,
+                                const int other_num_base_addr)
+{
+    for (int i = 0; i < writer_num_base_addr && i < ETHOSU_MAX_BASE_ADDR; i++)
+    {
+        for (int j = 0; j < other_num_base_addr && j < ETHOSU_MAX_BASE_ADDR; j++)
+        {
+            if (ranges_overlap(writer_base_addr[i], &writer->write[i], other_base_addr[j], &other->read[j]) ||
+                ranges_overlap(writer_base_addr[i], &writer->write[i], other_base_addr[j], &other->write[j]))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/******************************************************************************
+ * API functions
+ ******************************************************************************/
+
+int ethosu_analyze_command_stream(const uint8_t *cmd_stream,
+                                  const uint32_t cms_length,
+                                  struct ethosu_footprint *footprint)
+{
+    const uint32_t num_words = cms_length / sizeof(uint32_t);
+    struct cms_state state;
+    uint32_t i = 0;
+
+    assert(cmd_stream != NULL);
+    assert(footprint != NULL);
+
+    memset(footprint, 0, sizeof(struct ethosu_footprint));
+    memset(&state, 0, sizeof(state));
+
+    while (i < num_words)
+    {
+        const uint32_t word    = read_word(cmd_stream, i++);
+        const uint32_t opcode  = word & CMD_OPCODE_MASK;
+        const uint32_t control = (word >> CMD_CONTROL_SHIFT) & CMD_CONTROL_MASK;
+        const uint32_t param   = word >> CMD_PARAM_SHIFT;
+
+        if (control == CMD_CTRL_CMD0_CTRL)
+        {
+            if (cms_cmd0(&state, footprint, opcode, param) > 0)
+            {
+                break;
+            }
+        }
+        else
+        {
+            uint64_t value;
+
+            if (i >= num_words)
+            {
+                LOG_ERR("Command stream truncated. offset=%" PRIu32, (i - 1) * (uint32_t)sizeof(uint32_t));
+                return -1;
+            }
+
+            // Addresses and strides may be extended with 8 bits in the parameter field
+            value = ((uint64_t)(param & CMD1_ADDR_HI_MASK) << 32) | read_word(cmd_stream, i++);
+
+            if (cms_cmd1(&state, opcode, value) < 0)
+            {
+                memset(footprint, 0, sizeof(struct ethosu_footprint));
+                return 0;
+            }
+        }
+    }
+
+    footprint->complete = true;
+
+    return 0;
+}
+
+int ethosu_command_stream_operations(const uint8_t *cmd_stream,
+                                     const uint32_t cms_length,
+                                     struct ethosu_operation *ops,
+                                     const uint32_t max_ops)
+{
+    const uint32_t num_words = cms_length / sizeof(uint32_t);
+    uint32_t num_ops         = 0;
+    uint32_t i               = 0;
+
+    assert(cmd_stream != NULL);
+    assert(ops != NULL || max_ops == 0);
+
+    while (i < num_words)
+    {
+        const uint32_t offset  = i * (uint32_t)sizeof(uint32_t);
+        const uint32_t word    = read_word(cmd_stream, i++);
+        const uint32_t opcode  = word & CMD_OPCODE_MASK;
+        const uint32_t control = (word >> CMD_CONTROL_SHIFT) & CMD_CONTROL_MASK;
+
+        if (control != CMD_CTRL_CMD0_CTRL)
+        {
+            if (i >= num_words)
+            {
+                LOG_ERR("Command stream truncated. offset=%" PRIu32, offset);
+                return -1;
+            }
+
+            // Skip the payload
+            i++;
+            continue;
+        }
+
+        if (opcode == CMD0_OPCODE_NPU_OP_STOP)
+        {
+            break;
+        }
+
+        if (is_operation(opcode))
+        {
+            if (num_ops < max_ops)
+            {
+                ops[num_ops].offset = offset;
+                ops[num_ops].opcode = opcode;
+            }
+
+            num_ops++;
+        }
+    }
+
+    return (int)num_ops;
+}
+
+bool ethosu_footprint_conflict(const struct ethosu_footprint *a,
+                               const uint64_t *a_base_addr,
+                               const int a_num_base_addr,
+                               const struct ethosu_footprint *b,
+                               const uint64_t *b_base_addr,
+                               const int b_num_base_addr)
+{
+    assert(a != NULL);
+    assert(b != NULL);
+
+    if (!a->complete || !b->complete)
+    {
+        return true;
+    }
+
+    return footprint_writes_to(a, a_base_addr, a_num_base_addr, b, b_base_addr, b_num_base_addr) ||
+           footprint_writes_to(b, b_base_addr, b_num_base_addr, a, a_base_addr, a_num_base_addr);
+}
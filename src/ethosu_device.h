@@ -53,14 +53,63 @@ enum ethosu_error_codes ethosu_dev_axi_init(struct ethosu_device *dev);
  *                             - 1: scratch tensor
  *                             - All input tensors
  *                             - All output tensors
+ * \param[in] region_cfg       Array of REGIONCFG memory configs per base
+ *                             address, negative for the one selected by
+ *                             ethosu_config_select(). May be NULL.
  * \param[in] num_base_addr    Number of base addresses.
  */
 void ethosu_dev_run_command_stream(struct ethosu_device *dev,
                                    const uint8_t *cmd_stream_ptr,
                                    uint32_t cms_length,
                                    const uint64_t *base_addr,
+                                   const int *region_cfg,
                                    int num_base_addr);
 
+/**
+ * Set the memory attributes of a memory config selected by REGIONCFG, written
+ * to MEM_ATTR on Ethos-U85 and to the AXI_LIMIT memtype on Ethos-U55/U65. The
+ * register is only written if the value differs from the cached one.
+ * \param[in] index            Memory config, 0 to ETHOSU_MEM_ATTR_COUNT - 1
+ * \param[in] attr             Memory attributes
+ */
+void ethosu_dev_set_mem_attr(struct ethosu_device *dev, int index, uint32_t attr);
+
+/**
+ * Get the cached memory attributes of a memory config.
+ * \param[in] index            Memory config, 0 to ETHOSU_MEM_ATTR_COUNT - 1
+ * \return                     Memory attributes
+ */
+uint32_t ethosu_dev_get_mem_attr(struct ethosu_device *dev, int index);
+
+/**
+ * Number of AXI limit sets, AXI_LIMIT0-3 selected by the memory config on
+ * Ethos-U55/U65, and AXI_SRAM and AXI_EXT on Ethos-U85.
+ */
+int ethosu_dev_axi_limit_count(void);
+
+/**
+ * Verify that AXI limits fit the register fields of the device.
+ * \param[in] index            AXI limit set
+ * \param[in] limit            AXI limits
+ * \return                     true if the limits can be programmed, false otherwise
+ */
+bool ethosu_dev_verify_axi_limit(int index, const struct ethosu_axi_limit *limit);
+
+/**
+ * Set the AXI limits of a limit set. The register is only written if the value
+ * differs from the cached one. The limits must have been verified.
+ * \param[in] index            AXI limit set
+ * \param[in] limit            AXI limits
+ */
+void ethosu_dev_set_axi_limit(struct ethosu_device *dev, int index, const struct ethosu_axi_limit *limit);
+
+/**
+ * Get the cached AXI limits of a limit set.
+ * \param[in] index            AXI limit set
+ * \param[out] limit           AXI limits
+ */
+void ethosu_dev_get_axi_limit(struct ethosu_device *dev, int index, struct ethosu_axi_limit *limit);
+
 /**
  * Print information on NPU error status
  */
@@ -72,6 +121,13 @@ void ethosu_dev_print_err_status(struct ethosu_device *dev);
  */
 bool ethosu_dev_handle_interrupt(struct ethosu_device *dev);
 
+/**
+ * Clear an interrupt raised only by the PMU while a command stream is running.
+ * \return                     true if the interrupt was cleared, false if it
+ *                             must be handled by ethosu_dev_handle_interrupt()
+ */
+bool ethosu_dev_handle_pmu_interrupt(struct ethosu_device *dev);
+
 /**
  * Get hardware information from NPU
  * \param[out] hwinfo          Pointer to the hardware info struct to be filled in.
@@ -84,12 +140,28 @@ void ethosu_dev_get_hw_info(struct ethosu_device *dev, struct ethosu_hw_info *hw
  */
 bool ethosu_dev_verify_access_state(struct ethosu_device *dev);
 
+/**
+ * Check if the NPU can run a new command stream without a soft reset. The NPU
+ * must be stopped in the requested security state and privilege mode, without
+ * any faults or pending interrupts. AXI configuration registers that differ
+ * from the cached values, e.g. after the NPU has been powered down, are
+ * rewritten.
+ * \return                     true if the NPU is ready, false if it must be reset
+ */
+bool ethosu_dev_warm_start(struct ethosu_device *dev);
+
 /**
  * Performs a NPU soft reset and waits for the NPU to become ready
  * \return                     \ref ethosu_error_codes
  */
 enum ethosu_error_codes ethosu_dev_soft_reset(struct ethosu_device *dev);
 
+/**
+ * Request the NPU to stop after completing the commands already started. The
+ * NPU must be soft reset before it runs another command stream.
+ */
+void ethosu_dev_stop(struct ethosu_device *dev);
+
 /**
  * Enable/disable clock and power using clock/power q interface.
  * \param[in] clock_q          Clock q ENABLE/DISABLE \ref clock_q_request.
@@ -47,6 +47,58 @@
 #define NPU_CMD_PWR_CLK_MASK (0xC)
 #define NPU_MAC_PWR_RAMP_CYCLES_MASK (0x3F)
 
+#define AXI_CFG_COUNT 7
+
+// AXI_SRAM and AXI_EXT follow the MEM_ATTR entries in the AXI configuration
+#define AXI_LIMIT_FIRST 4
+#define AXI_LIMIT_COUNT 2
+
+/******************************************************************************
+ * Static functions
+ ******************************************************************************/
+
+static volatile uint32_t *axi_cfg_reg(struct ethosu_device *dev, int index)
+{
+    volatile uint32_t *regs[AXI_CFG_COUNT] = {&dev->reg->MEM_ATTR[0].word,
+                                              &dev->reg->MEM_ATTR[1].word,
+                                              &dev->reg->MEM_ATTR[2].word,
+                                              &dev->reg->MEM_ATTR[3].word,
+                                              &dev->reg->AXI_SRAM.word,
+                                              &dev->reg->AXI_EXT.word,
+                                              &dev->reg->POWER_CTRL.word};
+
+    return regs[index];
+}
+
+static void axi_cfg_init(struct ethosu_device *dev)
+{
+    struct axi_sram_r axi_s = {0};
+    struct axi_ext_r axi_e  = {0};
+
+    // Configure MEM_ATTR array. These are user configurable,
+    // and each region will be set to use one of the entries
+    // as its config.
+    dev->axi_cfg[0] = NPU_MEM_ATTR_0;
+    dev->axi_cfg[1] = NPU_MEM_ATTR_1;
+    dev->axi_cfg[2] = NPU_MEM_ATTR_2;
+    dev->axi_cfg[3] = NPU_MEM_ATTR_3;
+
+    // Set AXI limits on SRAM AXI interfaces
+    axi_s.max_outstanding_read_m1  = AXI_LIMIT_SRAM_MAX_OUTSTANDING_READ_M1 - 1;
+    axi_s.max_outstanding_write_m1 = AXI_LIMIT_SRAM_MAX_OUTSTANDING_WRITE_M1 - 1;
+    axi_s.max_beats                = AXI_LIMIT_SRAM_MAX_BEATS;
+    dev->axi_cfg[4]                = axi_s.word;
+
+    // Set AXI limits on EXT AXI interface(s)
+    axi_e.max_outstanding_read_m1  = AXI_LIMIT_EXT_MAX_OUTSTANDING_READ_M1 - 1;
+    axi_e.max_outstanding_write_m1 = AXI_LIMIT_EXT_MAX_OUTSTANDING_WRITE_M1 - 1;
+    axi_e.max_beats                = AXI_LIMIT_EXT_MAX_BEATS;
+    dev->axi_cfg[5]                = axi_e.word;
+
+    // MAC power ramping up/down control
+    dev->axi_cfg[6] = NPU_MAC_PWR_RAMP_CYCLES & NPU_MAC_PWR_RAMP_CYCLES_MASK;
+}
+
 /******************************************************************************
  * Functions
  ******************************************************************************/
@@ -93,10 +145,12 @@ bool ethosu_dev_init(struct ethosu_device *dev, void *base_address, uint32_t sec
 
     if (dev->reg->CONFIG.product != ETHOSU_PRODUCT_U85)
     {
-        LOG_ERR("Failed to initialize device. Driver has not been compiled for this product");
+        DEV_LOG_ERR(dev, "Failed to initialize device. Driver has not been compiled for this product");
         return false;
     }
 
+    axi_cfg_init(dev);
+
     // Make sure the NPU is in a known state
     if (ethosu_dev_soft_reset(dev) != ETHOSU_SUCCESS)
     {
@@ -108,28 +162,10 @@ bool ethosu_dev_init(struct ethosu_device *dev, void *base_address, uint32_t sec
 
 enum ethosu_error_codes ethosu_dev_axi_init(struct ethosu_device *dev)
 {
-    struct axi_sram_r axi_s = {0};
-    struct axi_ext_r axi_e  = {0};
-
-    // Configure MEM_ATTR array. These are user configurable,
-    // and each region will be set to use one of the entries
-    // as its config.
-    dev->reg->MEM_ATTR[0].word = NPU_MEM_ATTR_0;
-    dev->reg->MEM_ATTR[1].word = NPU_MEM_ATTR_1;
-    dev->reg->MEM_ATTR[2].word = NPU_MEM_ATTR_2;
-    dev->reg->MEM_ATTR[3].word = NPU_MEM_ATTR_3;
-
-    // Set AXI limits on SRAM AXI interfaces
-    axi_s.max_outstanding_read_m1  = AXI_LIMIT_SRAM_MAX_OUTSTANDING_READ_M1 - 1;
-    axi_s.max_outstanding_write_m1 = AXI_LIMIT_SRAM_MAX_OUTSTANDING_WRITE_M1 - 1;
-    axi_s.max_beats                = AXI_LIMIT_SRAM_MAX_BEATS;
-    dev->reg->AXI_SRAM.word        = axi_s.word;
-
-    // Set AXI limits on EXT AXI interface(s)
-    axi_e.max_outstanding_read_m1  = AXI_LIMIT_EXT_MAX_OUTSTANDING_READ_M1 - 1;
-    axi_e.max_outstanding_write_m1 = AXI_LIMIT_EXT_MAX_OUTSTANDING_WRITE_M1 - 1;
-    axi_e.max_beats                = AXI_LIMIT_EXT_MAX_BEATS;
-    dev->reg->AXI_EXT.word         = axi_e.word;
+    for (int i = 0; i < AXI_CFG_COUNT; i++)
+    {
+        *axi_cfg_reg(dev, i) = dev->axi_cfg[i];
+    }
 
     return ETHOSU_SUCCESS;
 }
@@ -138,6 +174,7 @@ void ethosu_dev_run_command_stream(struct ethosu_device *dev,
                                    const uint8_t *cmd_stream_ptr,
                                    uint32_t cms_length,
                                    const uint64_t *base_addr,
+                                   const int *region_cfg,
                                    int num_base_addr)
 {
     assert(num_base_addr <= NPU_REG_BASEP_ARRLEN);
@@ -146,7 +183,8 @@ void ethosu_dev_run_command_stream(struct ethosu_device *dev,
     struct regioncfg_r rcfg = {0};
     uint64_t qbase          = ethosu_address_remap((uintptr_t)cmd_stream_ptr, -1);
     assert(qbase <= ADDRESS_MASK);
-    LOG_DEBUG("QBASE=0x%016llx, QSIZE=%" PRIu32 ", cmd_stream_ptr=%p", qbase, cms_length, cmd_stream_ptr);
+    DEV_LOG_DEBUG(
+        dev, "QBASE=0x%016" PRIx64 ", QSIZE=%" PRIu32 ", cmd_stream_ptr=%p", qbase, cms_length, cmd_stream_ptr);
 
     dev->reg->QBASE.word[0] = qbase & 0xffffffff;
     dev->reg->QBASE.word[1] = qbase >> 32;
@@ -156,11 +194,13 @@ void ethosu_dev_run_command_stream(struct ethosu_device *dev,
     for (int i = 0; i < num_base_addr; i++)
     {
         uint64_t addr = ethosu_address_remap(base_addr[i], i);
+        unsigned int cfg =
+            region_cfg != NULL && region_cfg[i] >= 0 ? (unsigned int)region_cfg[i] : ethosu_config_select(addr, i);
         assert(addr <= ADDRESS_MASK);
-        LOG_DEBUG("BASEP%d=0x%016llx", i, addr);
+        DEV_LOG_DEBUG(dev, "BASEP%d=0x%016" PRIx64, i, addr);
         dev->reg->BASEP[i].word[0] = addr & 0xffffffff;
         dev->reg->BASEP[i].word[1] = addr >> 32;
-        rcfg.word |= ethosu_config_select(addr, i) << (i * 2);
+        rcfg.word |= cfg << (i * 2);
     }
 
     dev->reg->REGIONCFG.word = rcfg.word;
@@ -169,15 +209,90 @@ void ethosu_dev_run_command_stream(struct ethosu_device *dev,
     cmd.transition_to_running_state = 1;
 
     dev->reg->CMD.word = cmd.word;
-    LOG_DEBUG("CMD=0x%08" PRIx32, cmd.word);
+    DEV_LOG_DEBUG(dev, "CMD=0x%08" PRIx32, cmd.word);
+}
+
+void ethosu_dev_set_mem_attr(struct ethosu_device *dev, int index, uint32_t attr)
+{
+    assert(index >= 0 && index < ETHOSU_MEM_ATTR_COUNT);
+
+    if (dev->axi_cfg[index] != attr)
+    {
+        DEV_LOG_DEBUG(dev, "MEM_ATTR%d=0x%08" PRIx32, index, attr);
+        dev->axi_cfg[index]      = attr;
+        *axi_cfg_reg(dev, index) = attr;
+    }
+}
+
+uint32_t ethosu_dev_get_mem_attr(struct ethosu_device *dev, int index)
+{
+    assert(index >= 0 && index < ETHOSU_MEM_ATTR_COUNT);
+    return dev->axi_cfg[index];
+}
+
+int ethosu_dev_axi_limit_count(void)
+{
+    return AXI_LIMIT_COUNT;
+}
+
+bool ethosu_dev_verify_axi_limit(int index, const struct ethosu_axi_limit *limit)
+{
+    struct axi_sram_r l = {0};
+
+    if (index < 0 || index >= AXI_LIMIT_COUNT || limit->max_outstanding_read == 0 ||
+        limit->max_outstanding_write == 0)
+    {
+        return false;
+    }
+
+    // Values that do not fit are truncated by the bit fields, AXI_EXT has the same layout
+    l.max_beats                = limit->max_beats;
+    l.max_outstanding_read_m1  = limit->max_outstanding_read - 1u;
+    l.max_outstanding_write_m1 = limit->max_outstanding_write - 1u;
+
+    return l.max_beats == limit->max_beats && l.max_outstanding_read_m1 == limit->max_outstanding_read - 1u &&
+           l.max_outstanding_write_m1 == limit->max_outstanding_write - 1u;
+}
+
+void ethosu_dev_set_axi_limit(struct ethosu_device *dev, int index, const struct ethosu_axi_limit *limit)
+{
+    const int cfg = AXI_LIMIT_FIRST + index;
+    struct axi_sram_r l;
+
+    assert(ethosu_dev_verify_axi_limit(index, limit));
+
+    l.word                     = dev->axi_cfg[cfg];
+    l.max_beats                = limit->max_beats;
+    l.max_outstanding_read_m1  = limit->max_outstanding_read - 1u;
+    l.max_outstanding_write_m1 = limit->max_outstanding_write - 1u;
+
+    if (dev->axi_cfg[cfg] != l.word)
+    {
+        DEV_LOG_DEBUG(dev, "%s=0x%08" PRIx32, index == 0 ? "AXI_SRAM" : "AXI_EXT", l.word);
+        dev->axi_cfg[cfg]      = l.word;
+        *axi_cfg_reg(dev, cfg) = l.word;
+    }
+}
+
+void ethosu_dev_get_axi_limit(struct ethosu_device *dev, int index, struct ethosu_axi_limit *limit)
+{
+    struct axi_sram_r l;
+
+    assert(index >= 0 && index < AXI_LIMIT_COUNT);
+    l.word = dev->axi_cfg[AXI_LIMIT_FIRST + index];
+
+    limit->max_outstanding_read  = l.max_outstanding_read_m1 + 1;
+    limit->max_outstanding_write = l.max_outstanding_write_m1 + 1;
+    limit->max_beats             = l.max_beats;
 }
 
 void ethosu_dev_print_err_status(struct ethosu_device *dev)
 {
-    LOG_ERR("NPU status=0x%08" PRIx32 ", qread=%" PRIu32 ", cmd_end_reached=%u",
-            dev->reg->STATUS.word,
-            dev->reg->QREAD.word,
-            dev->reg->STATUS.cmd_end_reached);
+    DEV_LOG_ERR(dev,
+                "NPU status=0x%08" PRIx32 ", qread=%" PRIu32 ", cmd_end_reached=%u",
+                dev->reg->STATUS.word,
+                dev->reg->QREAD.word,
+                dev->reg->STATUS.cmd_end_reached);
 }
 
 bool ethosu_dev_handle_interrupt(struct ethosu_device *dev)
@@ -199,6 +314,29 @@ bool ethosu_dev_handle_interrupt(struct ethosu_device *dev)
     return true;
 }
 
+bool ethosu_dev_handle_pmu_interrupt(struct ethosu_device *dev)
+{
+    struct status_r status;
+    struct cmd_r cmd;
+
+    // IRQ_RAISED is set for any interrupt, so only the NPU state tells a PMU
+    // interrupt from a completion interrupt
+    status.word = dev->reg->STATUS.word;
+    if (!status.pmu_irq_raised || status.state != STATE_RUNNING || status.cmd_end_reached)
+    {
+        return false;
+    }
+
+    // Clear interrupt
+    cmd.word           = dev->reg->CMD.word & NPU_CMD_PWR_CLK_MASK;
+    cmd.clear_irq      = 1;
+    dev->reg->CMD.word = cmd.word;
+
+    // The command stream may have completed before the interrupt was cleared
+    status.word = dev->reg->STATUS.word;
+    return status.state == STATE_RUNNING && !status.cmd_end_reached;
+}
+
 bool ethosu_dev_verify_access_state(struct ethosu_device *dev)
 {
     if (dev->reg->PROT.active_CSL != (dev->secure ? SECURITY_LEVEL_SECURE : SECURITY_LEVEL_NON_SECURE) ||
@@ -209,6 +347,30 @@ bool ethosu_dev_verify_access_state(struct ethosu_device *dev)
     return true;
 }
 
+bool ethosu_dev_warm_start(struct ethosu_device *dev)
+{
+    struct status_r status;
+
+    status.word = dev->reg->STATUS.word;
+
+    if (status.state != STATE_STOPPED || status.reset_status || status.irq_raised || status.bus_status ||
+        status.cmd_parse_error || status.branch_fault || status.ecc_fault || !ethosu_dev_verify_access_state(dev))
+    {
+        return false;
+    }
+
+    // Restore AXI settings lost while the NPU was powered down
+    for (int i = 0; i < AXI_CFG_COUNT; i++)
+    {
+        if (*axi_cfg_reg(dev, i) != dev->axi_cfg[i])
+        {
+            *axi_cfg_reg(dev, i) = dev->axi_cfg[i];
+        }
+    }
+
+    return true;
+}
+
 enum ethosu_error_codes ethosu_dev_soft_reset(struct ethosu_device *dev)
 {
     struct reset_r reset;
@@ -218,7 +380,7 @@ enum ethosu_error_codes ethosu_dev_soft_reset(struct ethosu_device *dev)
     reset.pending_CSL = dev->secure ? SECURITY_LEVEL_SECURE : SECURITY_LEVEL_NON_SECURE;
 
     // Reset and set security level
-    LOG_INFO("Soft reset NPU");
+    DEV_LOG_INFO(dev, "Soft reset NPU");
     dev->reg->RESET.word = reset.word;
 
     // Wait until reset status indicates that reset has been completed
@@ -228,26 +390,34 @@ enum ethosu_error_codes ethosu_dev_soft_reset(struct ethosu_device *dev)
 
     if (dev->reg->STATUS.reset_status != 0)
     {
-        LOG_ERR("Soft reset timed out");
+        DEV_LOG_ERR(dev, "Soft reset timed out");
         return ETHOSU_GENERIC_FAILURE;
     }
 
     // Verify that NPU has switched security state and privilege level
     if (ethosu_dev_verify_access_state(dev) != true)
     {
-        LOG_ERR("Failed to switch security state and privilege level");
+        DEV_LOG_ERR(dev, "Failed to switch security state and privilege level");
         return ETHOSU_GENERIC_FAILURE;
     }
 
-    // Reinitialize AXI settings
+    // Reinitialize AXI settings and MAC power ramping
     ethosu_dev_axi_init(dev);
 
-    // MAC power ramping up/down control
-    dev->reg->POWER_CTRL.word = (NPU_MAC_PWR_RAMP_CYCLES & NPU_MAC_PWR_RAMP_CYCLES_MASK);
-
     return ETHOSU_SUCCESS;
 }
 
+void ethosu_dev_stop(struct ethosu_device *dev)
+{
+    struct cmd_r cmd;
+
+    // Stop after the commands already started, without a completion interrupt
+    DEV_LOG_INFO(dev, "Stop NPU");
+    cmd.word           = dev->reg->CMD.word & NPU_CMD_PWR_CLK_MASK;
+    cmd.stop_request   = 1;
+    dev->reg->CMD.word = cmd.word;
+}
+
 void ethosu_dev_get_hw_info(struct ethosu_device *dev, struct ethosu_hw_info *hwinfo)
 {
     struct config_r cfg;
@@ -286,7 +456,7 @@ enum ethosu_error_codes ethosu_dev_set_clock_and_power(struct ethosu_device *dev
     }
 
     dev->reg->CMD.word = cmd.word;
-    LOG_DEBUG("CMD=0x%08" PRIx32, cmd.word);
+    DEV_LOG_DEBUG(dev, "CMD=0x%08" PRIx32, cmd.word);
 
     return ETHOSU_SUCCESS;
 }
@@ -302,89 +472,100 @@ bool ethosu_dev_verify_optimizer_config(struct ethosu_device *dev, uint32_t cfg_
     hw_cfg.word = dev->reg->CONFIG.word;
     hw_id.word  = dev->reg->ID.word;
 
-    LOG_INFO("Optimizer config. product=%u, cmd_stream_version=%u, macs_per_cc=%u, num_axi_ext=%u, num_axi_sram=%u, "
-             "custom_dma=%u",
-             opt_cfg->product,
-             opt_cfg->cmd_stream_version,
-             opt_cfg->macs_per_cc,
-             1U << opt_cfg->num_axi_ext,
-             1U << opt_cfg->num_axi_sram,
-             opt_cfg->custom_dma);
-
-    LOG_INFO("Optimizer config. arch version=%u.%u.%u",
-             opt_id->arch_major_rev,
-             opt_id->arch_minor_rev,
-             opt_id->arch_patch_rev);
-
-    LOG_INFO("Ethos-U config. product=%u, cmd_stream_version=%u, macs_per_cc=%u, num_axi_ext=%u, num_axi_sram=%u, "
-             "custom_dma=%u",
-             hw_cfg.product,
-             hw_cfg.cmd_stream_version,
-             hw_cfg.macs_per_cc,
-             1U << hw_cfg.num_axi_ext,
-             1U << hw_cfg.num_axi_sram,
-             hw_cfg.custom_dma);
-
-    LOG_INFO("Ethos-U. arch version=%u.%u.%u", hw_id.arch_major_rev, hw_id.arch_minor_rev, hw_id.arch_patch_rev);
+    DEV_LOG_INFO(dev,
+                 "Optimizer config. product=%u, cmd_stream_version=%u, macs_per_cc=%u, num_axi_ext=%u, "
+                 "num_axi_sram=%u, custom_dma=%u",
+                 opt_cfg->product,
+                 opt_cfg->cmd_stream_version,
+                 opt_cfg->macs_per_cc,
+                 1U << opt_cfg->num_axi_ext,
+                 1U << opt_cfg->num_axi_sram,
+                 opt_cfg->custom_dma);
+
+    DEV_LOG_INFO(dev,
+                 "Optimizer config. arch version=%u.%u.%u",
+                 opt_id->arch_major_rev,
+                 opt_id->arch_minor_rev,
+                 opt_id->arch_patch_rev);
+
+    DEV_LOG_INFO(dev,
+                 "Ethos-U config. product=%u, cmd_stream_version=%u, macs_per_cc=%u, num_axi_ext=%u, num_axi_sram=%u, "
+                 "custom_dma=%u",
+                 hw_cfg.product,
+                 hw_cfg.cmd_stream_version,
+                 hw_cfg.macs_per_cc,
+                 1U << hw_cfg.num_axi_ext,
+                 1U << hw_cfg.num_axi_sram,
+                 hw_cfg.custom_dma);
+
+    DEV_LOG_INFO(
+        dev, "Ethos-U. arch version=%u.%u.%u", hw_id.arch_major_rev, hw_id.arch_minor_rev, hw_id.arch_patch_rev);
 
     if (opt_cfg->word != hw_cfg.word)
     {
         if (hw_cfg.product != opt_cfg->product)
         {
-            LOG_ERR("NPU config mismatch. npu.product=%u, optimizer.product=%u", hw_cfg.product, opt_cfg->product);
+            DEV_LOG_ERR(
+                dev, "NPU config mismatch. npu.product=%u, optimizer.product=%u", hw_cfg.product, opt_cfg->product);
             ret = false;
         }
 
         if (hw_cfg.macs_per_cc != opt_cfg->macs_per_cc)
         {
-            LOG_ERR("NPU config mismatch. npu.macs_per_cc=%u, optimizer.macs_per_cc=%u",
-                    hw_cfg.macs_per_cc,
-                    opt_cfg->macs_per_cc);
+            DEV_LOG_ERR(dev,
+                        "NPU config mismatch. npu.macs_per_cc=%u, optimizer.macs_per_cc=%u",
+                        hw_cfg.macs_per_cc,
+                        opt_cfg->macs_per_cc);
             ret = false;
         }
 
         if (hw_cfg.num_axi_ext != opt_cfg->num_axi_ext)
         {
-            LOG_ERR("NPU config mismatch. npu.num_axi_ext=%u, optimizer.num_axi_ext=%u",
-                    1U << hw_cfg.num_axi_ext,
-                    1U << opt_cfg->num_axi_ext);
+            DEV_LOG_ERR(dev,
+                        "NPU config mismatch. npu.num_axi_ext=%u, optimizer.num_axi_ext=%u",
+                        1U << hw_cfg.num_axi_ext,
+                        1U << opt_cfg->num_axi_ext);
             ret = false;
         }
 
         if (hw_cfg.num_axi_sram != opt_cfg->num_axi_sram)
         {
-            LOG_ERR("NPU config mismatch. npu.num_axi_sram=%u, optimizer.num_axi_sram=%u",
-                    1U << hw_cfg.num_axi_sram,
-                    1U << opt_cfg->num_axi_sram);
+            DEV_LOG_ERR(dev,
+                        "NPU config mismatch. npu.num_axi_sram=%u, optimizer.num_axi_sram=%u",
+                        1U << hw_cfg.num_axi_sram,
+                        1U << opt_cfg->num_axi_sram);
             ret = false;
         }
 
         if (hw_cfg.cmd_stream_version != opt_cfg->cmd_stream_version)
         {
-            LOG_ERR("NPU config mismatch. npu.cmd_stream_version=%u, optimizer.cmd_stream_version=%u",
-                    hw_cfg.cmd_stream_version,
-                    opt_cfg->cmd_stream_version);
+            DEV_LOG_ERR(dev,
+                        "NPU config mismatch. npu.cmd_stream_version=%u, optimizer.cmd_stream_version=%u",
+                        hw_cfg.cmd_stream_version,
+                        opt_cfg->cmd_stream_version);
             ret = false;
         }
 
         if (!hw_cfg.custom_dma && opt_cfg->custom_dma)
         {
-            LOG_ERR("NPU config mismatch. npu.custom_dma=%u, optimizer.custom_dma=%u",
-                    hw_cfg.custom_dma,
-                    opt_cfg->custom_dma);
+            DEV_LOG_ERR(dev,
+                        "NPU config mismatch. npu.custom_dma=%u, optimizer.custom_dma=%u",
+                        hw_cfg.custom_dma,
+                        opt_cfg->custom_dma);
             ret = false;
         }
     }
 
     if ((hw_id.arch_major_rev != opt_id->arch_major_rev) || (hw_id.arch_minor_rev < opt_id->arch_minor_rev))
     {
-        LOG_ERR("NPU arch mismatch. npu.arch=%u.%u.%u, optimizer.arch=%u.%u.%u",
-                hw_id.arch_major_rev,
-                hw_id.arch_minor_rev,
-                hw_id.arch_patch_rev,
-                opt_id->arch_major_rev,
-                opt_id->arch_minor_rev,
-                opt_id->arch_patch_rev);
+        DEV_LOG_ERR(dev,
+                    "NPU arch mismatch. npu.arch=%u.%u.%u, optimizer.arch=%u.%u.%u",
+                    hw_id.arch_major_rev,
+                    hw_id.arch_minor_rev,
+                    hw_id.arch_patch_rev,
+                    opt_id->arch_major_rev,
+                    opt_id->arch_minor_rev,
+                    opt_id->arch_patch_rev);
         ret = false;
     }
 
@@ -20,8 +20,11 @@
  ******************************************************************************/
 
 #include "ethosu_driver.h"
+#include "ethosu_cmd_analyzer.h"
 #include "ethosu_device.h"
 #include "ethosu_log.h"
+#include "ethosu_pmu_capture.h"
+#include "ethosu_tracepoint.h"
 
 #if defined(ETHOSU55)
 #include "ethosu_config_u55.h"
@@ -53,6 +56,20 @@
 #define DRIVER_ACTION_LENGTH_32_BIT_WORD 1
 #define ETHOSU_FOURCC ('1' << 24 | 'P' << 16 | 'O' << 8 | 'C') // "Custom Operator Payload 1"
 
+// Alignment of ranges derived from the command stream footprint
+#ifndef ETHOSU_CACHE_LINE_SIZE
+#define ETHOSU_CACHE_LINE_SIZE 32
+#endif
+
+#ifndef ETHOSU_IRQ_START_JOBS
+#define ETHOSU_IRQ_START_JOBS 0
+#endif
+
+// Semaphores of threads that have waited for a driver kept for reuse
+#ifndef ETHOSU_RESERVE_SEMAPHORES
+#define ETHOSU_RESERVE_SEMAPHORES 4
+#endif
+
 #define SCRATCH_BASE_ADDR_INDEX 1
 #define FAST_MEMORY_BASE_ADDR_INDEX 2
 
@@ -113,6 +130,15 @@ struct opt_cfg_s
     uint32_t id;
 };
 
+// Thread waiting in ethosu_reserve_driver_priority() for a driver to be released
+struct ethosu_reserve_waiter
+{
+    int priority;                       // Highest priority is served first
+    void *semaphore;                    // Given when a driver has been handed over
+    struct ethosu_driver *drv;          // Driver handed over to the waiter
+    struct ethosu_reserve_waiter *next; // Next waiter, in order of priority
+};
+
 /******************************************************************************
  * Variables
  ******************************************************************************/
@@ -120,6 +146,22 @@ struct opt_cfg_s
 // Registered drivers linked list HEAD
 static struct ethosu_driver *registered_drivers = NULL;
 
+// Threads waiting for a driver, highest priority first
+static struct ethosu_reserve_waiter *reserve_waiters = NULL;
+
+// Semaphores of earlier waiters, reused by the next threads that have to wait
+static void *reserve_semaphores[ETHOSU_RESERVE_SEMAPHORES];
+static int num_reserve_semaphores = 0;
+
+// Given when a job on any scheduled driver has completed
+static void *sched_semaphore = NULL;
+
+// Number of times ethosu_sched_poll() has taken the scheduler semaphore
+static uint32_t sched_taken = 0;
+
+// Runtime log severity, copied to the devices following the global severity
+int ethosu_log_threshold = ETHOSU_LOG_SEVERITY;
+
 /******************************************************************************
  * Weak functions - Cache
  *
@@ -189,7 +231,6 @@ struct ethosu_semaphore_t
 };
 
 static void *ethosu_mutex;
-static void *ethosu_semaphore;
 
 void *__attribute__((weak)) ethosu_mutex_create(void)
 {
@@ -276,19 +317,91 @@ void __attribute__((weak)) ethosu_inference_end(struct ethosu_driver *drv, void
     UNUSED(drv);
 }
 
+/******************************************************************************
+ * Weak functions - Deferred job completion
+ ******************************************************************************/
+
+void __attribute__((weak)) ethosu_defer_completion(struct ethosu_driver *drv)
+{
+    // Without a deferred context, complete the jobs directly from the
+    // interrupt handler
+    (void)ethosu_complete_jobs(drv);
+}
+
+int __attribute__((weak)) ethosu_job_timer_start(struct ethosu_driver *drv, uint32_t timeout_us)
+{
+    UNUSED(drv);
+    UNUSED(timeout_us);
+
+    // No timer available, the job has no timeout
+    return -1;
+}
+
+void __attribute__((weak)) ethosu_job_timer_stop(struct ethosu_driver *drv)
+{
+    UNUSED(drv);
+}
+
+/******************************************************************************
+ * Weak functions - Power idle timer
+ ******************************************************************************/
+
+int __attribute__((weak)) ethosu_power_timer_start(struct ethosu_driver *drv, uint32_t timeout_us)
+{
+    UNUSED(drv);
+    UNUSED(timeout_us);
+
+    // No timer available, power gate the NPU right away
+    return -1;
+}
+
+void __attribute__((weak)) ethosu_power_timer_stop(struct ethosu_driver *drv)
+{
+    UNUSED(drv);
+}
+
+/******************************************************************************
+ * Weak functions - Fast memory copy
+ ******************************************************************************/
+
+void __attribute__((weak)) ethosu_fast_memory_copy(struct ethosu_driver *drv, void *dst, const void *src, size_t size)
+{
+    UNUSED(drv);
+    memcpy(dst, src, size);
+}
+
 /******************************************************************************
  * Static functions
  ******************************************************************************/
+
+/*
+ * Hand over an unreserved driver to the highest priority waiter, if any. Must
+ * be called with the driver mutex locked.
+ */
+static void ethosu_reserve_handover(struct ethosu_driver *drv)
+{
+    struct ethosu_reserve_waiter *waiter = reserve_waiters;
+
+    if (waiter == NULL)
+    {
+        return;
+    }
+
+    reserve_waiters = waiter->next;
+    drv->reserved   = true;
+    waiter->drv     = drv;
+    ethosu_semaphore_give(waiter->semaphore);
+}
+
 static void ethosu_register_driver(struct ethosu_driver *drv)
 {
     ethosu_mutex_lock(ethosu_mutex);
     drv->next          = registered_drivers;
     registered_drivers = drv;
+    ethosu_reserve_handover(drv);
     ethosu_mutex_unlock(ethosu_mutex);
 
-    ethosu_semaphore_give(ethosu_semaphore);
-
-    LOG_INFO("New NPU driver registered (handle: 0x%p, NPU: 0x%p)", drv, drv->dev.reg);
+    DRV_LOG_INFO(drv, "New NPU driver registered (handle: 0x%p, NPU: 0x%p)", drv, drv->dev.reg);
 }
 
 static int ethosu_deregister_driver(struct ethosu_driver *drv)
@@ -306,7 +419,6 @@ static int ethosu_deregister_driver(struct ethosu_driver *drv)
         {
             *prev = curr->next;
             LOG_INFO("NPU driver handle %p deregistered.", drv);
-            ethosu_semaphore_take(ethosu_semaphore, ETHOSU_SEMAPHORE_WAIT_FOREVER);
             break;
         }
 
@@ -314,6 +426,15 @@ static int ethosu_deregister_driver(struct ethosu_driver *drv)
         curr = curr->next;
     }
 
+    // No thread can wait for a driver once the last one is gone
+    if (registered_drivers == NULL)
+    {
+        while (num_reserve_semaphores > 0)
+        {
+            ethosu_semaphore_destroy(reserve_semaphores[--num_reserve_semaphores]);
+        }
+    }
+
     ethosu_mutex_unlock(ethosu_mutex);
 
     if (curr == NULL)
@@ -325,475 +446,2861 @@ static int ethosu_deregister_driver(struct ethosu_driver *drv)
     return 0;
 }
 
-static void ethosu_reset_job(struct ethosu_driver *drv)
+/*
+ * The job queue is a ring where job_tail is only advanced by the submitting
+ * thread and job_head only by the thread completing jobs. The indices run
+ * modulo twice the queue size to tell a full queue from an empty one.
+ */
+static inline uint32_t ethosu_job_index_next(uint32_t index)
 {
-    memset(&drv->job, 0, sizeof(struct ethosu_job));
+    return (index + 1) % (2 * ETHOSU_JOB_QUEUE_SIZE);
 }
 
-static int handle_optimizer_config(struct ethosu_driver *drv, struct opt_cfg_s const *opt_cfg_p)
+static inline uint32_t ethosu_job_count(const struct ethosu_driver *drv)
 {
-    LOG_INFO("Optimizer release nbr: %u patch: %u", opt_cfg_p->da_data.rel_nbr, opt_cfg_p->da_data.patch_nbr);
-
-    if (ethosu_dev_verify_optimizer_config(&drv->dev, opt_cfg_p->cfg, opt_cfg_p->id) != true)
-    {
-        return -1;
-    }
-
-    return 0;
+    return (drv->job_tail + 2 * ETHOSU_JOB_QUEUE_SIZE - drv->job_head) % (2 * ETHOSU_JOB_QUEUE_SIZE);
 }
 
-static int handle_command_stream(struct ethosu_driver *drv, const uint8_t *cmd_stream, const int cms_length)
+static inline struct ethosu_job *ethosu_job_at(struct ethosu_driver *drv, uint32_t index)
 {
-    uint32_t cms_bytes = cms_length * BYTES_IN_32_BITS;
+    return &drv->job[index % ETHOSU_JOB_QUEUE_SIZE];
+}
 
-    LOG_INFO("handle_command_stream: cmd_stream=%p, cms_length %d", cmd_stream, cms_length);
+static void ethosu_reset_job(struct ethosu_job *job)
+{
+    // Mark the slot idle before the other fields are cleared, for
+    // ethosu_abort_jobs() looking at a job ethosu_complete_jobs() is finishing
+    job->state = ETHOSU_JOB_IDLE;
+    __DMB();
+    memset(job, 0, sizeof(struct ethosu_job));
+}
 
-    if (0 != ((ptrdiff_t)cmd_stream & MASK_16_BYTE_ALIGN))
-    {
-        LOG_ERR("Command stream addr %p not aligned to 16 bytes", cmd_stream);
-        return -1;
-    }
+static void ethosu_reset_jobs(struct ethosu_driver *drv)
+{
+    memset(drv->job, 0, sizeof(drv->job));
+    drv->job_head = 0;
+    drv->job_tail = 0;
+}
 
-    // Verify minimum 16 byte alignment for base address'
-    for (int i = 0; i < drv->job.num_base_addr; i++)
+static struct ethosu_job *ethosu_find_job(struct ethosu_driver *drv, enum ethosu_job_state state)
+{
+    for (uint32_t i = drv->job_head; i != drv->job_tail; i = ethosu_job_index_next(i))
     {
-        if (0 != (drv->job.base_addr[i] & MASK_16_BYTE_ALIGN))
+        struct ethosu_job *job = ethosu_job_at(drv, i);
+        if (job->state == state)
         {
-            LOG_ERR("Base addr %d: 0x%" PRIx64 "not aligned to 16 bytes", i, drv->job.base_addr[i]);
-            return -1;
+            return job;
         }
     }
 
-    // Flush/clean the data cache
-    ethosu_flush_dcache(drv->job.base_addr, drv->job.base_addr_size, drv->job.num_base_addr);
+    return NULL;
+}
 
-    // Request power gating disabled during inference run
-    if (ethosu_request_power(drv))
+/*
+ * Check if any base address of a job is placed in a fast memory region.
+ */
+static bool ethosu_job_uses_region(const struct ethosu_job *job, int region)
+{
+    for (int i = 0; i < job->num_base_addr; i++)
     {
-        LOG_ERR("Failed to request power");
-        return -1;
+        if (job->fast_region[i] == region)
+        {
+            return true;
+        }
     }
 
-    drv->job.state = ETHOSU_JOB_RUNNING;
-
-    // Inference begin callback
-    ethosu_inference_begin(drv, drv->job.user_arg);
-
-    // Execute the command stream
-    ethosu_dev_run_command_stream(&drv->dev, cmd_stream, cms_bytes, drv->job.base_addr, drv->job.num_base_addr);
-
-    return 0;
+    return false;
 }
 
-/******************************************************************************
- * Weak functions - Interrupt handler
- ******************************************************************************/
-void __attribute__((weak)) ethosu_irq_handler(struct ethosu_driver *drv)
+/*
+ * Get the NPU access of a base address placed in fast memory. Base address 2
+ * is scratch data, which is neither copied in nor out.
+ */
+static uint32_t ethosu_fast_memory_access(const struct ethosu_job *job, int index)
 {
-    // Prevent race condition where interrupt triggered after a timeout waiting
-    // for semaphore, but before NPU is reset.
-    if (drv->job.result == ETHOSU_JOB_RESULT_TIMEOUT)
+    if (job->network == NULL || job->network->fast_memory_place == 0 || index == FAST_MEMORY_BASE_ADDR_INDEX)
     {
-        (void)ethosu_dev_handle_interrupt(&drv->dev);
-        return;
+        return ETHOSU_REGION_ACCESS_NONE;
     }
 
-    drv->job.state  = ETHOSU_JOB_DONE;
-    drv->job.result = ethosu_dev_handle_interrupt(&drv->dev) ? ETHOSU_JOB_RESULT_OK : ETHOSU_JOB_RESULT_ERROR;
-    ethosu_semaphore_give(drv->semaphore);
+    return job->network->region[index].access;
 }
 
-/******************************************************************************
- * Functions API
- ******************************************************************************/
-
-int ethosu_init(struct ethosu_driver *drv,
-                void *const base_address,
-                const void *fast_memory,
-                const size_t fast_memory_size,
-                uint32_t secure_enable,
-                uint32_t privilege_enable)
+/*
+ * Copy the data read by the NPU to the base addresses of a job placed in fast
+ * memory. Read-only data is not copied again if it was loaded by the previous
+ * job using the region, for the same network.
+ */
+static void ethosu_fast_memory_load(struct ethosu_driver *drv, const struct ethosu_job *job)
 {
-    LOG_INFO("Initializing NPU: base_address=%p, fast_memory=%p, fast_memory_size=%zu, secure=%" PRIu32
-             ", privileged=%" PRIu32,
-             base_address,
-             fast_memory,
-             fast_memory_size,
-             secure_enable,
-             privilege_enable);
-
-    if (!ethosu_mutex)
+    // Forget data that may have been overwritten since it was loaded
+    for (int r = 0; r < ETHOSU_FAST_MEMORY_REGIONS; r++)
     {
-        ethosu_mutex = ethosu_mutex_create();
-        if (!ethosu_mutex)
+        struct ethosu_fast_memory_region *region = &drv->fast_region[r];
+
+        if (!ethosu_job_uses_region(job, r))
         {
-            LOG_ERR("Failed to create global driver mutex");
-            return -1;
+            continue;
+        }
+
+        for (int i = 0; i < ETHOSU_MAX_BASE_ADDR; i++)
+        {
+            if (region->loaded != job->network || i >= job->num_base_addr || job->fast_region[i] != r)
+            {
+                region->load[i].size = 0;
+            }
         }
+
+        region->loaded = job->network;
     }
 
-    if (!ethosu_semaphore)
+    for (int i = 0; i < job->num_base_addr; i++)
     {
-        ethosu_semaphore = ethosu_semaphore_create();
-        if (!ethosu_semaphore)
+        const uint32_t access = ethosu_fast_memory_access(job, i);
+        struct ethosu_fast_memory_load *load;
+        uint64_t address;
+        size_t size;
+
+        if (job->fast_region[i] < 0)
         {
-            LOG_ERR("Failed to create global driver semaphore");
-            return -1;
+            continue;
         }
-    }
 
-    drv->fast_memory           = (uintptr_t)fast_memory;
-    drv->fast_memory_size      = fast_memory_size;
-    drv->power_request_counter = 0;
+        load = &drv->fast_region[job->fast_region[i]].load[i];
 
-    // Initialize the device and set requested security state and privilege mode
-    if (!ethosu_dev_init(&drv->dev, base_address, secure_enable, privilege_enable))
-    {
-        LOG_ERR("Failed to initialize Ethos-U device");
-        return -1;
-    }
+        if (access == ETHOSU_REGION_ACCESS_NONE || access == ETHOSU_REGION_ACCESS_WRITE)
+        {
+            load->size = 0;
+            continue;
+        }
 
-    drv->semaphore = ethosu_semaphore_create();
-    if (!drv->semaphore)
-    {
-        LOG_ERR("Failed to create driver semaphore");
-        return -1;
-    }
+        if (access == ETHOSU_REGION_ACCESS_READ && load->size == job->base_addr_size[i] &&
+            load->source == job->base_addr[i] && load->address == job->fast_addr[i])
+        {
+            continue;
+        }
 
-    ethosu_reset_job(drv);
-    ethosu_register_driver(drv);
+        address = job->fast_addr[i];
+        size    = (job->base_addr_size[i] + ETHOSU_CACHE_LINE_SIZE - 1) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
 
-    return 0;
-}
+        // Clean the copied data before it is read by the NPU
+        ethosu_fast_memory_copy(drv,
+                                (void *)(uintptr_t)job->fast_addr[i],
+                                (const void *)(uintptr_t)job->base_addr[i],
+                                job->base_addr_size[i]);
+        ethosu_flush_dcache(&address, &size, 1);
 
-void ethosu_deinit(struct ethosu_driver *drv)
-{
-    ethosu_deregister_driver(drv);
-    ethosu_semaphore_destroy(drv->semaphore);
+        load->source  = job->base_addr[i];
+        load->address = job->fast_addr[i];
+        load->size    = access == ETHOSU_REGION_ACCESS_READ ? job->base_addr_size[i] : 0;
+    }
 }
 
-int ethosu_soft_reset(struct ethosu_driver *drv)
+/*
+ * Copy the data written by the NPU from the base addresses of a job placed in
+ * fast memory back to the base addresses passed to the invoke.
+ */
+static void ethosu_fast_memory_store(struct ethosu_driver *drv, const struct ethosu_job *job)
 {
-    // Soft reset the NPU
-    if (ethosu_dev_soft_reset(&drv->dev) != ETHOSU_SUCCESS)
+    for (int i = 0; i < job->num_base_addr; i++)
     {
-        LOG_ERR("Failed to soft-reset NPU");
-        return -1;
-    }
+        const uint32_t access = ethosu_fast_memory_access(job, i);
+        uint64_t address;
+        size_t size;
 
-    // Update power and clock gating after the soft reset
-    ethosu_dev_set_clock_and_power(&drv->dev,
-                                   drv->power_request_counter > 0 ? ETHOSU_CLOCK_Q_DISABLE : ETHOSU_CLOCK_Q_ENABLE,
-                                   drv->power_request_counter > 0 ? ETHOSU_POWER_Q_DISABLE : ETHOSU_POWER_Q_ENABLE);
+        if (job->fast_region[i] < 0 || access == ETHOSU_REGION_ACCESS_NONE || access == ETHOSU_REGION_ACCESS_READ)
+        {
+            continue;
+        }
 
-    return 0;
+        address = job->fast_addr[i];
+        size    = (job->base_addr_size[i] + ETHOSU_CACHE_LINE_SIZE - 1) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+
+        ethosu_invalidate_dcache(&address, &size, 1);
+        ethosu_fast_memory_copy(drv,
+                                (void *)(uintptr_t)job->base_addr[i],
+                                (const void *)(uintptr_t)job->fast_addr[i],
+                                job->base_addr_size[i]);
+    }
 }
 
-int ethosu_request_power(struct ethosu_driver *drv)
+/*
+ * Program the NPU to run the command stream of a job, with the base addresses
+ * placed in fast memory replaced and the region profile of the network applied.
+ */
+static void ethosu_run_job(struct ethosu_driver *drv, const struct ethosu_job *job)
 {
-    // Check if this is the first power request, increase counter
-    if (drv->power_request_counter++ == 0)
+    const struct ethosu_region_profile *profile = job->network != NULL ? job->network->profile : NULL;
+    uint64_t base_addr[ETHOSU_MAX_BASE_ADDR];
+    int region_cfg[ETHOSU_MAX_BASE_ADDR];
+
+    for (int i = 0; i < job->num_base_addr; i++)
     {
-        // Always reset to a known state. Changes to requested
-        // security state/privilege mode if necessary.
-        if (ethosu_soft_reset(drv))
+        const int region = job->fast_region[i];
+
+        base_addr[i]  = region < 0 ? job->base_addr[i] : job->fast_addr[i];
+        region_cfg[i] = region < 0 ? -1 : drv->fast_region[region].region_cfg;
+
+        if (region < 0 && profile != NULL && (profile->region_mask & (1u << i)) != 0)
         {
-            LOG_ERR("Failed to request power for Ethos-U");
-            drv->power_request_counter--;
-            return -1;
+            region_cfg[i] = profile->region_cfg[i];
         }
     }
-    return 0;
+
+    if (job->weight_stage >= 0)
+    {
+        base_addr[0]  = drv->weight_stage_base + (uint64_t)job->weight_stage * drv->weight_stage_size;
+        region_cfg[0] = drv->weight_stage_cfg;
+    }
+
+    // Registers already holding the attributes are not written again
+    for (int i = 0; i < ETHOSU_MEM_ATTR_COUNT; i++)
+    {
+        const bool set = profile != NULL && (profile->mem_attr_mask & (1u << i)) != 0;
+
+        ethosu_dev_set_mem_attr(&drv->dev, i, set ? profile->mem_attr[i] : drv->mem_attr[i]);
+    }
+
+    for (int i = 0; i < ethosu_dev_axi_limit_count(); i++)
+    {
+        const bool set = profile != NULL && (profile->axi_limit_mask & (1u << i)) != 0;
+
+        ethosu_dev_set_axi_limit(&drv->dev, i, set ? &profile->axi_limit[i] : &drv->axi_limit[i]);
+    }
+
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_PROGRAM_BEGIN, (uintptr_t)job->cmd_stream, job->cms_length);
+    ethosu_dev_run_command_stream(
+        &drv->dev, job->cmd_stream, job->cms_length, base_addr, region_cfg, job->num_base_addr);
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_PROGRAM_END, job->num_base_addr, 0);
+
+    // No thread waits for a deferred job with a timeout
+    if (job->deferred && drv->job_timeout != 0)
+    {
+        (void)ethosu_job_timer_start(drv, drv->job_timeout);
+    }
 }
 
-void ethosu_release_power(struct ethosu_driver *drv)
+/*
+ * Save the fast memory contents of the network resident in an area to its
+ * backing buffer, and mark the area as not holding any network.
+ */
+static void ethosu_fast_memory_evict(struct ethosu_driver *drv,
+                                     struct ethosu_network **resident,
+                                     uint64_t address,
+                                     size_t size)
 {
-    if (drv->power_request_counter == 0)
+    struct ethosu_network *net = *resident;
+    size_t line_size;
+
+    if (net == NULL)
     {
-        LOG_WARN("No power request left to release, reference counter is 0");
+        return;
     }
-    else
+
+    *resident              = NULL;
+    net->fast_memory_owner = NULL;
+
+    if (net->fast_memory_backing == NULL)
     {
-        // Decrement ref counter and enable power gating if no requests remain
-        if (--drv->power_request_counter == 0)
-        {
-            ethosu_dev_set_clock_and_power(&drv->dev, ETHOSU_CLOCK_Q_ENABLE, ETHOSU_POWER_Q_ENABLE);
-        }
+        return;
     }
+
+    size      = size < net->fast_memory_backing_size ? size : net->fast_memory_backing_size;
+    line_size = (size + ETHOSU_CACHE_LINE_SIZE - 1) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+
+    // Drop stale lines before the NPU output is read
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_FAST_MEMORY_SAVE, (uintptr_t)net->custom_data_ptr, size);
+    ethosu_invalidate_dcache(&address, &line_size, 1);
+    ethosu_fast_memory_copy(drv, net->fast_memory_backing, (const void *)(uintptr_t)address, size);
 }
 
-void ethosu_get_driver_version(struct ethosu_driver_version *ver)
+/*
+ * Restore the fast memory contents of a network from its backing buffer, and
+ * mark the network as resident in the area.
+ */
+static void ethosu_fast_memory_restore(struct ethosu_driver *drv,
+                                       struct ethosu_network **resident,
+                                       struct ethosu_network *net,
+                                       uint64_t address,
+                                       size_t size)
 {
-    assert(ver != NULL);
-    ver->major = ETHOSU_DRIVER_VERSION_MAJOR;
-    ver->minor = ETHOSU_DRIVER_VERSION_MINOR;
-    ver->patch = ETHOSU_DRIVER_VERSION_PATCH;
+    size_t line_size;
+
+    size      = size < net->fast_memory_backing_size ? size : net->fast_memory_backing_size;
+    line_size = (size + ETHOSU_CACHE_LINE_SIZE - 1) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+
+    // Clean the copied data before it is read by the NPU
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_FAST_MEMORY_RESTORE, (uintptr_t)net->custom_data_ptr, size);
+    ethosu_fast_memory_copy(drv, (void *)(uintptr_t)address, net->fast_memory_backing, size);
+    ethosu_flush_dcache(&address, &line_size, 1);
+
+    *resident              = net;
+    net->fast_memory_owner = drv;
 }
 
-void ethosu_get_hw_info(struct ethosu_driver *drv, struct ethosu_hw_info *hw)
+/*
+ * Save the fast memory contents of all resident networks.
+ */
+static void ethosu_fast_memory_evict_all(struct ethosu_driver *drv)
 {
-    assert(hw != NULL);
-    ethosu_dev_get_hw_info(&drv->dev, hw);
+    for (int i = 0; i < ETHOSU_FAST_MEMORY_SLOTS; i++)
+    {
+        struct ethosu_fast_memory_slot *slot = &drv->fast_memory_slot[i];
+
+        ethosu_fast_memory_evict(drv, &slot->resident, drv->fast_memory + slot->offset, slot->size);
+    }
+
+    ethosu_fast_memory_evict(drv, &drv->fast_memory_resident, drv->fast_memory, drv->fast_memory_size);
 }
 
-int ethosu_wait(struct ethosu_driver *drv, bool block)
+/*
+ * Make the network of a job resident in its fast memory area. The networks
+ * resident in overlapping areas are saved first. Nothing is copied if the
+ * network is already resident.
+ */
+static void ethosu_fast_memory_switch(struct ethosu_driver *drv, const struct ethosu_job *job)
 {
-    int ret = 0;
+    struct ethosu_network *net = job->network;
+    struct ethosu_fast_memory_slot *slot;
 
-    switch (drv->job.state)
+    if (!ethosu_job_uses_region(job, 0))
     {
-    case ETHOSU_JOB_IDLE:
-        LOG_ERR("Inference job not running...");
-        ret = -2;
-        break;
-    case ETHOSU_JOB_RUNNING:
-        if (!block)
+        return;
+    }
+
+    // Only networks with a backing buffer are tracked
+    if (net != NULL && net->fast_memory_backing == NULL)
+    {
+        net = NULL;
+    }
+
+    if (job->network == NULL || job->network->fast_memory_slot == ETHOSU_FAST_MEMORY_SLOT_NONE)
+    {
+        if (net != NULL && drv->fast_memory_resident == net)
         {
-            // Inference still running, do not block
-            ret = 1;
-            break;
+            return;
         }
-        // fall through
-    case ETHOSU_JOB_DONE:
-        // Wait for interrupt in blocking mode. In non-blocking mode
-        // the interrupt has already triggered
-        ret = ethosu_semaphore_take(drv->semaphore, ETHOSU_SEMAPHORE_WAIT_INFERENCE);
-        if (ret < 0)
+
+        ethosu_fast_memory_evict_all(drv);
+
+        if (net != NULL)
         {
-            drv->job.result = ETHOSU_JOB_RESULT_TIMEOUT;
+            ethosu_fast_memory_restore(drv, &drv->fast_memory_resident, net, drv->fast_memory, drv->fast_memory_size);
+        }
 
-            // There's a race where the NPU interrupt can have fired between semaphore
-            // timing out and setting the result above (checked in interrupt handler).
-            // By checking if the job state has been changed (only set to DONE by interrupt
-            // handler), we know if the interrupt handler has run, if so decrement the
-            // semaphore count by one (given in interrupt handler).
-            if (drv->job.state == ETHOSU_JOB_DONE)
-            {
-                drv->job.result = ETHOSU_JOB_RESULT_TIMEOUT; // Reset back to timeout
-                ethosu_semaphore_take(drv->semaphore, ETHOSU_SEMAPHORE_WAIT_INFERENCE);
-            }
+        return;
+    }
+
+    slot = &drv->fast_memory_slot[job->network->fast_memory_slot];
+
+    ethosu_fast_memory_evict(drv, &drv->fast_memory_resident, drv->fast_memory, drv->fast_memory_size);
+
+    if (slot->resident != net)
+    {
+        ethosu_fast_memory_evict(drv, &slot->resident, drv->fast_memory + slot->offset, slot->size);
+
+        if (net != NULL)
+        {
+            ethosu_fast_memory_restore(drv, &slot->resident, net, drv->fast_memory + slot->offset, slot->size);
+        }
+    }
+}
+
+#if ETHOSU_IRQ_START_JOBS
+/*
+ * Check if a job copies data between its base addresses and fast memory, when
+ * it is started or finished up.
+ */
+static bool ethosu_fast_memory_copies(const struct ethosu_job *job)
+{
+    for (int i = 0; i < job->num_base_addr; i++)
+    {
+        if (job->fast_region[i] >= 0 && ethosu_fast_memory_access(job, i) != ETHOSU_REGION_ACCESS_NONE)
+        {
+            return true;
         }
+    }
+
+    return false;
+}
+
+/*
+ * Check if the network of a job is resident in its fast memory area, so that
+ * starting the job saves and restores nothing.
+ */
+static bool ethosu_fast_memory_resident(const struct ethosu_driver *drv, const struct ethosu_job *job)
+{
+    const struct ethosu_network *net = job->network;
+
+    if (!ethosu_job_uses_region(job, 0))
+    {
+        return true;
+    }
+
+    // Only networks with a backing buffer are tracked
+    if (net != NULL && net->fast_memory_backing == NULL)
+    {
+        net = NULL;
+    }
 
-        // Invalidate cache
-        ethosu_invalidate_dcache(drv->job.base_addr, drv->job.base_addr_size, drv->job.num_base_addr);
+    if (job->network != NULL && job->network->fast_memory_slot != ETHOSU_FAST_MEMORY_SLOT_NONE)
+    {
+        const struct ethosu_fast_memory_slot *slot = &drv->fast_memory_slot[job->network->fast_memory_slot];
 
-        // Inference done callback - always called even in case of timeout
-        ethosu_inference_end(drv, drv->job.user_arg);
+        return drv->fast_memory_resident == NULL && slot->resident == net;
+    }
 
-        // Release power gating disabled requirement
-        ethosu_release_power(drv);
+    if (net != NULL)
+    {
+        return drv->fast_memory_resident == net;
+    }
 
-        // Check NPU and interrupt status
-        if (drv->job.result)
+    // Networks resident anywhere in the fast memory are saved
+    for (int i = 0; i < ETHOSU_FAST_MEMORY_SLOTS; i++)
+    {
+        if (drv->fast_memory_slot[i].resident != NULL)
         {
-            if (drv->job.result == ETHOSU_JOB_RESULT_ERROR)
-            {
-                LOG_ERR("NPU error(s) occured during inference.");
-                ethosu_dev_print_err_status(&drv->dev);
-            }
-            else
-            {
-                LOG_ERR("NPU inference timed out.");
-            }
+            return false;
+        }
+    }
+
+    return drv->fast_memory_resident == NULL;
+}
+#endif
+
+static void ethosu_start_job(struct ethosu_driver *drv, struct ethosu_job *job)
+{
+    job->state = ETHOSU_JOB_RUNNING;
+
+    // Swap in the fast memory contents of the network
+    ethosu_fast_memory_switch(drv, job);
+    ethosu_fast_memory_load(drv, job);
+
+    // Inference begin callback
+    job->begun = true;
+    ethosu_inference_begin(drv, job->user_arg);
+
+    ethosu_pmu_capture_start(drv, job);
+    ethosu_pmu_timeline_start(drv, job);
+
+    // Execute the command stream
+    ethosu_run_job(drv, job);
+}
+
+/*
+ * Start the oldest pending job, unless the NPU is already running a job. Called
+ * on submit and when the previous job has been finished. With
+ * ETHOSU_IRQ_START_JOBS it is also called from the interrupt handler, which is
+ * safe because an interrupt can only complete a job that is already running.
+ */
+static void ethosu_start_next_job(struct ethosu_driver *drv)
+{
+    struct ethosu_job *job;
+
+    if (ethosu_find_job(drv, ETHOSU_JOB_RUNNING) != NULL)
+    {
+        return;
+    }
+
+    job = ethosu_find_job(drv, ETHOSU_JOB_PENDING);
+    if (job != NULL)
+    {
+        ethosu_start_job(drv, job);
+    }
+}
+
+/*
+ * Resume queued jobs after the NPU has been reset. A job that the interrupt
+ * handler had already started is restarted from the beginning of its command
+ * stream.
+ */
+static void ethosu_resume_jobs(struct ethosu_driver *drv)
+{
+    struct ethosu_job *job = ethosu_find_job(drv, ETHOSU_JOB_RUNNING);
+
+    if (job != NULL)
+    {
+        ethosu_pmu_capture_start(drv, job);
+        ethosu_pmu_timeline_start(drv, job);
+        ethosu_run_job(drv, job);
+        return;
+    }
+
+    ethosu_start_next_job(drv);
+}
+
+/*
+ * Collect the ranges of the regions with any of the access flags in 'include'
+ * and none of the flags in 'exclude'. Regions without access information are
+ * treated as read-write. Regions copied to and from fast memory are only
+ * accessed by the CPU, and are skipped.
+ */
+static int ethosu_job_ranges(const struct ethosu_job *job,
+                             const uint32_t include,
+                             const uint32_t exclude,
+                             uint64_t *range_addr,
+                             size_t *range_size)
+{
+    int num_ranges = 0;
 
-            // Reset the NPU
-            (void)ethosu_soft_reset(drv);
+    for (int i = 0; i < job->num_base_addr && i < ETHOSU_MAX_BASE_ADDR; i++)
+    {
+        const struct ethosu_region *region = &job->network->region[i];
+        uint32_t access                    = region->access;
 
-            ret = -1;
+        if (access == ETHOSU_REGION_ACCESS_DEFAULT)
+        {
+            access = ETHOSU_REGION_ACCESS_READ_WRITE;
         }
-        else
+
+        if ((job->fast_region[i] >= 0 && job->fast_addr[i] != job->base_addr[i]) ||
+            (i == 0 && job->weight_stage >= 0))
         {
-            LOG_DEBUG("Inference finished successfully...");
-            ret = 0;
+            continue;
         }
 
-        // Reset internal job (state resets to IDLE)
-        ethosu_reset_job(drv);
-        break;
+        if ((access & include) == 0 || (access & exclude) != 0)
+        {
+            continue;
+        }
 
-    default:
-        LOG_ERR("Unexpected job state");
-        ethosu_reset_job(drv);
-        ret = -1;
-        break;
+        if (region->offset >= job->base_addr_size[i])
+        {
+            continue;
+        }
+
+        range_addr[num_ranges] = job->base_addr[i] + region->offset;
+        range_size[num_ranges] = job->base_addr_size[i] - region->offset;
+
+        if (region->size != 0 && region->size < range_size[num_ranges])
+        {
+            range_size[num_ranges] = region->size;
+        }
+
+        num_ranges++;
     }
 
-    // Return inference job status
-    return ret;
+    return num_ranges;
 }
 
-int ethosu_invoke_async(struct ethosu_driver *drv,
-                        const void *custom_data_ptr,
-                        const int custom_data_size,
-                        uint64_t *const base_addr,
-                        const size_t *base_addr_size,
-                        const int num_base_addr,
-                        void *user_arg)
+static void ethosu_flush_job(const struct ethosu_job *job)
 {
-    assert(custom_data_ptr != NULL);
-    assert(base_addr != NULL);
-    assert(base_addr_size != NULL);
+    uint64_t range_addr[ETHOSU_MAX_BASE_ADDR];
+    size_t range_size[ETHOSU_MAX_BASE_ADDR];
+    int num_ranges;
 
-    const struct cop_data_s *data_ptr = custom_data_ptr;
-    const struct cop_data_s *data_end = (struct cop_data_s *)((ptrdiff_t)custom_data_ptr + custom_data_size);
+    if (job->network == NULL)
+    {
+        ethosu_flush_dcache(job->base_addr, job->base_addr_size, job->num_base_addr);
+        return;
+    }
 
-    // Make sure an inference is not already running
-    if (drv->job.state != ETHOSU_JOB_IDLE)
+    // Clean data read by the NPU
+    num_ranges = ethosu_job_ranges(job, ETHOSU_REGION_ACCESS_READ, 0, range_addr, range_size);
+    if (num_ranges > 0)
     {
-        LOG_ERR("Inference already running, or waiting to be cleared...");
-        return -1;
+        ethosu_flush_dcache(range_addr, range_size, num_ranges);
+    }
+
+    // Drop lines only written by the NPU, so that they are not evicted on top
+    // of the NPU output
+    num_ranges = ethosu_job_ranges(job, ETHOSU_REGION_ACCESS_WRITE, ETHOSU_REGION_ACCESS_READ, range_addr, range_size);
+    if (num_ranges > 0)
+    {
+        ethosu_invalidate_dcache(range_addr, range_size, num_ranges);
     }
+}
 
-    drv->job.state            = ETHOSU_JOB_IDLE;
-    drv->job.custom_data_ptr  = custom_data_ptr;
-    drv->job.custom_data_size = custom_data_size;
-    drv->job.base_addr        = base_addr;
-    drv->job.base_addr_size   = base_addr_size;
-    drv->job.num_base_addr    = num_base_addr;
-    drv->job.user_arg         = user_arg;
+static void ethosu_invalidate_job(const struct ethosu_job *job)
+{
+    uint64_t range_addr[ETHOSU_MAX_BASE_ADDR];
+    size_t range_size[ETHOSU_MAX_BASE_ADDR];
+    int num_ranges;
 
-    // First word in custom_data_ptr should contain "Custom Operator Payload 1"
-    if (data_ptr->word != ETHOSU_FOURCC)
+    if (job->network == NULL)
     {
-        LOG_ERR("Custom Operator Payload: %" PRIu32 " is not correct, expected %x", data_ptr->word, ETHOSU_FOURCC);
-        goto err;
+        ethosu_invalidate_dcache(job->base_addr, job->base_addr_size, job->num_base_addr);
+        return;
     }
 
-    // Custom data length must be a multiple of 32 bits
-    if ((custom_data_size % BYTES_IN_32_BITS) != 0)
+    // Invalidate data written by the NPU
+    num_ranges = ethosu_job_ranges(job, ETHOSU_REGION_ACCESS_WRITE, 0, range_addr, range_size);
+    if (num_ranges > 0)
     {
-        LOG_ERR("custom_data_size=0x%x not a multiple of 4", (unsigned)custom_data_size);
-        goto err;
+        ethosu_invalidate_dcache(range_addr, range_size, num_ranges);
     }
+}
 
-    data_ptr++;
+/*
+ * Derive the region access of a prepared network from the command stream
+ * footprint. Ranges are widened to whole cache lines.
+ */
+static void ethosu_apply_footprint(struct ethosu_network *net)
+{
+    const struct ethosu_footprint *footprint = &net->footprint;
 
-    // Adjust base address to fast memory area
-    if (drv->fast_memory != 0 && num_base_addr > FAST_MEMORY_BASE_ADDR_INDEX)
+    for (int i = 0; i < ETHOSU_MAX_BASE_ADDR; i++)
     {
-        if (base_addr_size[FAST_MEMORY_BASE_ADDR_INDEX] > drv->fast_memory_size)
+        const struct ethosu_range *read  = &footprint->read[i];
+        const struct ethosu_range *write = &footprint->write[i];
+        struct ethosu_region *region     = &net->region[i];
+        size_t start                     = SIZE_MAX;
+        size_t end                       = 0;
+
+        region->access = (read->size != 0 ? ETHOSU_REGION_ACCESS_READ : 0) |
+                         (write->size != 0 ? ETHOSU_REGION_ACCESS_WRITE : 0);
+        region->offset = 0;
+        region->size   = 0;
+
+        if (region->access == 0)
         {
-            LOG_ERR("Fast memory area too small. fast_memory_size=%zu, base_addr_size=%zu",
-                    drv->fast_memory_size,
-                    base_addr_size[FAST_MEMORY_BASE_ADDR_INDEX]);
-            goto err;
+            region->access = ETHOSU_REGION_ACCESS_NONE;
+            continue;
+        }
+
+        if (read->size == SIZE_MAX || write->size == SIZE_MAX)
+        {
+            continue;
+        }
+
+        if (read->size != 0)
+        {
+            start = read->offset;
+            end   = read->offset + read->size;
         }
 
-        base_addr[FAST_MEMORY_BASE_ADDR_INDEX] = drv->fast_memory;
+        if (write->size != 0)
+        {
+            start = write->offset < start ? write->offset : start;
+            end   = write->offset + write->size > end ? write->offset + write->size : end;
+        }
+
+        start = start & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+        end   = (end + ETHOSU_CACHE_LINE_SIZE - 1) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+
+        region->offset = start;
+        region->size   = end - start;
+    }
+}
+
+/*
+ * Verify an optimizer config against the NPU. The last config that passed is
+ * recorded, so that it is only verified again when it changes.
+ */
+static int ethosu_verify_optimizer_config(struct ethosu_driver *drv, uint32_t cfg, uint32_t id)
+{
+    if (drv->optimizer_verified && drv->optimizer_cfg == cfg && drv->optimizer_id == id)
+    {
+        return 0;
+    }
+
+    if (ethosu_dev_verify_optimizer_config(&drv->dev, cfg, id) != true)
+    {
+        return -1;
+    }
+
+    drv->optimizer_verified = true;
+    drv->optimizer_cfg      = cfg;
+    drv->optimizer_id       = id;
+
+    return 0;
+}
+
+static int handle_optimizer_config(struct ethosu_driver *drv, struct opt_cfg_s const *opt_cfg_p)
+{
+    DRV_LOG_INFO(drv, "Optimizer release nbr: %u patch: %u", opt_cfg_p->da_data.rel_nbr, opt_cfg_p->da_data.patch_nbr);
+
+    return ethosu_verify_optimizer_config(drv, opt_cfg_p->cfg, opt_cfg_p->id);
+}
+
+static int handle_command_stream(struct ethosu_job *job, const uint8_t *cmd_stream, const int cms_length)
+{
+    uint32_t cms_bytes = cms_length * BYTES_IN_32_BITS;
+
+    LOG_INFO("handle_command_stream: cmd_stream=%p, cms_length %d", cmd_stream, cms_length);
+
+    if (0 != ((ptrdiff_t)cmd_stream & MASK_16_BYTE_ALIGN))
+    {
+        LOG_ERR("Command stream addr %p not aligned to 16 bytes", cmd_stream);
+        return -1;
+    }
+
+    job->cmd_stream = cmd_stream;
+    job->cms_length = cms_bytes;
+
+    return 0;
+}
+
+/*
+ * Parse and validate the custom operator payload produced by Vela into the
+ * payload fields of a job. The optimizer config found, if any, is returned in
+ * opt_cfg.
+ */
+static int ethosu_parse_custom_data(struct ethosu_driver *drv,
+                                    struct ethosu_job *job,
+                                    const void *custom_data_ptr,
+                                    const int custom_data_size,
+                                    struct opt_cfg_s const **opt_cfg)
+{
+    const struct cop_data_s *data_ptr = custom_data_ptr;
+    const struct cop_data_s *data_end = (struct cop_data_s *)((ptrdiff_t)custom_data_ptr + custom_data_size);
+
+    job->custom_data_ptr  = custom_data_ptr;
+    job->custom_data_size = custom_data_size;
+    job->cmd_stream       = NULL;
+    job->cms_length       = 0;
+    *opt_cfg              = NULL;
+
+    // First word in custom_data_ptr should contain "Custom Operator Payload 1"
+    if (data_ptr->word != ETHOSU_FOURCC)
+    {
+        DRV_LOG_ERR(
+            drv, "Custom Operator Payload: %" PRIu32 " is not correct, expected %x", data_ptr->word, ETHOSU_FOURCC);
+        return -1;
+    }
+
+    // Custom data length must be a multiple of 32 bits
+    if ((custom_data_size % BYTES_IN_32_BITS) != 0)
+    {
+        DRV_LOG_ERR(drv, "custom_data_size=0x%x not a multiple of 4", (unsigned)custom_data_size);
+        return -1;
     }
 
+    data_ptr++;
+
     // Parse Custom Operator Payload data
     while (data_ptr < data_end)
     {
         switch (data_ptr->driver_action_command)
         {
         case OPTIMIZER_CONFIG:
-            LOG_DEBUG("OPTIMIZER_CONFIG");
+            DRV_LOG_DEBUG(drv, "OPTIMIZER_CONFIG");
             struct opt_cfg_s const *opt_cfg_p = (const struct opt_cfg_s *)data_ptr;
 
             if (handle_optimizer_config(drv, opt_cfg_p) < 0)
             {
-                goto err;
+                return -1;
             }
+            *opt_cfg = opt_cfg_p;
             data_ptr += DRIVER_ACTION_LENGTH_32_BIT_WORD + OPTIMIZER_CONFIG_LENGTH_32_BIT_WORD;
             break;
         case COMMAND_STREAM:
             // Vela only supports putting one COMMAND_STREAM per op
-            LOG_DEBUG("COMMAND_STREAM");
+            DRV_LOG_DEBUG(drv, "COMMAND_STREAM");
             const uint8_t *command_stream = (const uint8_t *)(data_ptr + 1);
             int cms_length                = (data_ptr->reserved << 16) | data_ptr->length;
 
-            if (handle_command_stream(drv, command_stream, cms_length) < 0)
+            if (handle_command_stream(job, command_stream, cms_length) < 0)
             {
-                goto err;
+                return -1;
             }
             data_ptr += DRIVER_ACTION_LENGTH_32_BIT_WORD + cms_length;
             break;
         case NOP:
-            LOG_DEBUG("NOP");
+            DRV_LOG_DEBUG(drv, "NOP");
             data_ptr += DRIVER_ACTION_LENGTH_32_BIT_WORD;
             break;
         default:
-            LOG_ERR("UNSUPPORTED driver_action_command: %u", data_ptr->driver_action_command);
-            goto err;
+            DRV_LOG_ERR(drv, "UNSUPPORTED driver_action_command: %u", data_ptr->driver_action_command);
+            return -1;
             break;
         }
     }
 
-    return 0;
-err:
-    LOG_ERR("Failed to invoke inference.");
-    ethosu_reset_job(drv);
-    return -1;
-}
-
-int ethosu_invoke_v3(struct ethosu_driver *drv,
-                     const void *custom_data_ptr,
-                     const int custom_data_size,
-                     uint64_t *const base_addr,
-                     const size_t *base_addr_size,
-                     const int num_base_addr,
-                     void *user_arg)
-{
-    if (ethosu_invoke_async(
-            drv, custom_data_ptr, custom_data_size, base_addr, base_addr_size, num_base_addr, user_arg) < 0)
+    if (job->cmd_stream == NULL)
     {
+        DRV_LOG_ERR(drv, "No command stream found in custom operator payload");
         return -1;
     }
 
-    return ethosu_wait(drv, true);
+    return 0;
 }
 
-struct ethosu_driver *ethosu_reserve_driver(void)
+/*
+ * Get the fast memory area of a network, the slot assigned to the network or
+ * else the whole fast memory. Returns false if the slot has not been laid out
+ * for the network on this NPU. A NULL network is an unprepared payload.
+ */
+static bool ethosu_fast_memory_area(const struct ethosu_driver *drv,
+                                    const struct ethosu_network *net,
+                                    uint64_t *address,
+                                    size_t *size)
 {
-    struct ethosu_driver *drv = NULL;
+    const struct ethosu_fast_memory_slot *slot;
 
-    LOG_INFO("Acquiring NPU driver handle");
-    ethosu_semaphore_take(ethosu_semaphore, ETHOSU_SEMAPHORE_WAIT_FOREVER); // This is meant to block until available
+    *address = drv->fast_memory;
+    *size    = drv->fast_memory_size;
 
-    ethosu_mutex_lock(ethosu_mutex);
-    drv = registered_drivers;
-
-    while (drv != NULL)
+    if (net == NULL || net->fast_memory_slot == ETHOSU_FAST_MEMORY_SLOT_NONE)
     {
-        if (!drv->reserved)
-        {
-            drv->reserved = true;
-            LOG_DEBUG("NPU driver handle %p reserved", drv);
-            break;
-        }
-        drv = drv->next;
+        return true;
     }
-    ethosu_mutex_unlock(ethosu_mutex);
 
-    if (!drv)
+    slot = &drv->fast_memory_slot[net->fast_memory_slot];
+    if (slot->size < net->fast_memory_size)
     {
-        LOG_ERR("No NPU driver handle available, but semaphore taken");
+        *size = 0;
+        return false;
     }
 
-    return drv;
+    *address += slot->offset;
+    *size = slot->size;
+
+    return true;
 }
 
-void ethosu_release_driver(struct ethosu_driver *drv)
+/*
+ * Place the base addresses of a job in the fast memory regions. Without a
+ * placement, base address 2 is placed in the fast memory area of the network.
+ * Otherwise each selected base address is placed, in index order, in the
+ * region with the lowest latency that has room for it, the fullest one on a
+ * tie. Returns false if a base address does not fit.
+ */
+static bool ethosu_fast_memory_plan(const struct ethosu_driver *drv,
+                                    const struct ethosu_network *net,
+                                    const size_t *base_addr_size,
+                                    const int num_base_addr,
+                                    uint64_t *fast_addr,
+                                    int8_t *fast_region)
+{
+    uint64_t next[ETHOSU_FAST_MEMORY_REGIONS];
+    size_t room[ETHOSU_FAST_MEMORY_REGIONS];
+    uint32_t place  = net != NULL ? net->fast_memory_place : 0;
+    int num_regions = 1;
+
+    for (int i = 0; i < ETHOSU_MAX_BASE_ADDR; i++)
+    {
+        fast_addr[i]   = 0;
+        fast_region[i] = -1;
+    }
+
+    if (!ethosu_fast_memory_area(drv, net, &next[0], &room[0]))
+    {
+        room[0] = 0;
+    }
+
+    if (place == 0)
+    {
+        if (drv->fast_memory == 0)
+        {
+            return true;
+        }
+
+        place = 1 << FAST_MEMORY_BASE_ADDR_INDEX;
+    }
+    else
+    {
+        num_regions = ETHOSU_FAST_MEMORY_REGIONS;
+        for (int r = 1; r < num_regions; r++)
+        {
+            next[r] = drv->fast_region[r].address;
+            room[r] = drv->fast_region[r].size;
+        }
+    }
+
+    for (int i = 0; i < num_base_addr; i++)
+    {
+        const size_t size = (base_addr_size[i] + ETHOSU_CACHE_LINE_SIZE - 1) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+        int best          = -1;
+
+        if ((place & (1u << i)) == 0)
+        {
+            continue;
+        }
+
+        for (int r = 0; r < num_regions; r++)
+        {
+            if (room[r] < base_addr_size[i])
+            {
+                continue;
+            }
+
+            if (best < 0 || drv->fast_region[r].latency < drv->fast_region[best].latency ||
+                (drv->fast_region[r].latency == drv->fast_region[best].latency && room[r] < room[best]))
+            {
+                best = r;
+            }
+        }
+
+        if (best < 0)
+        {
+            return false;
+        }
+
+        fast_addr[i]   = next[best];
+        fast_region[i] = best;
+        next[best]     = next[best] + size;
+        room[best]     = room[best] > size ? room[best] - size : 0;
+    }
+
+    return true;
+}
+
+/*
+ * Check that the base addresses of a job placed in fast memory fit on the NPU.
+ */
+static bool ethosu_fast_memory_fits(const struct ethosu_driver *drv,
+                                    const struct ethosu_network *net,
+                                    const size_t *base_addr_size,
+                                    const int num_base_addr)
+{
+    uint64_t fast_addr[ETHOSU_MAX_BASE_ADDR];
+    int8_t fast_region[ETHOSU_MAX_BASE_ADDR];
+
+    return ethosu_fast_memory_plan(drv, net, base_addr_size, num_base_addr, fast_addr, fast_region);
+}
+
+/*
+ * Check if read-only data of the network is still loaded in the fast memory.
+ */
+static bool ethosu_fast_memory_loaded(const struct ethosu_driver *drv, const struct ethosu_network *net)
+{
+    for (int r = 0; r < ETHOSU_FAST_MEMORY_REGIONS; r++)
+    {
+        if (drv->fast_region[r].loaded == net)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Copy the weights of a network to a weight staging buffer that is not used by
+ * any queued job, unless they are staged already. Returns the buffer index, or
+ * -1 if the weights are read in place.
+ */
+static int ethosu_weight_stage(struct ethosu_driver *drv,
+                               const struct ethosu_network *net,
+                               const uint64_t *base_addr,
+                               const size_t *base_addr_size,
+                               const int num_base_addr,
+                               const int8_t *fast_region)
+{
+    const struct ethosu_region *region;
+    bool used[2] = {false, false};
+    uint64_t address;
+    size_t line_size;
+    size_t size;
+    int stage;
+
+    if (drv->weight_stage_base == 0 || net == NULL || !net->weight_staging || num_base_addr < 1 ||
+        fast_region[0] >= 0 || net->region[0].access == ETHOSU_REGION_ACCESS_NONE)
+    {
+        return -1;
+    }
+
+    region = &net->region[0];
+
+    // Stage from the base address to the end of the range read by the NPU
+    size = base_addr_size[0];
+    if (region->size != 0 && region->offset + region->size < size)
+    {
+        size = region->offset + region->size;
+    }
+
+    if (size == 0 || size > drv->weight_stage_size)
+    {
+        drv->weight_stats.misses++;
+        return -1;
+    }
+
+    for (stage = 0; stage < 2; stage++)
+    {
+        if (drv->weight_stage[stage].source == base_addr[0] && drv->weight_stage[stage].size == size)
+        {
+            drv->weight_stage_last = stage;
+            drv->weight_stats.hits++;
+            return stage;
+        }
+    }
+
+    // Buffers read by queued jobs must not be overwritten
+    for (uint32_t i = drv->job_head; i != drv->job_tail; i = ethosu_job_index_next(i))
+    {
+        const struct ethosu_job *job = ethosu_job_at(drv, i);
+
+        if (job->weight_stage >= 0)
+        {
+            used[job->weight_stage] = true;
+        }
+    }
+
+    // Keep the most recently staged weights if possible
+    stage = 1 - drv->weight_stage_last;
+    if (used[stage])
+    {
+        stage = 1 - stage;
+    }
+
+    if (used[stage])
+    {
+        drv->weight_stats.misses++;
+        return -1;
+    }
+
+    address   = drv->weight_stage_base + (uint64_t)stage * drv->weight_stage_size;
+    line_size = (size + ETHOSU_CACHE_LINE_SIZE - 1) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+
+    // Clean the copied weights before they are read by the NPU
+    ethosu_fast_memory_copy(drv, (void *)(uintptr_t)address, (const void *)(uintptr_t)base_addr[0], size);
+    ethosu_flush_dcache(&address, &line_size, 1);
+
+    drv->weight_stage[stage].source = base_addr[0];
+    drv->weight_stage[stage].size   = size;
+    drv->weight_stage_last          = stage;
+    drv->weight_stats.copies++;
+
+    DRV_LOG_DEBUG(drv, "Weights staged. buffer=%d, source=0x%" PRIx64 ", size=%zu", stage, base_addr[0], size);
+
+    return stage;
+}
+
+/*
+ * Get the free job slot at the tail of the queue, or NULL if the queue is full.
+ */
+static struct ethosu_job *ethosu_free_job(struct ethosu_driver *drv)
+{
+    if (ethosu_job_count(drv) >= ETHOSU_JOB_QUEUE_SIZE)
+    {
+        DRV_LOG_ERR(drv, "Job queue full, inference already running or waiting to be cleared...");
+        return NULL;
+    }
+
+    return ethosu_job_at(drv, drv->job_tail);
+}
+
+/*
+ * Add a job for a prepared network to the queue, and start it right away if the
+ * NPU is idle. Without a network, the payload fields of the free job slot have
+ * already been filled in by ethosu_parse_custom_data(). The slot is cleared if
+ * the job can not be queued. Must be called with the job mutex locked.
+ */
+static int ethosu_submit_job(struct ethosu_driver *drv,
+                             struct ethosu_network *net,
+                             uint64_t *const base_addr,
+                             const size_t *base_addr_size,
+                             const int num_base_addr,
+                             void *user_arg,
+                             ethosu_job_callback callback,
+                             bool deferred)
+{
+    uint64_t fast_addr[ETHOSU_MAX_BASE_ADDR];
+    int8_t fast_region[ETHOSU_MAX_BASE_ADDR];
+    struct ethosu_job *job;
+    int weight_stage;
+
+    // Make sure there is room for another job in the queue
+    job = ethosu_free_job(drv);
+    if (job == NULL)
+    {
+        return -1;
+    }
+
+    if (net != NULL)
+    {
+        job->custom_data_ptr  = net->custom_data_ptr;
+        job->custom_data_size = net->custom_data_size;
+        job->cmd_stream       = net->cmd_stream;
+        job->cms_length       = net->cms_length;
+    }
+
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_INVOKE, (uintptr_t)job->custom_data_ptr, num_base_addr);
+
+    if (num_base_addr < 0 || num_base_addr > ETHOSU_MAX_BASE_ADDR)
+    {
+        DRV_LOG_ERR(drv, "Invalid number of base addresses. num_base_addr=%d", num_base_addr);
+        ethosu_reset_job(job);
+        return -1;
+    }
+
+    // The network may be dispatched to another NPU than it was prepared on
+    if (net != NULL && net->has_optimizer_config &&
+        ethosu_verify_optimizer_config(drv, net->optimizer_cfg, net->optimizer_id) < 0)
+    {
+        DRV_LOG_ERR(drv, "Network optimizer config does not match the NPU");
+        ethosu_reset_job(job);
+        return -1;
+    }
+
+    // The fast memory contents of a resident network only exist on one NPU
+    if (net != NULL && net->fast_memory_owner != NULL && net->fast_memory_owner != drv)
+    {
+        DRV_LOG_ERR(drv, "Network fast memory resident on another NPU. owner=%p", (void *)net->fast_memory_owner);
+        ethosu_reset_job(job);
+        return -1;
+    }
+
+    // Place base addresses in the fast memory regions
+    if (!ethosu_fast_memory_plan(drv, net, base_addr_size, num_base_addr, fast_addr, fast_region))
+    {
+        DRV_LOG_ERR(drv,
+                    "Fast memory too small. fast_memory_size=%zu, fast_memory_place=0x%" PRIx32,
+                    drv->fast_memory_size,
+                    net != NULL ? net->fast_memory_place : 0);
+        ethosu_reset_job(job);
+        return -1;
+    }
+
+    // Without a placement the fast memory is written back as base address 2
+    if ((net == NULL || net->fast_memory_place == 0) && fast_region[FAST_MEMORY_BASE_ADDR_INDEX] >= 0)
+    {
+        base_addr[FAST_MEMORY_BASE_ADDR_INDEX] = fast_addr[FAST_MEMORY_BASE_ADDR_INDEX];
+    }
+
+    // Verify minimum 16 byte alignment for base address'
+    for (int i = 0; i < num_base_addr; i++)
+    {
+        if (0 != (base_addr[i] & MASK_16_BYTE_ALIGN))
+        {
+            DRV_LOG_ERR(drv, "Base addr %d: 0x%" PRIx64 "not aligned to 16 bytes", i, base_addr[i]);
+            ethosu_reset_job(job);
+            return -1;
+        }
+    }
+
+    // Stage the weights while the NPU is busy with the previous job
+    weight_stage = ethosu_weight_stage(drv, net, base_addr, base_addr_size, num_base_addr, fast_region);
+
+    job->base_addr      = base_addr;
+    job->base_addr_size = base_addr_size;
+    job->num_base_addr  = num_base_addr;
+    job->user_arg       = user_arg;
+    job->network        = net;
+    job->callback       = callback;
+    job->deferred       = deferred;
+    job->weight_stage   = (int8_t)weight_stage;
+    memcpy(job->fast_addr, fast_addr, sizeof(job->fast_addr));
+    memcpy(job->fast_region, fast_region, sizeof(job->fast_region));
+
+    // Flush/clean the data cache
+    ethosu_flush_job(job);
+
+    // Request power gating disabled during inference run
+    if (ethosu_request_power(drv))
+    {
+        DRV_LOG_ERR(drv, "Failed to request power");
+        ethosu_reset_job(job);
+        return -1;
+    }
+
+    // Publish the job before the interrupt handler may look for it
+    job->state = ETHOSU_JOB_PENDING;
+    __DMB();
+    drv->job_tail = ethosu_job_index_next(drv->job_tail);
+
+    ethosu_start_next_job(drv);
+
+    return 0;
+}
+
+/*
+ * Submit a job, serialized with other threads submitting to or finishing up
+ * jobs on the driver.
+ */
+static int ethosu_invoke_job(struct ethosu_driver *drv,
+                             struct ethosu_network *net,
+                             uint64_t *const base_addr,
+                             const size_t *base_addr_size,
+                             const int num_base_addr,
+                             void *user_arg,
+                             ethosu_job_callback callback,
+                             bool deferred)
+{
+    int ret;
+
+    ethosu_mutex_lock(drv->job_mutex);
+    ret = ethosu_submit_job(drv, net, base_addr, base_addr_size, num_base_addr, user_arg, callback, deferred);
+    ethosu_mutex_unlock(drv->job_mutex);
+
+    return ret;
+}
+
+static void ethosu_dequeue_job(struct ethosu_driver *drv)
+{
+    // Remove job from queue (state resets to IDLE)
+    ethosu_reset_job(ethosu_job_at(drv, drv->job_head));
+    drv->job_head = ethosu_job_index_next(drv->job_head);
+}
+
+/*
+ * Finish up the oldest job in the queue, once it has completed or timed out.
+ */
+static int ethosu_finish_job(struct ethosu_driver *drv)
+{
+    struct ethosu_job *job       = ethosu_job_at(drv, drv->job_head);
+    ethosu_job_callback callback = job->callback;
+    void *user_arg               = job->user_arg;
+    bool reset                   = false;
+    int ret;
+
+    // Invalidate cache
+    ethosu_invalidate_job(job);
+
+    // Copy the output out of fast memory before the next job reuses it
+    if (job->result == ETHOSU_JOB_RESULT_OK)
+    {
+        ethosu_fast_memory_store(drv, job);
+    }
+
+    // Inference done callback - always called for a started job, even in case of timeout
+    if (job->begun)
+    {
+        ethosu_inference_end(drv, job->user_arg);
+    }
+
+    // A failed job leaves the NPU in an unknown state, which must not be kept
+    // powered. Aborted jobs were failed after the NPU had been reset.
+    if (job->result && job->result != ETHOSU_JOB_RESULT_ABORTED)
+    {
+        drv->reset_required = true;
+    }
+
+    // Release power gating disabled requirement
+    ethosu_release_power(drv);
+
+    // Check NPU and interrupt status
+    if (job->result == ETHOSU_JOB_RESULT_ABORTED)
+    {
+        DRV_LOG_WARN(drv, "NPU inference aborted.");
+        ret = -1;
+    }
+    else if (job->result)
+    {
+        if (job->result == ETHOSU_JOB_RESULT_ERROR)
+        {
+            DRV_LOG_ERR(drv, "NPU error(s) occured during inference.");
+            ethosu_dev_print_err_status(&drv->dev);
+        }
+        else
+        {
+            DRV_LOG_ERR(drv, "NPU inference timed out.");
+        }
+
+        reset = true;
+        ret   = -1;
+    }
+    else
+    {
+        DRV_LOG_DEBUG(drv, "Inference finished successfully...");
+        ret = 0;
+    }
+
+    ethosu_dequeue_job(drv);
+
+    // A thread submitting a job may start it at the same time
+    ethosu_mutex_lock(drv->job_mutex);
+
+    if (reset)
+    {
+        // Reset the NPU and continue with any queued jobs
+        (void)ethosu_soft_reset(drv);
+        ethosu_resume_jobs(drv);
+    }
+    else
+    {
+        // Start the next queued job, unless the interrupt handler already has
+        ethosu_start_next_job(drv);
+    }
+
+    ethosu_mutex_unlock(drv->job_mutex);
+
+    // Job completion callback, called once the job has left the queue
+    if (callback != NULL)
+    {
+        callback(drv, ret, user_arg);
+    }
+
+    return ret;
+}
+
+/*
+ * Abort all queued jobs that have not completed, and stop the NPU. The jobs
+ * are then finished up in submission order, failing the aborted ones. Jobs
+ * with deferred completion are left to ethosu_complete_jobs(), which may
+ * already be running in another context.
+ */
+static void ethosu_abort_jobs(struct ethosu_driver *drv)
+{
+    struct ethosu_job *running = ethosu_find_job(drv, ETHOSU_JOB_RUNNING);
+
+    // Make the interrupt handler ignore the running job before the NPU is reset
+    for (uint32_t i = drv->job_head; i != drv->job_tail; i = ethosu_job_index_next(i))
+    {
+        struct ethosu_job *job = ethosu_job_at(drv, i);
+
+        if (job->state != ETHOSU_JOB_DONE)
+        {
+            job->result = ETHOSU_JOB_RESULT_ABORTED;
+        }
+    }
+
+    if (running != NULL)
+    {
+        if (running->deferred && drv->job_timeout != 0)
+        {
+            ethosu_job_timer_stop(drv);
+        }
+
+        ethosu_pmu_timeline_end(drv, running);
+    }
+
+    (void)ethosu_soft_reset(drv);
+
+    // Nothing is left to be started or resumed when a failed job is finished
+    for (uint32_t i = drv->job_head; i != drv->job_tail; i = ethosu_job_index_next(i))
+    {
+        ethosu_job_at(drv, i)->state = ETHOSU_JOB_DONE;
+    }
+
+    drv->draining = true;
+
+    while (ethosu_job_count(drv) > 0)
+    {
+        struct ethosu_job *job = ethosu_job_at(drv, drv->job_head);
+        const bool deferred    = job->deferred;
+
+        // A cleared slot has just been finished by ethosu_complete_jobs()
+        __DMB();
+        if (job->state != ETHOSU_JOB_DONE)
+        {
+            continue;
+        }
+
+        if (deferred)
+        {
+            ethosu_defer_completion(drv);
+            ethosu_semaphore_take(drv->drain_semaphore, ETHOSU_SEMAPHORE_WAIT_FOREVER);
+            continue;
+        }
+
+        // Take the semaphore given for a job completed by the interrupt handler
+        if (job->result != ETHOSU_JOB_RESULT_ABORTED)
+        {
+            ethosu_semaphore_take(drv->semaphore, ETHOSU_SEMAPHORE_WAIT_INFERENCE);
+        }
+
+        (void)ethosu_finish_job(drv);
+    }
+
+    drv->draining = false;
+}
+
+/*
+ * Return the scheduled driver following drv in the list of registered drivers,
+ * or the first one if drv is NULL.
+ */
+static struct ethosu_driver *ethosu_sched_next(struct ethosu_driver *drv)
+{
+    ethosu_mutex_lock(ethosu_mutex);
+    drv = drv == NULL ? registered_drivers : drv->next;
+    while (drv != NULL && !drv->scheduled)
+    {
+        drv = drv->next;
+    }
+    ethosu_mutex_unlock(ethosu_mutex);
+
+    return drv;
+}
+
+/*
+ * Enable clock and power gating, for an NPU without any power requests.
+ */
+static void ethosu_power_down(struct ethosu_driver *drv)
+{
+    drv->power_idle = false;
+    drv->power_stats.power_downs++;
+    ethosu_dev_set_clock_and_power(&drv->dev, ETHOSU_CLOCK_Q_ENABLE, ETHOSU_POWER_Q_ENABLE);
+}
+
+/*
+ * Estimate the NPU cycles left for the queued jobs of a driver, from the cycle
+ * estimates of their networks. Returns false if a queued job has no estimate.
+ */
+static bool ethosu_sched_remaining(struct ethosu_driver *drv, uint64_t *remaining)
+{
+    *remaining = 0;
+
+    // Jobs being submitted by other threads are not queued yet
+    if (drv->sched_claimed > 0)
+    {
+        return false;
+    }
+
+    for (uint32_t i = drv->job_head; i != drv->job_tail; i = ethosu_job_index_next(i))
+    {
+        const struct ethosu_job *job = ethosu_job_at(drv, i);
+        uint64_t cycles;
+
+        if (job->state == ETHOSU_JOB_DONE)
+        {
+            continue;
+        }
+
+        if (job->network == NULL || job->network->cycles == 0)
+        {
+            return false;
+        }
+
+        cycles = job->network->cycles;
+        if (job->state == ETHOSU_JOB_RUNNING)
+        {
+            const uint64_t elapsed = ethosu_pmu_capture_elapsed(drv);
+            cycles -= elapsed < cycles ? elapsed : cycles;
+        }
+
+        *remaining += cycles;
+    }
+
+    return true;
+}
+
+/*
+ * Check if a scheduled driver is able to queue the job, and get its load.
+ * Must be called with the driver mutex locked.
+ */
+static bool ethosu_sched_load(struct ethosu_driver *drv,
+                              const struct ethosu_network *net,
+                              const size_t *base_addr_size,
+                              const int num_base_addr,
+                              uint32_t *load)
+{
+    const uint32_t count = ethosu_job_count(drv) + drv->sched_claimed;
+
+    if (!drv->scheduled || count >= ETHOSU_JOB_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    if (!ethosu_fast_memory_fits(drv, net, base_addr_size, num_base_addr))
+    {
+        return false;
+    }
+
+    // A network resident in fast memory stays on its NPU
+    if (net->fast_memory_owner != NULL && net->fast_memory_owner != drv)
+    {
+        return false;
+    }
+
+    // Shortest queue first. On a tie prefer an NPU with the read-only data of
+    // the network still in fast memory, and then one that is already powered.
+    *load = count * 4 + (ethosu_fast_memory_loaded(drv, net) ? 0 : 2) +
+            (drv->power_request_counter > 0 || drv->power_idle ? 0 : 1);
+
+    return true;
+}
+
+/*
+ * Select the least loaded scheduled driver able to run the job. Must be called
+ * with the driver mutex locked.
+ */
+static struct ethosu_driver *
+ethosu_sched_select(const struct ethosu_network *net, const size_t *base_addr_size, const int num_base_addr)
+{
+    struct ethosu_driver *best = NULL;
+    uint32_t best_load         = UINT32_MAX;
+    uint64_t best_remaining    = UINT64_MAX;
+    bool known                 = true;
+    uint32_t load;
+    uint64_t remaining;
+
+    // The NPU cycles left are only comparable if known for all candidates
+    for (struct ethosu_driver *drv = registered_drivers; drv != NULL && known; drv = drv->next)
+    {
+        if (ethosu_sched_load(drv, net, base_addr_size, num_base_addr, &load))
+        {
+            known = ethosu_sched_remaining(drv, &remaining);
+        }
+    }
+
+    // Least NPU cycles left first, and on a tie the lowest load. Otherwise
+    // only the lowest load.
+    for (struct ethosu_driver *drv = registered_drivers; drv != NULL; drv = drv->next)
+    {
+        if (!ethosu_sched_load(drv, net, base_addr_size, num_base_addr, &load))
+        {
+            continue;
+        }
+
+        remaining = 0;
+        if (known)
+        {
+            (void)ethosu_sched_remaining(drv, &remaining);
+        }
+
+        if (remaining < best_remaining || (remaining == best_remaining && load < best_load))
+        {
+            best           = drv;
+            best_load      = load;
+            best_remaining = remaining;
+        }
+    }
+
+    return best;
+}
+
+/******************************************************************************
+ * Weak functions - Interrupt handler
+ ******************************************************************************/
+void __attribute__((weak)) ethosu_irq_handler(struct ethosu_driver *drv)
+{
+    struct ethosu_job *job;
+
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_IRQ_BEGIN, 0, 0);
+
+    // Extend the PMU counters that have wrapped
+    ethosu_pmu_handle_overflow(drv);
+
+    // PMU overflow while the NPU is still running a job
+    if (ethosu_dev_handle_pmu_interrupt(&drv->dev))
+    {
+        ETHOSU_TRACE(drv, ETHOSU_TRACE_IRQ_END, -1, 0);
+        return;
+    }
+
+    job = ethosu_find_job(drv, ETHOSU_JOB_RUNNING);
+
+    // Prevent race condition where interrupt triggered after a timeout waiting
+    // for semaphore, or after the job was aborted, but before NPU is reset.
+    if (job == NULL || job->result != ETHOSU_JOB_RESULT_OK)
+    {
+        (void)ethosu_dev_handle_interrupt(&drv->dev);
+        ETHOSU_TRACE(drv, ETHOSU_TRACE_IRQ_END, -1, 0);
+        return;
+    }
+
+    job->state  = ETHOSU_JOB_DONE;
+    job->result = ethosu_dev_handle_interrupt(&drv->dev) ? ETHOSU_JOB_RESULT_OK : ETHOSU_JOB_RESULT_ERROR;
+
+    if (job->deferred && drv->job_timeout != 0)
+    {
+        ethosu_job_timer_stop(drv);
+    }
+
+    // Capture the PMU counters before the next job resets them
+    ethosu_pmu_capture_end(drv, job);
+    ethosu_pmu_timeline_end(drv, job);
+
+#if ETHOSU_IRQ_START_JOBS
+    // Keep the NPU busy with the next queued job. After an error the NPU must
+    // be reset first, which is done when the failed job is finished. Jobs
+    // copying to or from fast memory are left to thread context, and so is any
+    // job following one with output still to be copied out of fast memory.
+    if (job->result == ETHOSU_JOB_RESULT_OK && !ethosu_fast_memory_copies(job))
+    {
+        struct ethosu_job *next = ethosu_find_job(drv, ETHOSU_JOB_PENDING);
+
+        if (next != NULL && !ethosu_fast_memory_copies(next) && ethosu_fast_memory_resident(drv, next))
+        {
+            ethosu_start_job(drv, next);
+        }
+    }
+#endif
+
+    if (job->deferred)
+    {
+        ethosu_defer_completion(drv);
+    }
+    else
+    {
+        ethosu_semaphore_give(drv->semaphore);
+
+        // Wake up ethosu_sched_poll() waiting for any of the scheduled NPUs,
+        // counting the give for ethosu_sched_poll() to take when not blocking
+        if (drv->scheduled)
+        {
+            ethosu_semaphore_give(sched_semaphore);
+            drv->sched_given++;
+        }
+    }
+
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_IRQ_END, job->result, 0);
+}
+
+/******************************************************************************
+ * Functions API
+ ******************************************************************************/
+
+int ethosu_init(struct ethosu_driver *drv,
+                void *const base_address,
+                const void *fast_memory,
+                const size_t fast_memory_size,
+                uint32_t secure_enable,
+                uint32_t privilege_enable)
+{
+    LOG_INFO("Initializing NPU: base_address=%p, fast_memory=%p, fast_memory_size=%zu, secure=%" PRIu32
+             ", privileged=%" PRIu32,
+             base_address,
+             fast_memory,
+             fast_memory_size,
+             secure_enable,
+             privilege_enable);
+
+    if (!ethosu_mutex)
+    {
+        ethosu_mutex = ethosu_mutex_create();
+        if (!ethosu_mutex)
+        {
+            LOG_ERR("Failed to create global driver mutex");
+            return -1;
+        }
+    }
+
+    drv->fast_memory            = (uintptr_t)fast_memory;
+    drv->fast_memory_size       = fast_memory_size;
+    drv->fast_memory_high_water = 0;
+    drv->fast_memory_resident   = NULL;
+    memset(drv->fast_memory_slot, 0, sizeof(drv->fast_memory_slot));
+    memset(drv->fast_region, 0, sizeof(drv->fast_region));
+    drv->fast_region[0].address    = drv->fast_memory;
+    drv->fast_region[0].size       = fast_memory_size;
+    drv->fast_region[0].region_cfg = -1;
+    drv->weight_stage_base         = 0;
+    drv->weight_stage_size         = 0;
+    drv->weight_stage_last         = 1;
+    memset(drv->weight_stage, 0, sizeof(drv->weight_stage));
+    memset(&drv->weight_stats, 0, sizeof(drv->weight_stats));
+    drv->power_request_counter = 0;
+    drv->power_idle_timeout    = ETHOSU_POWER_IDLE_TIMEOUT;
+    drv->job_timeout           = ETHOSU_JOB_TIMEOUT;
+    drv->draining              = false;
+    drv->releasing             = false;
+    drv->power_idle            = false;
+    drv->reset_required        = true;
+    drv->pmu_capture           = NULL;
+    drv->pmu_timeline          = NULL;
+    drv->log_severity          = -1;
+    drv->optimizer_verified    = false;
+    drv->dev.log_severity      = ethosu_log_threshold;
+#if ETHOSU_TRACE_ENABLE
+    memset(&drv->trace, 0, sizeof(drv->trace));
+#endif
+    drv->pmu_cycle_overflow    = 0;
+    memset((void *)drv->pmu_event_overflow, 0, sizeof(drv->pmu_event_overflow));
+    drv->scheduled             = false;
+    drv->sched_claimed         = 0;
+    memset(&drv->power_stats, 0, sizeof(drv->power_stats));
+
+    // Initialize the device and set requested security state and privilege mode
+    if (!ethosu_dev_init(&drv->dev, base_address, secure_enable, privilege_enable))
+    {
+        DRV_LOG_ERR(drv, "Failed to initialize Ethos-U device");
+        return -1;
+    }
+
+    for (int i = 0; i < ETHOSU_MEM_ATTR_COUNT; i++)
+    {
+        drv->mem_attr[i] = ethosu_dev_get_mem_attr(&drv->dev, i);
+    }
+
+    for (int i = 0; i < ethosu_dev_axi_limit_count(); i++)
+    {
+        ethosu_dev_get_axi_limit(&drv->dev, i, &drv->axi_limit[i]);
+    }
+
+    drv->semaphore = ethosu_semaphore_create();
+    if (!drv->semaphore)
+    {
+        DRV_LOG_ERR(drv, "Failed to create driver semaphore");
+        return -1;
+    }
+
+    drv->drain_semaphore = ethosu_semaphore_create();
+    if (!drv->drain_semaphore)
+    {
+        DRV_LOG_ERR(drv, "Failed to create driver semaphore");
+        ethosu_semaphore_destroy(drv->semaphore);
+        return -1;
+    }
+
+    drv->job_mutex = ethosu_mutex_create();
+    if (!drv->job_mutex)
+    {
+        DRV_LOG_ERR(drv, "Failed to create driver job mutex");
+        ethosu_semaphore_destroy(drv->semaphore);
+        ethosu_semaphore_destroy(drv->drain_semaphore);
+        return -1;
+    }
+
+    ethosu_reset_jobs(drv);
+    ethosu_register_driver(drv);
+
+    return 0;
+}
+
+void ethosu_deinit(struct ethosu_driver *drv)
+{
+    ethosu_fast_memory_evict_all(drv);
+
+    if (drv->power_idle)
+    {
+        ethosu_power_timer_stop(drv);
+        ethosu_power_down(drv);
+    }
+
+    ethosu_deregister_driver(drv);
+    ethosu_semaphore_destroy(drv->semaphore);
+    ethosu_semaphore_destroy(drv->drain_semaphore);
+    ethosu_mutex_destroy(drv->job_mutex);
+}
+
+int ethosu_soft_reset(struct ethosu_driver *drv)
+{
+    const bool powered = drv->power_request_counter > 0 || drv->power_idle;
+
+    // Soft reset the NPU
+    if (ethosu_dev_soft_reset(&drv->dev) != ETHOSU_SUCCESS)
+    {
+        DRV_LOG_ERR(drv, "Failed to soft-reset NPU");
+        drv->reset_required = true;
+        return -1;
+    }
+
+    drv->reset_required = false;
+
+    // Update power and clock gating after the soft reset
+    ethosu_dev_set_clock_and_power(&drv->dev,
+                                   powered ? ETHOSU_CLOCK_Q_DISABLE : ETHOSU_CLOCK_Q_ENABLE,
+                                   powered ? ETHOSU_POWER_Q_DISABLE : ETHOSU_POWER_Q_ENABLE);
+
+    return 0;
+}
+
+int ethosu_request_power(struct ethosu_driver *drv)
+{
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_POWER_REQUEST, drv->power_request_counter, drv->power_idle);
+
+    // Check if this is the first power request, increase counter
+    if (drv->power_request_counter++ == 0)
+    {
+        const bool idle = drv->power_idle;
+
+        drv->power_stats.power_ups++;
+
+        if (idle)
+        {
+            ethosu_power_timer_stop(drv);
+            drv->power_idle = false;
+        }
+
+        if (!drv->reset_required)
+        {
+            // The NPU has been kept powered since the last job completed
+            // cleanly, so it is still in a known state
+            if (idle)
+            {
+                drv->power_stats.fast_path++;
+                return 0;
+            }
+
+            // The NPU is stopped in the requested security state/privilege
+            // mode without faults, so it does not need to be reset
+            if (ethosu_dev_warm_start(&drv->dev))
+            {
+                drv->power_stats.warm_starts++;
+                ethosu_dev_set_clock_and_power(&drv->dev, ETHOSU_CLOCK_Q_DISABLE, ETHOSU_POWER_Q_DISABLE);
+                return 0;
+            }
+        }
+
+        // Reset to a known state. Changes to requested
+        // security state/privilege mode if necessary.
+        if (ethosu_soft_reset(drv))
+        {
+            DRV_LOG_ERR(drv, "Failed to request power for Ethos-U");
+            drv->power_request_counter--;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void ethosu_release_power(struct ethosu_driver *drv)
+{
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_POWER_RELEASE, drv->power_request_counter, 0);
+
+    if (drv->power_request_counter == 0)
+    {
+        DRV_LOG_WARN(drv, "No power request left to release, reference counter is 0");
+    }
+    else
+    {
+        // Decrement ref counter and enable power gating if no requests remain,
+        // unless the NPU should be kept powered for the idle timeout
+        if (--drv->power_request_counter == 0)
+        {
+            drv->power_idle = drv->power_idle_timeout > 0 && !drv->reset_required;
+
+            if (!drv->power_idle || ethosu_power_timer_start(drv, drv->power_idle_timeout) < 0)
+            {
+                ethosu_power_down(drv);
+            }
+        }
+    }
+}
+
+void ethosu_set_power_idle_timeout(struct ethosu_driver *drv, uint32_t timeout_us)
+{
+    drv->power_idle_timeout = timeout_us;
+}
+
+void ethosu_power_idle_timeout(struct ethosu_driver *drv)
+{
+    if (drv->power_idle && drv->power_request_counter == 0)
+    {
+        DRV_LOG_DEBUG(drv, "NPU idle timeout, enabling power gating");
+        ethosu_power_down(drv);
+    }
+}
+
+void ethosu_get_power_stats(struct ethosu_driver *drv, struct ethosu_power_stats *stats)
+{
+    assert(stats != NULL);
+    *stats = drv->power_stats;
+}
+
+int ethosu_fast_memory_assign(struct ethosu_driver *drv, struct ethosu_network *net, int slot, size_t size)
+{
+    struct ethosu_fast_memory_slot layout[ETHOSU_FAST_MEMORY_SLOTS];
+    size_t end = 0;
+
+    assert(net != NULL);
+
+    if (!net->prepared || slot < 0 || slot >= ETHOSU_FAST_MEMORY_SLOTS)
+    {
+        DRV_LOG_ERR(drv, "Invalid fast memory assignment. prepared=%d, slot=%d", net->prepared, slot);
+        return -1;
+    }
+
+    if (ethosu_job_count(drv) > 0)
+    {
+        DRV_LOG_ERR(drv, "Fast memory layout can not be changed while jobs are queued");
+        return -1;
+    }
+
+    // Grow the slot if needed, and move the following slots. Slots start on a
+    // cache line, so that their contents can be saved independently.
+    memcpy(layout, drv->fast_memory_slot, sizeof(layout));
+    if (layout[slot].size < size)
+    {
+        layout[slot].size = size;
+    }
+
+    for (int i = 0; i < ETHOSU_FAST_MEMORY_SLOTS; i++)
+    {
+        layout[i].offset = (end + ETHOSU_CACHE_LINE_SIZE - 1) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+        end              = layout[i].offset + layout[i].size;
+    }
+
+    if (end > drv->fast_memory_size)
+    {
+        DRV_LOG_ERR(drv,
+                    "Fast memory area too small for the slots. fast_memory_size=%zu, size=%zu",
+                    drv->fast_memory_size,
+                    end);
+        return -1;
+    }
+
+    // Resident networks are saved before their slots move
+    ethosu_fast_memory_evict_all(drv);
+
+    memcpy(drv->fast_memory_slot, layout, sizeof(layout));
+    if (drv->fast_memory_high_water < end)
+    {
+        drv->fast_memory_high_water = end;
+    }
+
+    net->fast_memory_slot = slot;
+    net->fast_memory_size = size;
+
+    DRV_LOG_DEBUG(drv,
+                  "Fast memory slot %d assigned. offset=%zu, size=%zu",
+                  slot,
+                  layout[slot].offset,
+                  layout[slot].size);
+
+    return 0;
+}
+
+int ethosu_fast_memory_reset(struct ethosu_driver *drv)
+{
+    if (ethosu_job_count(drv) > 0)
+    {
+        DRV_LOG_ERR(drv, "Fast memory layout can not be changed while jobs are queued");
+        return -1;
+    }
+
+    ethosu_fast_memory_evict_all(drv);
+    memset(drv->fast_memory_slot, 0, sizeof(drv->fast_memory_slot));
+
+    return 0;
+}
+
+void ethosu_get_fast_memory_stats(struct ethosu_driver *drv, struct ethosu_fast_memory_stats *stats)
+{
+    const struct ethosu_fast_memory_slot *last = &drv->fast_memory_slot[ETHOSU_FAST_MEMORY_SLOTS - 1];
+
+    assert(stats != NULL);
+    stats->size       = drv->fast_memory_size;
+    stats->used       = last->offset + last->size;
+    stats->high_water = drv->fast_memory_high_water;
+}
+
+int ethosu_fast_memory_set_backing(struct ethosu_network *net, void *backing, size_t size)
+{
+    assert(net != NULL);
+
+    if (!net->prepared || (backing == NULL && size != 0))
+    {
+        LOG_ERR("Invalid fast memory backing buffer. prepared=%d, backing=%p, size=%zu", net->prepared, backing, size);
+        return -1;
+    }
+
+    if (net->fast_memory_owner != NULL)
+    {
+        LOG_ERR("Fast memory backing buffer can not be changed while the network is resident");
+        return -1;
+    }
+
+    net->fast_memory_backing      = backing;
+    net->fast_memory_backing_size = size;
+
+    return 0;
+}
+
+int ethosu_fast_memory_save(struct ethosu_driver *drv)
+{
+    if (ethosu_job_count(drv) > 0)
+    {
+        DRV_LOG_ERR(drv, "Fast memory can not be saved while jobs are queued");
+        return -1;
+    }
+
+    ethosu_fast_memory_evict_all(drv);
+
+    // Read-only data is loaded again on the next invoke
+    for (int r = 0; r < ETHOSU_FAST_MEMORY_REGIONS; r++)
+    {
+        drv->fast_region[r].loaded = NULL;
+        memset(drv->fast_region[r].load, 0, sizeof(drv->fast_region[r].load));
+    }
+
+    return 0;
+}
+
+int ethosu_fast_memory_add_region(
+    struct ethosu_driver *drv, const void *address, size_t size, int region_cfg, uint32_t latency)
+{
+    struct ethosu_fast_memory_region *region;
+    int r;
+
+    if (address == NULL || ((uintptr_t)address & (ETHOSU_CACHE_LINE_SIZE - 1)) != 0 || region_cfg < -1 ||
+        region_cfg > 3)
+    {
+        DRV_LOG_ERR(drv, "Invalid fast memory region. address=%p, region_cfg=%d", address, region_cfg);
+        return -1;
+    }
+
+    if (ethosu_job_count(drv) > 0)
+    {
+        DRV_LOG_ERR(drv, "Fast memory regions can not be added while jobs are queued");
+        return -1;
+    }
+
+    for (r = 1; r < ETHOSU_FAST_MEMORY_REGIONS && drv->fast_region[r].size != 0; r++)
+    {
+    }
+
+    if (r == ETHOSU_FAST_MEMORY_REGIONS)
+    {
+        DRV_LOG_ERR(drv, "No free fast memory region. max=%d", ETHOSU_FAST_MEMORY_REGIONS);
+        return -1;
+    }
+
+    region = &drv->fast_region[r];
+    memset(region, 0, sizeof(*region));
+    region->address    = (uintptr_t)address;
+    region->size       = size;
+    region->region_cfg = region_cfg;
+    region->latency    = latency;
+
+    DRV_LOG_DEBUG(drv,
+                  "Fast memory region %d added. address=%p, size=%zu, region_cfg=%d, latency=%" PRIu32,
+                  r,
+                  address,
+                  size,
+                  region_cfg,
+                  latency);
+
+    return r;
+}
+
+int ethosu_fast_memory_place(struct ethosu_network *net, uint32_t base_addr_mask)
+{
+    assert(net != NULL);
+
+    if (!net->prepared || (base_addr_mask >> ETHOSU_MAX_BASE_ADDR) != 0)
+    {
+        LOG_ERR("Invalid fast memory placement. prepared=%d, base_addr_mask=0x%" PRIx32, net->prepared, base_addr_mask);
+        return -1;
+    }
+
+    net->fast_memory_place = base_addr_mask;
+
+    return 0;
+}
+
+int ethosu_weight_staging_init(struct ethosu_driver *drv, void *buffer, size_t size, int region_cfg)
+{
+    if (((uintptr_t)buffer & (ETHOSU_CACHE_LINE_SIZE - 1)) != 0 || region_cfg < -1 || region_cfg > 3)
+    {
+        DRV_LOG_ERR(drv, "Invalid weight staging buffer. buffer=%p, region_cfg=%d", buffer, region_cfg);
+        return -1;
+    }
+
+    // The copy only overlaps NPU work when the job can be queued behind another one
+    if (buffer != NULL && ETHOSU_JOB_QUEUE_SIZE < 2)
+    {
+        DRV_LOG_ERR(drv, "Weight staging requires a job queue size of at least 2");
+        return -1;
+    }
+
+    if (ethosu_job_count(drv) > 0)
+    {
+        DRV_LOG_ERR(drv, "Weight staging can not be changed while jobs are queued");
+        return -1;
+    }
+
+    drv->weight_stage_base = (uintptr_t)buffer;
+    drv->weight_stage_size = (size / 2) & ~((size_t)ETHOSU_CACHE_LINE_SIZE - 1);
+    drv->weight_stage_cfg  = region_cfg;
+    drv->weight_stage_last = 1;
+    memset(drv->weight_stage, 0, sizeof(drv->weight_stage));
+    memset(&drv->weight_stats, 0, sizeof(drv->weight_stats));
+
+    return 0;
+}
+
+int ethosu_set_weight_staging(struct ethosu_network *net, bool enable)
+{
+    assert(net != NULL);
+
+    if (!net->prepared)
+    {
+        LOG_ERR("Network has not been prepared");
+        return -1;
+    }
+
+    net->weight_staging = enable;
+
+    return 0;
+}
+
+void ethosu_get_weight_stats(struct ethosu_driver *drv, struct ethosu_weight_stats *stats)
+{
+    assert(stats != NULL);
+    *stats = drv->weight_stats;
+}
+
+int ethosu_set_region_profile(struct ethosu_network *net, const struct ethosu_region_profile *profile)
+{
+    assert(net != NULL);
+
+    if (!net->prepared)
+    {
+        LOG_ERR("Network has not been prepared");
+        return -1;
+    }
+
+    if (profile != NULL)
+    {
+        if ((profile->region_mask >> ETHOSU_MAX_BASE_ADDR) != 0 ||
+            (profile->mem_attr_mask >> ETHOSU_MEM_ATTR_COUNT) != 0 ||
+            (profile->axi_limit_mask >> ethosu_dev_axi_limit_count()) != 0)
+        {
+            LOG_ERR("Invalid region profile. region_mask=0x%" PRIx32 ", mem_attr_mask=0x%" PRIx32
+                    ", axi_limit_mask=0x%" PRIx32,
+                    profile->region_mask,
+                    profile->mem_attr_mask,
+                    profile->axi_limit_mask);
+            return -1;
+        }
+
+        for (int i = 0; i < ethosu_dev_axi_limit_count(); i++)
+        {
+            if ((profile->axi_limit_mask & (1u << i)) != 0 &&
+                !ethosu_dev_verify_axi_limit(i, &profile->axi_limit[i]))
+            {
+                LOG_ERR("Invalid region profile. axi_limit=%d", i);
+                return -1;
+            }
+        }
+
+        for (int i = 0; i < ETHOSU_MAX_BASE_ADDR; i++)
+        {
+            if ((profile->region_mask & (1u << i)) != 0 && profile->region_cfg[i] >= ETHOSU_MEM_ATTR_COUNT)
+            {
+                LOG_ERR("Invalid region profile. index=%d, region_cfg=%u", i, profile->region_cfg[i]);
+                return -1;
+            }
+        }
+    }
+
+    net->profile = profile;
+
+    return 0;
+}
+
+int ethosu_set_network_cycles(struct ethosu_network *net, uint64_t cycles)
+{
+    assert(net != NULL);
+
+    if (!net->prepared)
+    {
+        LOG_ERR("Network has not been prepared");
+        return -1;
+    }
+
+    net->cycles = cycles;
+
+    return 0;
+}
+
+int ethosu_set_axi_limit(struct ethosu_driver *drv, int index, const struct ethosu_axi_limit *limit)
+{
+    assert(limit != NULL);
+
+    if (!ethosu_dev_verify_axi_limit(index, limit))
+    {
+        DRV_LOG_ERR(drv,
+                    "Invalid AXI limit. index=%d, max_outstanding_read=%u, max_outstanding_write=%u, max_beats=%u",
+                    index,
+                    limit->max_outstanding_read,
+                    limit->max_outstanding_write,
+                    limit->max_beats);
+        return -1;
+    }
+
+    drv->axi_limit[index] = *limit;
+
+    return 0;
+}
+
+int ethosu_get_axi_limit(struct ethosu_driver *drv, int index, struct ethosu_axi_limit *limit)
+{
+    assert(limit != NULL);
+
+    if (index < 0 || index >= ethosu_dev_axi_limit_count())
+    {
+        return -1;
+    }
+
+    *limit = drv->axi_limit[index];
+
+    return 0;
+}
+
+int ethosu_set_log_severity(int severity)
+{
+    if (severity < ETHOSU_LOG_ERR || severity > ETHOSU_LOG_DEBUG)
+    {
+        LOG_ERR("Invalid log severity. severity=%d", severity);
+        return -1;
+    }
+
+    ethosu_log_threshold = severity;
+
+    // No drivers registered before the mutex has been created
+    if (ethosu_mutex == NULL)
+    {
+        return 0;
+    }
+
+    ethosu_mutex_lock(ethosu_mutex);
+    for (struct ethosu_driver *drv = registered_drivers; drv != NULL; drv = drv->next)
+    {
+        if (drv->log_severity < 0)
+        {
+            drv->dev.log_severity = severity;
+        }
+    }
+    ethosu_mutex_unlock(ethosu_mutex);
+
+    return 0;
+}
+
+int ethosu_set_driver_log_severity(struct ethosu_driver *drv, int severity)
+{
+    if (severity < -1 || severity > ETHOSU_LOG_DEBUG)
+    {
+        DRV_LOG_ERR(drv, "Invalid log severity. severity=%d", severity);
+        return -1;
+    }
+
+    drv->log_severity     = severity;
+    drv->dev.log_severity = severity < 0 ? ethosu_log_threshold : severity;
+
+    return 0;
+}
+
+void ethosu_get_driver_version(struct ethosu_driver_version *ver)
+{
+    assert(ver != NULL);
+    ver->major = ETHOSU_DRIVER_VERSION_MAJOR;
+    ver->minor = ETHOSU_DRIVER_VERSION_MINOR;
+    ver->patch = ETHOSU_DRIVER_VERSION_PATCH;
+}
+
+void ethosu_get_hw_info(struct ethosu_driver *drv, struct ethosu_hw_info *hw)
+{
+    assert(hw != NULL);
+    ethosu_dev_get_hw_info(&drv->dev, hw);
+}
+
+int ethosu_wait(struct ethosu_driver *drv, bool block)
+{
+    struct ethosu_job *job = ethosu_job_at(drv, drv->job_head);
+    int ret                = 0;
+
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_WAIT_BEGIN, job->state, block);
+
+    switch (job->state)
+    {
+    case ETHOSU_JOB_IDLE:
+        DRV_LOG_ERR(drv, "Inference job not running...");
+        ret = -2;
+        break;
+    case ETHOSU_JOB_PENDING:
+    case ETHOSU_JOB_RUNNING:
+        if (!block)
+        {
+            // Inference still running, do not block
+            ret = 1;
+            break;
+        }
+        // fall through
+    case ETHOSU_JOB_DONE:
+        // Jobs with deferred completion are only finished by ethosu_complete_jobs()
+        if (job->deferred)
+        {
+            ret = 1;
+            break;
+        }
+
+        // Wait for interrupt in blocking mode. In non-blocking mode
+        // the interrupt has already triggered
+        if (ethosu_semaphore_take(drv->semaphore, ETHOSU_SEMAPHORE_WAIT_INFERENCE) < 0)
+        {
+            job->result = ETHOSU_JOB_RESULT_TIMEOUT;
+
+            // There's a race where the NPU interrupt can have fired between semaphore
+            // timing out and setting the result above (checked in interrupt handler).
+            // By checking if the job state has been changed (only set to DONE by interrupt
+            // handler), we know if the interrupt handler has run, if so decrement the
+            // semaphore count by one (given in interrupt handler).
+            if (job->state == ETHOSU_JOB_DONE)
+            {
+                job->result = ETHOSU_JOB_RESULT_TIMEOUT; // Reset back to timeout
+                ethosu_semaphore_take(drv->semaphore, ETHOSU_SEMAPHORE_WAIT_INFERENCE);
+            }
+            else
+            {
+                ethosu_pmu_timeline_end(drv, job);
+            }
+        }
+
+        ret = ethosu_finish_job(drv);
+
+        // Completed deferred jobs queued behind the finished job can now be finished
+        job = ethosu_job_at(drv, drv->job_head);
+        if (job->state == ETHOSU_JOB_DONE && job->deferred)
+        {
+            ethosu_defer_completion(drv);
+        }
+        break;
+
+    default:
+        DRV_LOG_ERR(drv, "Unexpected job state");
+        ethosu_dequeue_job(drv);
+        ret = -1;
+        break;
+    }
+
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_WAIT_WAKEUP, ret, 0);
+
+    // Return inference job status
+    return ret;
+}
+
+int ethosu_invoke_async(struct ethosu_driver *drv,
+                        const void *custom_data_ptr,
+                        const int custom_data_size,
+                        uint64_t *const base_addr,
+                        const size_t *base_addr_size,
+                        const int num_base_addr,
+                        void *user_arg)
+{
+    assert(custom_data_ptr != NULL);
+    assert(base_addr != NULL);
+    assert(base_addr_size != NULL);
+
+    struct opt_cfg_s const *opt_cfg;
+    struct ethosu_job *job;
+    int ret;
+
+    // The payload is parsed straight into the free job slot
+    job = ethosu_free_job(drv);
+    if (job == NULL)
+    {
+        DRV_LOG_ERR(drv, "Failed to invoke inference.");
+        return -1;
+    }
+
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_COP_PARSE_BEGIN, (uintptr_t)custom_data_ptr, custom_data_size);
+    ret = ethosu_parse_custom_data(drv, job, custom_data_ptr, custom_data_size, &opt_cfg);
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_COP_PARSE_END, ret, job->cms_length);
+
+    if (ret < 0)
+    {
+        ethosu_reset_job(job);
+    }
+
+    if (ret < 0 || ethosu_invoke_job(drv, NULL, base_addr, base_addr_size, num_base_addr, user_arg, NULL, false) < 0)
+    {
+        DRV_LOG_ERR(drv, "Failed to invoke inference.");
+        return -1;
+    }
+
+    return 0;
+}
+
+int ethosu_invoke_v3(struct ethosu_driver *drv,
+                     const void *custom_data_ptr,
+                     const int custom_data_size,
+                     uint64_t *const base_addr,
+                     const size_t *base_addr_size,
+                     const int num_base_addr,
+                     void *user_arg)
+{
+    if (ethosu_invoke_async(
+            drv, custom_data_ptr, custom_data_size, base_addr, base_addr_size, num_base_addr, user_arg) < 0)
+    {
+        return -1;
+    }
+
+    return ethosu_wait(drv, true);
+}
+
+int ethosu_prepare(struct ethosu_driver *drv,
+                   struct ethosu_network *net,
+                   const void *custom_data_ptr,
+                   const int custom_data_size)
+{
+    struct opt_cfg_s const *opt_cfg;
+    struct ethosu_job job;
+    int ret;
+
+    assert(net != NULL);
+    assert(custom_data_ptr != NULL);
+
+    memset(net, 0, sizeof(struct ethosu_network));
+    net->fast_memory_slot = ETHOSU_FAST_MEMORY_SLOT_NONE;
+
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_COP_PARSE_BEGIN, (uintptr_t)custom_data_ptr, custom_data_size);
+    ret = ethosu_parse_custom_data(drv, &job, custom_data_ptr, custom_data_size, &opt_cfg);
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_COP_PARSE_END, ret, job.cms_length);
+
+    if (ret < 0)
+    {
+        DRV_LOG_ERR(drv, "Failed to prepare network.");
+        memset(net, 0, sizeof(struct ethosu_network));
+        return -1;
+    }
+
+    net->custom_data_ptr  = job.custom_data_ptr;
+    net->custom_data_size = job.custom_data_size;
+    net->cmd_stream       = job.cmd_stream;
+    net->cms_length       = job.cms_length;
+
+    // Recorded to verify the config again when dispatched to another NPU
+    if (opt_cfg != NULL)
+    {
+        net->has_optimizer_config = true;
+        net->optimizer_cfg        = opt_cfg->cfg;
+        net->optimizer_id         = opt_cfg->id;
+    }
+
+    if (ethosu_analyze_command_stream(net->cmd_stream, net->cms_length, &net->footprint) < 0)
+    {
+        DRV_LOG_ERR(drv, "Failed to analyze command stream.");
+        memset(net, 0, sizeof(struct ethosu_network));
+        return -1;
+    }
+
+    if (net->footprint.complete)
+    {
+        ethosu_apply_footprint(net);
+    }
+    else
+    {
+        DRV_LOG_DEBUG(drv, "Command stream footprint incomplete, maintaining cache for whole regions");
+    }
+
+    net->prepared = true;
+
+    return 0;
+}
+
+int ethosu_set_region_access(
+    struct ethosu_network *net, const int index, const uint32_t access, const size_t offset, const size_t size)
+{
+    assert(net != NULL);
+
+    if (!net->prepared)
+    {
+        LOG_ERR("Network has not been prepared");
+        return -1;
+    }
+
+    if (index < 0 || index >= ETHOSU_MAX_BASE_ADDR || access > ETHOSU_REGION_ACCESS_NONE)
+    {
+        LOG_ERR("Invalid region access. index=%d, access=%" PRIu32, index, access);
+        return -1;
+    }
+
+    net->region[index].access = access;
+    net->region[index].offset = offset;
+    net->region[index].size   = size;
+
+    return 0;
+}
+
+int ethosu_invoke_prepared_async(struct ethosu_driver *drv,
+                                 struct ethosu_network *net,
+                                 uint64_t *const base_addr,
+                                 const size_t *base_addr_size,
+                                 const int num_base_addr,
+                                 void *user_arg)
+{
+    assert(net != NULL);
+    assert(base_addr != NULL);
+    assert(base_addr_size != NULL);
+
+    if (!net->prepared)
+    {
+        DRV_LOG_ERR(drv, "Network has not been prepared");
+        return -1;
+    }
+
+    if (ethosu_invoke_job(drv, net, base_addr, base_addr_size, num_base_addr, user_arg, NULL, false) < 0)
+    {
+        DRV_LOG_ERR(drv, "Failed to invoke inference.");
+        return -1;
+    }
+
+    return 0;
+}
+
+int ethosu_invoke_prepared_callback(struct ethosu_driver *drv,
+                                    struct ethosu_network *net,
+                                    uint64_t *const base_addr,
+                                    const size_t *base_addr_size,
+                                    const int num_base_addr,
+                                    void *user_arg,
+                                    ethosu_job_callback callback)
+{
+    assert(net != NULL);
+    assert(base_addr != NULL);
+    assert(base_addr_size != NULL);
+    assert(callback != NULL);
+
+    if (!net->prepared)
+    {
+        DRV_LOG_ERR(drv, "Network has not been prepared");
+        return -1;
+    }
+
+    if (ethosu_invoke_job(drv, net, base_addr, base_addr_size, num_base_addr, user_arg, callback, true) < 0)
+    {
+        DRV_LOG_ERR(drv, "Failed to invoke inference.");
+        return -1;
+    }
+
+    return 0;
+}
+
+int ethosu_complete_jobs(struct ethosu_driver *drv)
+{
+    int completed = 0;
+
+    for (;;)
+    {
+        struct ethosu_job *job = ethosu_job_at(drv, drv->job_head);
+
+        if (job->state != ETHOSU_JOB_DONE || !job->deferred)
+        {
+            break;
+        }
+
+        (void)ethosu_finish_job(drv);
+        completed++;
+    }
+
+    // Wake up ethosu_release_driver() waiting for the deferred jobs
+    if (drv->draining)
+    {
+        ethosu_semaphore_give(drv->drain_semaphore);
+    }
+
+    return completed;
+}
+
+void ethosu_set_job_timeout(struct ethosu_driver *drv, uint32_t timeout_us)
+{
+    drv->job_timeout = timeout_us;
+}
+
+void ethosu_job_timeout(struct ethosu_driver *drv)
+{
+    struct ethosu_job *job = ethosu_find_job(drv, ETHOSU_JOB_RUNNING);
+
+    if (job == NULL || !job->deferred || job->result != ETHOSU_JOB_RESULT_OK)
+    {
+        return;
+    }
+
+    DRV_LOG_DEBUG(drv, "Deferred job timed out");
+
+    job->result = ETHOSU_JOB_RESULT_TIMEOUT;
+    job->state  = ETHOSU_JOB_DONE;
+    ethosu_pmu_timeline_end(drv, job);
+
+    // Only stop the NPU here. ethosu_complete_jobs() resets it when the job
+    // is finished up, and then resumes the queued jobs.
+    ethosu_dev_stop(&drv->dev);
+
+    ethosu_defer_completion(drv);
+}
+
+int ethosu_invoke_prepared(struct ethosu_driver *drv,
+                           struct ethosu_network *net,
+                           uint64_t *const base_addr,
+                           const size_t *base_addr_size,
+                           const int num_base_addr,
+                           void *user_arg)
+{
+    if (ethosu_invoke_prepared_async(drv, net, base_addr, base_addr_size, num_base_addr, user_arg) < 0)
+    {
+        return -1;
+    }
+
+    return ethosu_wait(drv, true);
+}
+
+struct ethosu_driver *ethosu_reserve_driver(void)
+{
+    return ethosu_reserve_driver_priority(0);
+}
+
+struct ethosu_driver *ethosu_reserve_driver_priority(int priority)
+{
+    struct ethosu_reserve_waiter waiter = {priority, NULL, NULL, NULL};
+    struct ethosu_reserve_waiter **prev;
+    struct ethosu_driver *drv;
+
+    LOG_INFO("Acquiring NPU driver handle. priority=%d", priority);
+
+    ethosu_mutex_lock(ethosu_mutex);
+
+    for (drv = registered_drivers; drv != NULL; drv = drv->next)
+    {
+        if (!drv->reserved)
+        {
+            drv->reserved = true;
+            ETHOSU_TRACE(drv, ETHOSU_TRACE_RESERVE, priority, 0);
+            DRV_LOG_DEBUG(drv, "NPU driver handle %p reserved", drv);
+            ethosu_mutex_unlock(ethosu_mutex);
+            return drv;
+        }
+    }
+
+    // Reuse the semaphore of an earlier waiter, else create one. The waiter
+    // takes every give, so a reused semaphore has nothing left to take.
+    if (num_reserve_semaphores > 0)
+    {
+        waiter.semaphore = reserve_semaphores[--num_reserve_semaphores];
+    }
+    else
+    {
+        waiter.semaphore = ethosu_semaphore_create();
+    }
+
+    if (waiter.semaphore == NULL)
+    {
+        ethosu_mutex_unlock(ethosu_mutex);
+        LOG_ERR("Failed to create reservation semaphore");
+        return NULL;
+    }
+
+    // Queue behind the waiters with the same or a higher priority
+    for (prev = &reserve_waiters; *prev != NULL && (*prev)->priority >= priority; prev = &(*prev)->next)
+    {
+    }
+
+    waiter.next = *prev;
+    *prev       = &waiter;
+
+    ethosu_mutex_unlock(ethosu_mutex);
+
+    // Block until a released driver has been handed over
+    ethosu_semaphore_take(waiter.semaphore, ETHOSU_SEMAPHORE_WAIT_FOREVER);
+
+    ethosu_mutex_lock(ethosu_mutex);
+    if (num_reserve_semaphores < ETHOSU_RESERVE_SEMAPHORES)
+    {
+        reserve_semaphores[num_reserve_semaphores++] = waiter.semaphore;
+    }
+    else
+    {
+        ethosu_semaphore_destroy(waiter.semaphore);
+    }
+    ethosu_mutex_unlock(ethosu_mutex);
+
+    drv = waiter.drv;
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_RESERVE, priority, 1);
+    DRV_LOG_DEBUG(drv, "NPU driver handle %p reserved after waiting", drv);
+
+    return drv;
+}
+
+void ethosu_release_driver(struct ethosu_driver *drv)
+{
+    bool release;
+
+    if (drv == NULL)
+    {
+        return;
+    }
+
+    ethosu_mutex_lock(ethosu_mutex);
+    release = drv->reserved && !drv->releasing;
+    if (release)
+    {
+        drv->releasing = true;
+    }
+    ethosu_mutex_unlock(ethosu_mutex);
+
+    if (!release)
+    {
+        return;
+    }
+
+    // The jobs are finished without the mutex, as their callbacks and
+    // ethosu_inference_end() may reserve, invoke or release drivers. The
+    // driver stays reserved, so no other thread can queue jobs meanwhile.
+
+    // Give the queued inferences one shot to complete
+    while (ethosu_job_count(drv) > 0)
+    {
+        int ret = ethosu_wait(drv, false);
+        if (ret == 1 || ret == -2)
+        {
+            break;
+        }
+    }
+
+    if (ethosu_job_count(drv) > 0)
+    {
+        // Still running, fail the queued jobs and reset the NPU
+        ethosu_abort_jobs(drv);
+    }
+
+    ethosu_mutex_lock(ethosu_mutex);
+    drv->releasing = false;
+    drv->reserved  = false;
+    ETHOSU_TRACE(drv, ETHOSU_TRACE_RELEASE, ethosu_job_count(drv), 0);
+    DRV_LOG_DEBUG(drv, "NPU driver handle %p released", drv);
+    ethosu_reserve_handover(drv);
+    ethosu_mutex_unlock(ethosu_mutex);
+}
+
+int ethosu_sched_init(int num_drivers)
+{
+    int registered = 0;
+
+    // Waiting for more drivers than registered would block forever
+    ethosu_mutex_lock(ethosu_mutex);
+    for (struct ethosu_driver *drv = registered_drivers; drv != NULL; drv = drv->next)
+    {
+        registered++;
+    }
+    ethosu_mutex_unlock(ethosu_mutex);
+
+    if (num_drivers > registered)
+    {
+        LOG_ERR("Too few NPU drivers registered for scheduler. num_drivers=%d, registered=%d", num_drivers, registered);
+        return -1;
+    }
+
+    if (sched_semaphore == NULL)
+    {
+        sched_semaphore = ethosu_semaphore_create();
+        if (sched_semaphore == NULL)
+        {
+            LOG_ERR("Failed to create scheduler semaphore");
+            return -1;
+        }
+
+        sched_taken = 0;
+    }
+
+    for (int i = 0; i < num_drivers; i++)
+    {
+        struct ethosu_driver *drv = ethosu_reserve_driver();
+        if (drv == NULL)
+        {
+            LOG_ERR("Failed to reserve NPU driver for scheduler");
+            ethosu_sched_deinit();
+            return -1;
+        }
+
+        drv->sched_given = 0;
+        drv->scheduled   = true;
+        DRV_LOG_DEBUG(drv, "NPU driver handle %p added to scheduler", drv);
+    }
+
+    return 0;
+}
+
+void ethosu_sched_deinit(void)
+{
+    struct ethosu_driver *drv;
+
+    // Complete all outstanding jobs
+    ethosu_sched_poll(true);
+
+    while ((drv = ethosu_sched_next(NULL)) != NULL)
+    {
+        drv->scheduled = false;
+        ethosu_release_driver(drv);
+    }
+
+    if (sched_semaphore != NULL)
+    {
+        ethosu_semaphore_destroy(sched_semaphore);
+        sched_semaphore = NULL;
+    }
+}
+
+int ethosu_sched_invoke(struct ethosu_network *net,
+                        uint64_t *const base_addr,
+                        const size_t *base_addr_size,
+                        const int num_base_addr,
+                        void *user_arg,
+                        ethosu_job_callback callback)
 {
+    struct ethosu_driver *drv;
+    int ret;
+
+    assert(net != NULL);
+    assert(base_addr != NULL);
+    assert(base_addr_size != NULL);
+
+    if (!net->prepared)
+    {
+        LOG_ERR("Network has not been prepared");
+        return -1;
+    }
+
+    // Claim a queue slot, so that other threads do not select a full queue
+    ethosu_mutex_lock(ethosu_mutex);
+    drv = ethosu_sched_select(net, base_addr_size, num_base_addr);
+    if (drv != NULL)
+    {
+        drv->sched_claimed++;
+    }
+    ethosu_mutex_unlock(ethosu_mutex);
+
+    if (drv == NULL)
+    {
+        LOG_ERR("No scheduled NPU available, all job queues are full");
+        return -1;
+    }
+
+    // The job is submitted without the driver mutex, as the submit may reset
+    // the NPU, copy data and call ethosu_inference_begin()
+    DRV_LOG_DEBUG(drv, "Scheduling job on NPU driver handle %p", drv);
+    ret = ethosu_invoke_job(drv, net, base_addr, base_addr_size, num_base_addr, user_arg, callback, false);
+
     ethosu_mutex_lock(ethosu_mutex);
-    if (drv != NULL && drv->reserved)
+    drv->sched_claimed--;
+    ethosu_mutex_unlock(ethosu_mutex);
+
+    if (ret < 0)
+    {
+        DRV_LOG_ERR(drv, "Failed to invoke inference.");
+        return -1;
+    }
+
+    return 0;
+}
+
+int ethosu_sched_poll(bool block)
+{
+    int completed = 0;
+
+    for (;;)
     {
-        if (drv->job.state == ETHOSU_JOB_RUNNING || drv->job.state == ETHOSU_JOB_DONE)
+        struct ethosu_driver *running = NULL;
+        uint32_t given                = 0;
+
+        // Take the gives of the completed jobs about to be finished up, also
+        // when not blocking, so that the semaphore count does not build up.
+        // A blocking take may have taken a give before it was counted.
+        for (struct ethosu_driver *drv = ethosu_sched_next(NULL); drv != NULL; drv = ethosu_sched_next(drv))
         {
-            // Give the inference one shot to complete or force kill the job
-            if (ethosu_wait(drv, false) == 1)
+            given += drv->sched_given;
+        }
+
+        for (; (int32_t)(given - sched_taken) > 0; sched_taken++)
+        {
+            ethosu_semaphore_take(sched_semaphore, ETHOSU_SEMAPHORE_WAIT_FOREVER);
+        }
+
+        // Finish up the completed jobs of all NPUs
+        for (struct ethosu_driver *drv = ethosu_sched_next(NULL); drv != NULL; drv = ethosu_sched_next(drv))
+        {
+            while (ethosu_job_count(drv) > 0)
             {
-                // Still running, soft reset the NPU and reset driver
-                drv->power_request_counter = 0;
-                ethosu_soft_reset(drv);
-                ethosu_reset_job(drv);
+                if (ethosu_wait(drv, false) == 1)
+                {
+                    if (running == NULL && !ethosu_job_at(drv, drv->job_head)->deferred)
+                    {
+                        running = drv;
+                    }
+                    break;
+                }
+                completed++;
             }
         }
 
-        drv->reserved = false;
-        LOG_DEBUG("NPU driver handle %p released", drv);
-        ethosu_semaphore_give(ethosu_semaphore);
+        if (!block || running == NULL)
+        {
+            return completed;
+        }
+
+        // Wait for whichever NPU completes a job first. On a timeout, the
+        // timeout of the job is handled by ethosu_wait().
+        if (ethosu_semaphore_take(sched_semaphore, ETHOSU_SEMAPHORE_WAIT_INFERENCE) < 0)
+        {
+            (void)ethosu_wait(running, true);
+            completed++;
+        }
+        else
+        {
+            sched_taken++;
+        }
     }
-    ethosu_mutex_unlock(ethosu_mutex);
 }
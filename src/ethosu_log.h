@@ -22,6 +22,10 @@
  * Includes
  ******************************************************************************/
 
+#include "ethosu_log_buffer.h"
+#include "ethosu_types.h"
+
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -29,12 +33,6 @@
  * Defines
  ******************************************************************************/
 
-// Log severity levels
-#define ETHOSU_LOG_ERR 0
-#define ETHOSU_LOG_WARN 1
-#define ETHOSU_LOG_INFO 2
-#define ETHOSU_LOG_DEBUG 3
-
 // Define default log severity
 #ifndef ETHOSU_LOG_SEVERITY
 #define ETHOSU_LOG_SEVERITY ETHOSU_LOG_WARN
@@ -49,41 +47,107 @@
     if (0)                                                                                                             \
     (void)fprintf(s, "%s" f, "", ##__VA_ARGS__)
 
-#if ETHOSU_LOG_ENABLE
+#if ETHOSU_LOG_ENABLE && ETHOSU_LOG_DEFERRED
+#define LOG_COMMON(s, f, ...) ethosu_log_write((s) == stderr, f, ##__VA_ARGS__)
+#elif ETHOSU_LOG_ENABLE
 #define LOG_COMMON(s, f, ...) (void)fprintf(s, f, ##__VA_ARGS__)
 #else
 #define LOG_COMMON(s, f, ...) LOG_COMMON_NOP(s, f, ##__VA_ARGS__)
 #endif
 
-// Log formatting
-#define LOG(f, ...) LOG_COMMON(stdout, f, ##__VA_ARGS__)
+/*
+ * Messages up to ETHOSU_LOG_SEVERITY are compiled in, and are printed if their
+ * severity is within the runtime threshold. The threshold is the global
+ * ethosu_log_threshold, or the cached threshold of the device for the DEV_LOG
+ * and DRV_LOG variants.
+ */
+#define LOG_RUNTIME(t, l, s, f, ...)                                                                                   \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if ((t) >= (l))                                                                                                \
+        {                                                                                                              \
+            LOG_COMMON(s, f, ##__VA_ARGS__);                                                                           \
+        }                                                                                                              \
+    } while (0)
+
+#define LOG_RUNTIME_NOP(t, s, f, ...)                                                                                  \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        (void)(t);                                                                                                     \
+        LOG_COMMON_NOP(s, f, ##__VA_ARGS__);                                                                           \
+    } while (0)
 
-#if ETHOSU_LOG_SEVERITY >= ETHOSU_LOG_ERR
 #ifdef __FILE_NAME__
-#define LOG_ERR(f, ...) LOG_COMMON(stderr, "E: %s:%d: " f "\n", __FILE_NAME__, __LINE__, ##__VA_ARGS__)
+#define LOG_FILE_NAME __FILE_NAME__
 #else
-#define LOG_ERR(f, ...) LOG_COMMON(stderr, "E: %s:%d: " f "\n", strrchr("/" __FILE__, '/') + 1, __LINE__, ##__VA_ARGS__)
+#define LOG_FILE_NAME (strrchr("/" __FILE__, '/') + 1)
 #endif
+
+// Log formatting
+#define LOG(f, ...) LOG_COMMON(stdout, f, ##__VA_ARGS__)
+
+#if ETHOSU_LOG_SEVERITY >= ETHOSU_LOG_ERR
+#define LOG_ERR_AT(t, f, ...)                                                                                          \
+    LOG_RUNTIME(t, ETHOSU_LOG_ERR, stderr, "E: %s:%d: " f "\n", LOG_FILE_NAME, __LINE__, ##__VA_ARGS__)
 #else
-#define LOG_ERR(f, ...) LOG_COMMON_NOP(stderr, f, ##__VA_ARGS__)
+#define LOG_ERR_AT(t, f, ...) LOG_RUNTIME_NOP(t, stderr, f, ##__VA_ARGS__)
 #endif
 
 #if ETHOSU_LOG_SEVERITY >= ETHOSU_LOG_WARN
-#define LOG_WARN(f, ...) LOG_COMMON(stdout, "W: " f "\n", ##__VA_ARGS__)
+#define LOG_WARN_AT(t, f, ...) LOG_RUNTIME(t, ETHOSU_LOG_WARN, stdout, "W: " f "\n", ##__VA_ARGS__)
 #else
-#define LOG_WARN(f, ...) LOG_COMMON_NOP(stdout, f, ##__VA_ARGS__)
+#define LOG_WARN_AT(t, f, ...) LOG_RUNTIME_NOP(t, stdout, f, ##__VA_ARGS__)
 #endif
 
 #if ETHOSU_LOG_SEVERITY >= ETHOSU_LOG_INFO
-#define LOG_INFO(f, ...) LOG_COMMON(stdout, "I: " f "\n", ##__VA_ARGS__)
+#define LOG_INFO_AT(t, f, ...) LOG_RUNTIME(t, ETHOSU_LOG_INFO, stdout, "I: " f "\n", ##__VA_ARGS__)
 #else
-#define LOG_INFO(f, ...) LOG_COMMON_NOP(stdout, f, ##__VA_ARGS__)
+#define LOG_INFO_AT(t, f, ...) LOG_RUNTIME_NOP(t, stdout, f, ##__VA_ARGS__)
 #endif
 
 #if ETHOSU_LOG_SEVERITY >= ETHOSU_LOG_DEBUG
-#define LOG_DEBUG(f, ...) LOG_COMMON(stdout, "D: %s(): " f "\n", __FUNCTION__, ##__VA_ARGS__)
+#define LOG_DEBUG_AT(t, f, ...)                                                                                        \
+    LOG_RUNTIME(t, ETHOSU_LOG_DEBUG, stdout, "D: %s(): " f "\n", __FUNCTION__, ##__VA_ARGS__)
 #else
-#define LOG_DEBUG(f, ...) LOG_COMMON_NOP(stdout, f, ##__VA_ARGS__)
+#define LOG_DEBUG_AT(t, f, ...) LOG_RUNTIME_NOP(t, stdout, f, ##__VA_ARGS__)
+#endif
+
+// Log with the global threshold
+#define LOG_ERR(f, ...) LOG_ERR_AT(ethosu_log_threshold, f, ##__VA_ARGS__)
+#define LOG_WARN(f, ...) LOG_WARN_AT(ethosu_log_threshold, f, ##__VA_ARGS__)
+#define LOG_INFO(f, ...) LOG_INFO_AT(ethosu_log_threshold, f, ##__VA_ARGS__)
+#define LOG_DEBUG(f, ...) LOG_DEBUG_AT(ethosu_log_threshold, f, ##__VA_ARGS__)
+
+// Log with the threshold of a device
+#define DEV_LOG_ERR(dev, f, ...) LOG_ERR_AT((dev)->log_severity, f, ##__VA_ARGS__)
+#define DEV_LOG_WARN(dev, f, ...) LOG_WARN_AT((dev)->log_severity, f, ##__VA_ARGS__)
+#define DEV_LOG_INFO(dev, f, ...) LOG_INFO_AT((dev)->log_severity, f, ##__VA_ARGS__)
+#define DEV_LOG_DEBUG(dev, f, ...) LOG_DEBUG_AT((dev)->log_severity, f, ##__VA_ARGS__)
+
+// Log with the threshold of a driver
+#define DRV_LOG_ERR(drv, f, ...) DEV_LOG_ERR(&(drv)->dev, f, ##__VA_ARGS__)
+#define DRV_LOG_WARN(drv, f, ...) DEV_LOG_WARN(&(drv)->dev, f, ##__VA_ARGS__)
+#define DRV_LOG_INFO(drv, f, ...) DEV_LOG_INFO(&(drv)->dev, f, ##__VA_ARGS__)
+#define DRV_LOG_DEBUG(drv, f, ...) DEV_LOG_DEBUG(&(drv)->dev, f, ##__VA_ARGS__)
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+// Runtime log severity of messages logged without a device
+extern int ethosu_log_threshold;
+
+/******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+
+#if ETHOSU_LOG_ENABLE && ETHOSU_LOG_DEFERRED
+/**
+ * Store a log message in the log buffer, to be formatted later by
+ * ethosu_log_flush(). String arguments are stored as pointers and must remain
+ * valid, which holds for the string literals used by the driver.
+ */
+void ethosu_log_write(bool error, const char *format, ...) __attribute__((format(printf, 2, 3)));
 #endif
 
 #endif
@@ -0,0 +1,434 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_log.h"
+#include "ethosu_log_buffer.h"
+#include "ethosu_record_ring.h"
+
+#include <cmsis_compiler.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+enum log_length
+{
+    LOG_LENGTH_INT,
+    LOG_LENGTH_LONG,
+    LOG_LENGTH_LONG_LONG,
+    LOG_LENGTH_SIZE,
+    LOG_LENGTH_INTMAX,
+    LOG_LENGTH_PTRDIFF,
+};
+
+struct log_buffer
+{
+    volatile uint32_t head; // Number of records reserved
+    uint32_t tail;          // Number of records consumed by ethosu_log_flush()
+    struct ethosu_log_record record[ETHOSU_LOG_BUFFER_SIZE];
+};
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static struct log_buffer log_buffer;
+
+/******************************************************************************
+ * Static functions
+ ******************************************************************************/
+
+/*
+ * Parse the conversion specification starting at the '%' and return a pointer
+ * to the conversion character. A field width or precision given as '*' takes
+ * an int argument before the converted argument.
+ */
+static const char *log_parse_conversion(const char *p, enum log_length *length, uint32_t *num_stars)
+{
+    *num_stars = 0;
+
+    // Skip flags, field width and precision
+    for (p++; *p != '\0' && strchr("-+ #0123456789.*", *p) != NULL; p++)
+    {
+        *num_stars += *p == '*';
+    }
+
+    *length = LOG_LENGTH_INT;
+
+    switch (*p)
+    {
+    case 'h':
+        p += p[1] == 'h' ? 2 : 1;
+        break;
+    case 'l':
+        *length = p[1] == 'l' ? LOG_LENGTH_LONG_LONG : LOG_LENGTH_LONG;
+        p += p[1] == 'l' ? 2 : 1;
+        break;
+    case 'z':
+        *length = LOG_LENGTH_SIZE;
+        p++;
+        break;
+    case 'j':
+        *length = LOG_LENGTH_INTMAX;
+        p++;
+        break;
+    case 't':
+        *length = LOG_LENGTH_PTRDIFF;
+        p++;
+        break;
+    default:
+        break;
+    }
+
+    return p;
+}
+
+static uint64_t log_signed_arg(va_list *ap, const enum log_length length)
+{
+    switch (length)
+    {
+    case LOG_LENGTH_LONG:
+        return (uint64_t)(int64_t)va_arg(*ap, long);
+    case LOG_LENGTH_LONG_LONG:
+        return (uint64_t)va_arg(*ap, long long);
+    case LOG_LENGTH_SIZE:
+        return (uint64_t)va_arg(*ap, size_t);
+    case LOG_LENGTH_INTMAX:
+        return (uint64_t)va_arg(*ap, intmax_t);
+    case LOG_LENGTH_PTRDIFF:
+        return (uint64_t)(int64_t)va_arg(*ap, ptrdiff_t);
+    default:
+        return (uint64_t)(int64_t)va_arg(*ap, int);
+    }
+}
+
+static uint64_t log_unsigned_arg(va_list *ap, const enum log_length length)
+{
+    switch (length)
+    {
+    case LOG_LENGTH_LONG:
+        return va_arg(*ap, unsigned long);
+    case LOG_LENGTH_LONG_LONG:
+        return va_arg(*ap, unsigned long long);
+    case LOG_LENGTH_SIZE:
+        return va_arg(*ap, size_t);
+    case LOG_LENGTH_INTMAX:
+        return va_arg(*ap, uintmax_t);
+    case LOG_LENGTH_PTRDIFF:
+        return (uint64_t)va_arg(*ap, ptrdiff_t);
+    default:
+        return va_arg(*ap, unsigned int);
+    }
+}
+
+static uint64_t log_double_arg(va_list *ap)
+{
+    const double value = va_arg(*ap, double);
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    return bits;
+}
+
+/*
+ * Copy the conversion specification from the '%' to the conversion character
+ * to 'spec', with each '*' replaced by its width or precision argument.
+ * Returns false if the specification does not fit.
+ */
+static bool log_build_spec(
+    char *spec, const size_t spec_size, const char *p, const char *conversion, const uint64_t *arg)
+{
+    size_t size = 0;
+
+    for (; p <= conversion; p++)
+    {
+        int value;
+        int written;
+
+        if (*p != '*')
+        {
+            if (size + 1 >= spec_size)
+            {
+                return false;
+            }
+
+            spec[size++] = *p;
+            continue;
+        }
+
+        value = (int)*arg++;
+
+        // A negative precision is taken as if the precision were omitted
+        if (value < 0 && size > 0 && spec[size - 1] == '.')
+        {
+            size--;
+            continue;
+        }
+
+        // A negative field width is a '-' flag followed by a positive width
+        written = snprintf(&spec[size], spec_size - size, "%d", value);
+        if (written < 0 || (size_t)written >= spec_size - size)
+        {
+            return false;
+        }
+
+        size += (size_t)written;
+    }
+
+    spec[size] = '\0';
+
+    return true;
+}
+
+static void log_print_arg(
+    FILE *stream, const char *spec, const enum log_length length, const char conversion, const uint64_t arg)
+{
+    double value;
+
+    switch (conversion)
+    {
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'c':
+        switch (length)
+        {
+        case LOG_LENGTH_LONG:
+            fprintf(stream, spec, (long)arg);
+            break;
+        case LOG_LENGTH_LONG_LONG:
+            fprintf(stream, spec, (long long)arg);
+            break;
+        case LOG_LENGTH_SIZE:
+            fprintf(stream, spec, (size_t)arg);
+            break;
+        case LOG_LENGTH_INTMAX:
+            fprintf(stream, spec, (intmax_t)arg);
+            break;
+        case LOG_LENGTH_PTRDIFF:
+            fprintf(stream, spec, (ptrdiff_t)arg);
+            break;
+        default:
+            fprintf(stream, spec, (int)arg);
+            break;
+        }
+        break;
+    case 'p':
+        fprintf(stream, spec, (void *)(uintptr_t)arg);
+        break;
+    case 's':
+        fprintf(stream, spec, (const char *)(uintptr_t)arg);
+        break;
+    default:
+        memcpy(&value, &arg, sizeof(value));
+        fprintf(stream, spec, value);
+        break;
+    }
+}
+
+static void log_print(const struct ethosu_log_record *record)
+{
+    FILE *stream            = record->flags & ETHOSU_LOG_FLAG_STDERR ? stderr : stdout;
+    const uint32_t num_args = record->flags & ETHOSU_LOG_FLAG_NUM_ARGS_MASK;
+    const char *literal     = (const char *)(uintptr_t)record->format;
+    const char *p           = literal;
+    uint32_t i              = 0;
+    enum log_length length;
+    uint32_t num_stars;
+    char spec[32];
+
+    while (*p != '\0')
+    {
+        const char *conversion;
+        size_t size;
+
+        if (*p != '%')
+        {
+            p++;
+            continue;
+        }
+
+        fwrite(literal, 1, (size_t)(p - literal), stream);
+
+        conversion = log_parse_conversion(p, &length, &num_stars);
+        size       = (size_t)(conversion - p) + 1;
+
+        if (*conversion == '%')
+        {
+            fputc('%', stream);
+        }
+        else if (*conversion == '\0' || i + num_stars >= num_args ||
+                 !log_build_spec(spec, sizeof(spec), p, conversion, &record->arg[i]))
+        {
+            // Conversions without an argument are printed as they are
+            fwrite(p, 1, size - (*conversion == '\0'), stream);
+        }
+        else
+        {
+            log_print_arg(stream, spec, length, *conversion, record->arg[i + num_stars]);
+            i += num_stars + 1;
+        }
+
+        if (*conversion == '\0')
+        {
+            literal = p = conversion;
+            break;
+        }
+
+        literal = p = conversion + 1;
+    }
+
+    fwrite(literal, 1, (size_t)(p - literal), stream);
+}
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+void ethosu_log_write(bool error, const char *format, ...)
+{
+    const uint32_t sequence          = ethosu_record_ring_reserve(&log_buffer.head);
+    struct ethosu_log_record *record = &log_buffer.record[sequence % ETHOSU_LOG_BUFFER_SIZE];
+    uint32_t flags                   = error ? ETHOSU_LOG_FLAG_STDERR : 0;
+    uint32_t num_args                = 0;
+    enum log_length length;
+    uint32_t num_stars;
+    va_list ap;
+
+    // Invalidate the record while it is written
+    record->sequence = 0;
+    __DMB();
+
+    va_start(ap, format);
+
+    for (const char *p = strchr(format, '%'); p != NULL; p = strchr(p + 1, '%'))
+    {
+        p = log_parse_conversion(p, &length, &num_stars);
+
+        if (*p == '\0')
+        {
+            break;
+        }
+
+        if (*p == '%')
+        {
+            continue;
+        }
+
+        if (num_args + num_stars >= ETHOSU_LOG_MAX_ARGS)
+        {
+            flags |= ETHOSU_LOG_FLAG_TRUNCATED;
+            break;
+        }
+
+        // Field width and precision arguments
+        for (uint32_t i = 0; i < num_stars; i++)
+        {
+            record->arg[num_args++] = log_signed_arg(&ap, LOG_LENGTH_INT);
+        }
+
+        switch (*p)
+        {
+        case 'd':
+        case 'i':
+            record->arg[num_args++] = log_signed_arg(&ap, length);
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'c':
+            record->arg[num_args++] = log_unsigned_arg(&ap, length);
+            break;
+        case 'p':
+        case 's':
+            record->arg[num_args++] = (uintptr_t)va_arg(ap, const void *);
+            break;
+        default:
+            record->arg[num_args++] = log_double_arg(&ap);
+            break;
+        }
+    }
+
+    va_end(ap);
+
+    record->flags  = flags | num_args;
+    record->format = (uintptr_t)format;
+
+    __DMB();
+    record->sequence = sequence + 1;
+}
+
+uint32_t ethosu_log_flush(void)
+{
+    const uint32_t head = log_buffer.head;
+    uint32_t count      = 0;
+
+    if (head - log_buffer.tail > ETHOSU_LOG_BUFFER_SIZE)
+    {
+        fprintf(stdout, "W: %u log messages dropped\n", (unsigned)(head - log_buffer.tail - ETHOSU_LOG_BUFFER_SIZE));
+        log_buffer.tail = head - ETHOSU_LOG_BUFFER_SIZE;
+    }
+
+    for (; log_buffer.tail != head; log_buffer.tail++)
+    {
+        const struct ethosu_log_record *record = &log_buffer.record[log_buffer.tail % ETHOSU_LOG_BUFFER_SIZE];
+        const uint32_t sequence                = record->sequence;
+        struct ethosu_log_record copy;
+
+        // Stop at a record that is still being written, it is printed by the next flush
+        if (sequence == 0 || sequence < log_buffer.tail + 1)
+        {
+            break;
+        }
+
+        __DMB();
+        copy = *record;
+        __DMB();
+
+        // Skip records overwritten by newer messages
+        if (sequence != log_buffer.tail + 1 || record->sequence != sequence)
+        {
+            continue;
+        }
+
+        log_print(&copy);
+        count++;
+    }
+
+    return count;
+}
+
+uint32_t ethosu_log_read(struct ethosu_log_record *records, uint32_t max_records)
+{
+    return ethosu_record_ring_read(
+        log_buffer.record, ETHOSU_LOG_BUFFER_SIZE, log_buffer.head, sizeof(*records), records, max_records);
+}
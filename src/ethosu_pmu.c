@@ -23,11 +23,14 @@
 #include "ethosu_driver.h"
 #include "ethosu_interface.h"
 #include "ethosu_log.h"
+#include "ethosu_pmu_capture.h"
 #include "pmu_ethosu.h"
 
 #include <assert.h>
+#include <cmsis_compiler.h>
 #include <inttypes.h>
 #include <stddef.h>
+#include <string.h>
 
 /*****************************************************************************
  * Defines
@@ -36,6 +39,18 @@
 #define MASK_0_31_BITS (0xFFFFFFFF)
 #define MASK_32_47_BITS (0xFFFF00000000)
 
+#define CYCLE_CNT_BITS 48
+#define EVENT_CNT_BITS 32
+
+#if ETHOSU_PMU_NCOUNTERS > ETHOSU_PMU_MAX_COUNTERS
+#error ETHOSU_PMU_MAX_COUNTERS too small
+#endif
+
+// The start and the end of the job are always sampled
+#if ETHOSU_PMU_TIMELINE_SIZE < 2
+#error ETHOSU_PMU_TIMELINE_SIZE too small
+#endif
+
 #define COMMA ,
 #define SEMICOLON ;
 
@@ -45,12 +60,61 @@
 
 #define EVID(A, name) (PMU_EVENT_##name)
 
+// Events of the derived metrics that are named differently per NPU variant
+#if defined(ETHOSU85)
+#define PMU_AXI0_RD_DATA_BEAT ETHOSU_PMU_SRAM_RD_DATA_BEAT_RECEIVED
+#define PMU_AXI0_WR_DATA_BEAT ETHOSU_PMU_SRAM_WR_DATA_BEAT_WRITTEN
+#define PMU_AXI1_RD_DATA_BEAT ETHOSU_PMU_EXT_RD_DATA_BEAT_RECEIVED
+#define PMU_AXI1_WR_DATA_BEAT ETHOSU_PMU_EXT_WR_DATA_BEAT_WRITTEN
+#define PMU_MAC_STALLED_BY_W ETHOSU_PMU_MAC_STALLED_BY_W
+#define PMU_AXI0_RD_STALLED ETHOSU_PMU_SRAM_RD_TRAN_REQ_STALLED
+#define PMU_AXI0_WR_STALLED ETHOSU_PMU_SRAM_WR_TRAN_REQ_STALLED
+#define PMU_AXI1_RD_STALLED ETHOSU_PMU_EXT_RD_TRAN_REQ_STALLED
+#define PMU_AXI1_WR_STALLED ETHOSU_PMU_EXT_WR_TRAN_REQ_STALLED
+#else
+#define PMU_AXI0_RD_DATA_BEAT ETHOSU_PMU_AXI0_RD_DATA_BEAT_RECEIVED
+#define PMU_AXI0_WR_DATA_BEAT ETHOSU_PMU_AXI0_WR_DATA_BEAT_WRITTEN
+#define PMU_AXI1_RD_DATA_BEAT ETHOSU_PMU_AXI1_RD_DATA_BEAT_RECEIVED
+#define PMU_AXI1_WR_DATA_BEAT ETHOSU_PMU_AXI1_WR_DATA_BEAT_WRITTEN
+#define PMU_MAC_STALLED_BY_W ETHOSU_PMU_MAC_STALLED_BY_WD
+#define PMU_AXI0_RD_STALLED ETHOSU_PMU_AXI0_RD_TRAN_REQ_STALLED
+#define PMU_AXI0_WR_STALLED ETHOSU_PMU_AXI0_WR_TRAN_REQ_STALLED
+#define PMU_AXI1_RD_STALLED ETHOSU_PMU_AXI1_RD_TRAN_REQ_STALLED
+#define PMU_AXI1_WR_STALLED ETHOSU_PMU_AXI1_WR_TRAN_REQ_STALLED
+#endif
+
+/*****************************************************************************
+ * Types
+ *****************************************************************************/
+
+struct pmu_metric
+{
+    const char *name;
+    enum ethosu_pmu_event_type event; // Event counted per cycle
+    uint32_t weight;                  // Quantity per event
+};
+
 /*****************************************************************************
  * Variables
  *****************************************************************************/
 
 static const enum pmu_event eventbyid[] = {EXPAND_PMU_EVENT(EVID, COMMA)};
 
+static const struct pmu_metric pmu_metrics[ETHOSU_PMU_METRIC_COUNT] = {
+    [ETHOSU_PMU_METRIC_NPU_ACTIVE]        = {"npu_active", ETHOSU_PMU_NPU_ACTIVE, 1},
+    [ETHOSU_PMU_METRIC_MAC_UTILIZATION]   = {"mac_utilization", ETHOSU_PMU_MAC_ACTIVE, 1},
+    [ETHOSU_PMU_METRIC_AXI0_READ]         = {"axi0_read_bytes", PMU_AXI0_RD_DATA_BEAT, ETHOSU_PMU_AXI_BEAT_BYTES},
+    [ETHOSU_PMU_METRIC_AXI0_WRITE]        = {"axi0_write_bytes", PMU_AXI0_WR_DATA_BEAT, ETHOSU_PMU_AXI_BEAT_BYTES},
+    [ETHOSU_PMU_METRIC_AXI1_READ]         = {"axi1_read_bytes", PMU_AXI1_RD_DATA_BEAT, ETHOSU_PMU_AXI_BEAT_BYTES},
+    [ETHOSU_PMU_METRIC_AXI1_WRITE]        = {"axi1_write_bytes", PMU_AXI1_WR_DATA_BEAT, ETHOSU_PMU_AXI_BEAT_BYTES},
+    [ETHOSU_PMU_METRIC_STALL_BLOCKDEP]    = {"stall_blockdep", ETHOSU_PMU_CC_STALLED_ON_BLOCKDEP, 1},
+    [ETHOSU_PMU_METRIC_STALL_MAC_WEIGHTS] = {"stall_mac_weights", PMU_MAC_STALLED_BY_W, 1},
+    [ETHOSU_PMU_METRIC_STALL_MAC_ACC]     = {"stall_mac_acc", ETHOSU_PMU_MAC_STALLED_BY_ACC, 1},
+    [ETHOSU_PMU_METRIC_STALL_MAC_IFM]     = {"stall_mac_ifm", ETHOSU_PMU_MAC_STALLED_BY_IB, 1},
+    [ETHOSU_PMU_METRIC_STALL_AO_OFM]      = {"stall_ao_ofm", ETHOSU_PMU_AO_STALLED_BY_OB, 1},
+    [ETHOSU_PMU_METRIC_STALL_WD]          = {"stall_wd", ETHOSU_PMU_WD_STALLED, 1},
+};
+
 /*****************************************************************************
  * Static functions
  *****************************************************************************/
@@ -78,13 +142,146 @@ static uint32_t pmu_event_value(enum ethosu_pmu_event_type event)
     return UINT32_MAX;
 }
 
+/*
+ * Extend a counter with the overflows counted by the interrupt handler. An
+ * overflow flag not yet handled counts as one more overflow. Retry if the
+ * handler ran, or the counter wrapped, while reading.
+ */
+static uint64_t pmu_counter_total(struct ethosu_driver *drv,
+                                  volatile uint32_t *overflow,
+                                  uint32_t mask,
+                                  uint64_t (*read)(struct ethosu_driver *drv, uint32_t num),
+                                  uint32_t num,
+                                  int bits)
+{
+    uint64_t count;
+    uint64_t count2;
+    uint32_t wraps;
+    uint32_t ovs;
+
+    do
+    {
+        wraps  = *overflow;
+        count  = read(drv, num);
+        ovs    = drv->dev.reg->PMOVSSET.word & mask;
+        count2 = read(drv, num);
+    } while (wraps != *overflow || count2 < count);
+
+    if (ovs != 0)
+    {
+        wraps++;
+    }
+
+    return ((uint64_t)wraps << bits) + count2;
+}
+
+static uint64_t pmu_read_cycle_counter(struct ethosu_driver *drv, uint32_t num)
+{
+    (void)num;
+    return ((uint64_t)drv->dev.reg->PMCCNTR.CYCLE_CNT_HI << 32) | drv->dev.reg->PMCCNTR.CYCLE_CNT_LO;
+}
+
+static uint64_t pmu_read_event_counter(struct ethosu_driver *drv, uint32_t num)
+{
+    return drv->dev.reg->PMEVCNTR[num].word;
+}
+
+static inline uint32_t pmu_capture_index_next(uint32_t index)
+{
+    return (index + 1) % (2 * ETHOSU_PMU_CAPTURE_SIZE);
+}
+
+/*
+ * Look up the count per inference of an event in a profile. Returns false if
+ * the event was not counted.
+ */
+static bool pmu_profile_count(const struct ethosu_pmu_profile *profile,
+                              enum ethosu_pmu_event_type event,
+                              uint64_t *count)
+{
+    for (uint32_t n = 0; n < profile->num_events; n++)
+    {
+        if (profile->event[n] == event && profile->counted[n] > 0)
+        {
+            *count = profile->count[n] / profile->counted[n];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Find the operation the NPU is working on, that is the last operation
+ * command read before QREAD. Cycles before the first operation belong to the
+ * first operation.
+ */
+static uint32_t pmu_timeline_operation(const struct ethosu_operation *ops, uint32_t num_ops, uint32_t qread)
+{
+    uint32_t lo = 0;
+    uint32_t hi = num_ops;
+
+    // Binary search for the first operation not yet read
+    while (lo < hi)
+    {
+        const uint32_t mid = lo + (hi - lo) / 2;
+
+        if (ops[mid].offset < qread)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo > 0 ? lo - 1 : 0;
+}
+
+/*
+ * Reset and start the cycle counter, without disturbing the event counters.
+ */
+static void pmu_timeline_reset_cycle_counter(struct ethosu_driver *drv)
+{
+    struct pmcr_r pmcr;
+
+    pmcr.word               = drv->dev.reg->PMCR.word;
+    pmcr.cnt_en             = 1;
+    pmcr.cycle_cnt_rst      = 1;
+    drv->dev.reg->PMCR.word = pmcr.word;
+
+    drv->dev.reg->PMCNTENSET.word = ETHOSU_PMU_CCNT_Msk;
+    drv->dev.reg->PMINTSET.word   = ETHOSU_PMU_CCNT_Msk;
+    drv->dev.reg->PMOVSCLR.word   = ETHOSU_PMU_CCNT_Msk;
+    drv->pmu_cycle_overflow       = 0;
+}
+
+/*****************************************************************************
+ * Weak functions - PMU timeline timer
+ *****************************************************************************/
+
+int __attribute__((weak)) ethosu_pmu_timeline_timer_start(struct ethosu_driver *drv, uint32_t period_us)
+{
+    (void)drv;
+    (void)period_us;
+
+    // No timer available, only the start and the end of the job are sampled
+    return -1;
+}
+
+void __attribute__((weak)) ethosu_pmu_timeline_timer_stop(struct ethosu_driver *drv)
+{
+    (void)drv;
+}
+
 /*****************************************************************************
  * Functions
  *****************************************************************************/
 
 void ETHOSU_PMU_Enable(struct ethosu_driver *drv)
 {
-    LOG_DEBUG("Enable PMU");
+    DRV_LOG_DEBUG(drv, "Enable PMU");
     struct pmcr_r pmcr = {0};
     pmcr.cnt_en        = 1;
     ethosu_request_power(drv);
@@ -93,7 +290,7 @@ void ETHOSU_PMU_Enable(struct ethosu_driver *drv)
 
 void ETHOSU_PMU_Disable(struct ethosu_driver *drv)
 {
-    LOG_DEBUG("Disable PMU");
+    DRV_LOG_DEBUG(drv, "Disable PMU");
     drv->dev.reg->PMCR.word = 0;
     ethosu_release_power(drv);
 }
@@ -109,11 +306,11 @@ void ETHOSU_PMU_Set_EVTYPER(struct ethosu_driver *drv, uint32_t num, enum ethosu
     uint32_t val = pmu_event_value(type);
     if (val == UINT32_MAX)
     {
-        LOG_ERR("Invalid ethosu_pmu_event_type: %d", type);
+        DRV_LOG_ERR(drv, "Invalid ethosu_pmu_event_type: %d", type);
         return;
     }
 
-    LOG_DEBUG("num=%" PRIu32 ", type=%d, val=%" PRIu32, num, type, val);
+    DRV_LOG_DEBUG(drv, "num=%" PRIu32 ", type=%d, val=%" PRIu32, num, type, val);
     drv->dev.reg->PMEVTYPER[num].word = val;
 }
 
@@ -122,44 +319,53 @@ enum ethosu_pmu_event_type ETHOSU_PMU_Get_EVTYPER(struct ethosu_driver *drv, uin
     assert(num < ETHOSU_PMU_NCOUNTERS);
     uint32_t val                    = drv->dev.reg->PMEVTYPER[num].word;
     enum ethosu_pmu_event_type type = pmu_event_type(val);
-    LOG_DEBUG("num=%" PRIu32 ", type=%d, val=%" PRIu32, num, type, val);
+    DRV_LOG_DEBUG(drv, "num=%" PRIu32 ", type=%d, val=%" PRIu32, num, type, val);
     return type;
 }
 
 void ETHOSU_PMU_CYCCNT_Reset(struct ethosu_driver *drv)
 {
-    LOG_DEBUG("Reset PMU cycle counter");
+    DRV_LOG_DEBUG(drv, "Reset PMU cycle counter");
     struct pmcr_r pmcr;
     pmcr.word               = drv->dev.reg->PMCR.word;
     pmcr.cycle_cnt_rst      = 1;
     drv->dev.reg->PMCR.word = pmcr.word;
+
+    drv->dev.reg->PMOVSCLR.word = ETHOSU_PMU_CCNT_Msk;
+    drv->pmu_cycle_overflow     = 0;
 }
 
 void ETHOSU_PMU_EVCNTR_ALL_Reset(struct ethosu_driver *drv)
 {
-    LOG_DEBUG("Reset all events");
+    DRV_LOG_DEBUG(drv, "Reset all events");
     struct pmcr_r pmcr;
     pmcr.word               = drv->dev.reg->PMCR.word;
     pmcr.event_cnt_rst      = 1;
     drv->dev.reg->PMCR.word = pmcr.word;
+
+    drv->dev.reg->PMOVSCLR.word = (1u << ETHOSU_PMU_NCOUNTERS) - 1;
+    memset((void *)drv->pmu_event_overflow, 0, sizeof(drv->pmu_event_overflow));
 }
 
 void ETHOSU_PMU_CNTR_Enable(struct ethosu_driver *drv, uint32_t mask)
 {
-    LOG_DEBUG("mask=0x%08" PRIx32, mask);
+    DRV_LOG_DEBUG(drv, "mask=0x%08" PRIx32, mask);
+
+    // Interrupt on overflow, to extend the counters to 64 bits
+    drv->dev.reg->PMINTSET.word   = mask;
     drv->dev.reg->PMCNTENSET.word = mask;
 }
 
 void ETHOSU_PMU_CNTR_Disable(struct ethosu_driver *drv, uint32_t mask)
 {
-    LOG_DEBUG("mask=0x%08" PRIx32, mask);
+    DRV_LOG_DEBUG(drv, "mask=0x%08" PRIx32, mask);
     drv->dev.reg->PMCNTENCLR.word = mask;
 }
 
 uint32_t ETHOSU_PMU_CNTR_Status(struct ethosu_driver *drv)
 {
     uint32_t pmcntenset = drv->dev.reg->PMCNTENSET.word;
-    LOG_DEBUG("mask=0x%08" PRIx32, pmcntenset);
+    DRV_LOG_DEBUG(drv, "mask=0x%08" PRIx32, pmcntenset);
     return pmcntenset;
 }
 
@@ -169,7 +375,7 @@ uint64_t ETHOSU_PMU_Get_CCNTR(struct ethosu_driver *drv)
     uint32_t val_hi = drv->dev.reg->PMCCNTR.CYCLE_CNT_HI;
     uint64_t val    = ((uint64_t)val_hi << 32) | val_lo;
 
-    LOG_DEBUG("val=%" PRIu64, val);
+    DRV_LOG_DEBUG(drv, "val=%" PRIu64, val);
     return val;
 }
 
@@ -177,7 +383,7 @@ void ETHOSU_PMU_Set_CCNTR(struct ethosu_driver *drv, uint64_t val)
 {
     uint32_t active = ETHOSU_PMU_CNTR_Status(drv) & ETHOSU_PMU_CCNT_Msk;
 
-    LOG_DEBUG("val=%llu", val);
+    DRV_LOG_DEBUG(drv, "val=%" PRIu64, val);
 
     if (active)
     {
@@ -186,6 +392,7 @@ void ETHOSU_PMU_Set_CCNTR(struct ethosu_driver *drv, uint64_t val)
 
     drv->dev.reg->PMCCNTR.CYCLE_CNT_LO = val & MASK_0_31_BITS;
     drv->dev.reg->PMCCNTR.CYCLE_CNT_HI = (val & MASK_32_47_BITS) >> 32;
+    drv->pmu_cycle_overflow            = 0;
 
     if (active)
     {
@@ -197,7 +404,7 @@ uint32_t ETHOSU_PMU_Get_EVCNTR(struct ethosu_driver *drv, uint32_t num)
 {
     assert(num < ETHOSU_PMU_NCOUNTERS);
     uint32_t val = drv->dev.reg->PMEVCNTR[num].word;
-    LOG_DEBUG("num=%" PRIu32 ", val=%" PRIu32, num, val);
+    DRV_LOG_DEBUG(drv, "num=%" PRIu32 ", val=%" PRIu32, num, val);
 
     return val;
 }
@@ -205,44 +412,64 @@ uint32_t ETHOSU_PMU_Get_EVCNTR(struct ethosu_driver *drv, uint32_t num)
 void ETHOSU_PMU_Set_EVCNTR(struct ethosu_driver *drv, uint32_t num, uint32_t val)
 {
     assert(num < ETHOSU_PMU_NCOUNTERS);
-    LOG_DEBUG("num=%" PRIu32 ", val=%" PRIu32, num, val);
+    DRV_LOG_DEBUG(drv, "num=%" PRIu32 ", val=%" PRIu32, num, val);
     drv->dev.reg->PMEVCNTR[num].word = val;
+    drv->pmu_event_overflow[num]     = 0;
+}
+
+uint64_t ETHOSU_PMU_Get_CCNTR_Total(struct ethosu_driver *drv)
+{
+    uint64_t val =
+        pmu_counter_total(drv, &drv->pmu_cycle_overflow, ETHOSU_PMU_CCNT_Msk, pmu_read_cycle_counter, 0, CYCLE_CNT_BITS);
+
+    DRV_LOG_DEBUG(drv, "val=%" PRIu64, val);
+    return val;
+}
+
+uint64_t ETHOSU_PMU_Get_EVCNTR_Total(struct ethosu_driver *drv, uint32_t num)
+{
+    assert(num < ETHOSU_PMU_NCOUNTERS);
+    uint64_t val =
+        pmu_counter_total(drv, &drv->pmu_event_overflow[num], 1u << num, pmu_read_event_counter, num, EVENT_CNT_BITS);
+
+    DRV_LOG_DEBUG(drv, "num=%" PRIu32 ", val=%" PRIu64, num, val);
+    return val;
 }
 
 uint32_t ETHOSU_PMU_Get_CNTR_OVS(struct ethosu_driver *drv)
 {
-    LOG_DEBUG("");
+    DRV_LOG_DEBUG(drv, "");
     return drv->dev.reg->PMOVSSET.word;
 }
 
 void ETHOSU_PMU_Set_CNTR_OVS(struct ethosu_driver *drv, uint32_t mask)
 {
-    LOG_DEBUG("");
+    DRV_LOG_DEBUG(drv, "");
     drv->dev.reg->PMOVSCLR.word = mask;
 }
 
 void ETHOSU_PMU_Set_CNTR_IRQ_Enable(struct ethosu_driver *drv, uint32_t mask)
 {
-    LOG_DEBUG("mask=0x%08" PRIx32, mask);
+    DRV_LOG_DEBUG(drv, "mask=0x%08" PRIx32, mask);
     drv->dev.reg->PMINTSET.word = mask;
 }
 
 void ETHOSU_PMU_Set_CNTR_IRQ_Disable(struct ethosu_driver *drv, uint32_t mask)
 {
-    LOG_DEBUG("mask=0x%08" PRIx32, mask);
+    DRV_LOG_DEBUG(drv, "mask=0x%08" PRIx32, mask);
     drv->dev.reg->PMINTCLR.word = mask;
 }
 
 uint32_t ETHOSU_PMU_Get_IRQ_Enable(struct ethosu_driver *drv)
 {
     uint32_t pmint = drv->dev.reg->PMINTSET.word;
-    LOG_DEBUG("mask=0x%08" PRIx32, pmint);
+    DRV_LOG_DEBUG(drv, "mask=0x%08" PRIx32, pmint);
     return pmint;
 }
 
 void ETHOSU_PMU_CNTR_Increment(struct ethosu_driver *drv, uint32_t mask)
 {
-    LOG_DEBUG("");
+    DRV_LOG_DEBUG(drv, "");
     uint32_t cntrs_active = ETHOSU_PMU_CNTR_Status(drv);
 
     // Disable counters
@@ -271,12 +498,12 @@ void ETHOSU_PMU_CNTR_Increment(struct ethosu_driver *drv, uint32_t mask)
 
 void ETHOSU_PMU_PMCCNTR_CFG_Set_Start_Event(struct ethosu_driver *drv, enum ethosu_pmu_event_type start_event)
 {
-    LOG_DEBUG("start_event=%u", start_event);
+    DRV_LOG_DEBUG(drv, "start_event=%u", start_event);
     struct pmccntr_cfg_r cfg;
     uint32_t val = pmu_event_value(start_event);
     if (val == UINT32_MAX)
     {
-        LOG_ERR("Invalid ethosu_pmu_event_type: %d", start_event);
+        DRV_LOG_ERR(drv, "Invalid ethosu_pmu_event_type: %d", start_event);
         return;
     }
 
@@ -287,12 +514,12 @@ void ETHOSU_PMU_PMCCNTR_CFG_Set_Start_Event(struct ethosu_driver *drv, enum etho
 
 void ETHOSU_PMU_PMCCNTR_CFG_Set_Stop_Event(struct ethosu_driver *drv, enum ethosu_pmu_event_type stop_event)
 {
-    LOG_DEBUG("stop_event=%u", stop_event);
+    DRV_LOG_DEBUG(drv, "stop_event=%u", stop_event);
     struct pmccntr_cfg_r cfg;
     uint32_t val = pmu_event_value(stop_event);
     if (val == UINT32_MAX)
     {
-        LOG_ERR("Invalid ethosu_pmu_event_type: %d", stop_event);
+        DRV_LOG_ERR(drv, "Invalid ethosu_pmu_event_type: %d", stop_event);
         return;
     }
 
@@ -304,13 +531,619 @@ void ETHOSU_PMU_PMCCNTR_CFG_Set_Stop_Event(struct ethosu_driver *drv, enum ethos
 uint32_t ETHOSU_PMU_Get_QREAD(struct ethosu_driver *drv)
 {
     uint32_t val = drv->dev.reg->QREAD.word;
-    LOG_DEBUG("qread=%" PRIu32, val);
+    DRV_LOG_DEBUG(drv, "qread=%" PRIu32, val);
     return val;
 }
 
 uint32_t ETHOSU_PMU_Get_STATUS(struct ethosu_driver *drv)
 {
     uint32_t val = drv->dev.reg->STATUS.word;
-    LOG_DEBUG("status=0x%" PRIx32, val);
+    DRV_LOG_DEBUG(drv, "status=0x%" PRIx32, val);
     return val;
 }
+
+int ETHOSU_PMU_Capture_Enable(struct ethosu_driver *drv,
+                              struct ethosu_pmu_capture *capture,
+                              const enum ethosu_pmu_event_type *events,
+                              uint32_t num_events)
+{
+    if (num_events > ETHOSU_PMU_CAPTURE_MAX_EVENTS)
+    {
+        DRV_LOG_ERR(drv, "Too many PMU events: %" PRIu32 ", max=%d", num_events, ETHOSU_PMU_CAPTURE_MAX_EVENTS);
+        return -1;
+    }
+
+    if (drv->job_head != drv->job_tail)
+    {
+        DRV_LOG_ERR(drv, "PMU capture can not be enabled with jobs queued");
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < ETHOSU_PMU_CAPTURE_MAX_EVENTS; i++)
+    {
+        capture->event[i] = i < num_events ? events[i] : ETHOSU_PMU_NO_EVENT;
+        if (pmu_event_value(capture->event[i]) == UINT32_MAX)
+        {
+            DRV_LOG_ERR(drv, "Invalid ethosu_pmu_event_type: %d", capture->event[i]);
+            return -1;
+        }
+    }
+
+    // The last group is padded with ETHOSU_PMU_NO_EVENT
+    capture->num_groups = num_events > 0 ? (num_events + ETHOSU_PMU_NCOUNTERS - 1) / ETHOSU_PMU_NCOUNTERS : 1;
+    capture->group      = 0;
+    capture->active     = 0;
+    capture->sequence   = 0;
+    capture->dropped    = 0;
+    capture->head       = 0;
+    capture->tail       = 0;
+
+    DRV_LOG_DEBUG(drv, "Enable PMU capture. num_events=%" PRIu32, num_events);
+    drv->pmu_capture = capture;
+
+    return 0;
+}
+
+void ETHOSU_PMU_Capture_Disable(struct ethosu_driver *drv)
+{
+    DRV_LOG_DEBUG(drv, "Disable PMU capture");
+    drv->pmu_capture = NULL;
+}
+
+bool ETHOSU_PMU_Capture_Read(struct ethosu_pmu_capture *capture, struct ethosu_pmu_sample *sample)
+{
+    const uint32_t tail = capture->tail;
+
+    if (tail == capture->head)
+    {
+        return false;
+    }
+
+    // Read the sample after observing head, and release the slot after the read
+    __DMB();
+    *sample = capture->sample[tail % ETHOSU_PMU_CAPTURE_SIZE];
+    __DMB();
+
+    capture->tail = pmu_capture_index_next(tail);
+
+    return true;
+}
+
+void ethosu_pmu_capture_start(struct ethosu_driver *drv, struct ethosu_job *job)
+{
+    struct ethosu_pmu_capture *capture = drv->pmu_capture;
+    uint32_t mask                      = ETHOSU_PMU_CCNT_Msk;
+    struct pmcr_r pmcr                 = {0};
+    const enum ethosu_pmu_event_type *event;
+    uint32_t *group;
+
+    if (capture == NULL)
+    {
+        return;
+    }
+
+    // Rotate the event groups per prepared network, so that each network
+    // counts all groups even when several networks are run in turn
+    group           = job->network != NULL ? &job->network->pmu_group : &capture->group;
+    capture->active = (*group % capture->num_groups) * ETHOSU_PMU_NCOUNTERS;
+    *group          = (*group + 1) % capture->num_groups;
+    event           = &capture->event[capture->active];
+
+    for (int i = 0; i < ETHOSU_PMU_NCOUNTERS; i++)
+    {
+        drv->dev.reg->PMEVTYPER[i].word = pmu_event_value(event[i]);
+        if (event[i] != ETHOSU_PMU_NO_EVENT)
+        {
+            mask |= 1u << i;
+        }
+    }
+
+    drv->dev.reg->PMCNTENCLR.word = ~mask;
+    drv->dev.reg->PMCNTENSET.word = mask;
+    drv->dev.reg->PMINTSET.word   = mask;
+
+    // Reset and start all counters
+    pmcr.cnt_en             = 1;
+    pmcr.cycle_cnt_rst      = 1;
+    pmcr.event_cnt_rst      = 1;
+    drv->dev.reg->PMCR.word = pmcr.word;
+
+    drv->dev.reg->PMOVSCLR.word = UINT32_MAX;
+    drv->pmu_cycle_overflow     = 0;
+    memset((void *)drv->pmu_event_overflow, 0, sizeof(drv->pmu_event_overflow));
+}
+
+void ethosu_pmu_capture_end(struct ethosu_driver *drv, const struct ethosu_job *job)
+{
+    struct ethosu_pmu_capture *capture = drv->pmu_capture;
+    struct ethosu_pmu_sample *sample;
+    uint64_t cycles;
+    uint32_t head;
+
+    if (capture == NULL)
+    {
+        return;
+    }
+
+    cycles = ETHOSU_PMU_Get_CCNTR_Total(drv);
+
+    // Running estimate of the network cycles, used by the scheduler
+    if (job->network != NULL && job->result == ETHOSU_JOB_RESULT_OK)
+    {
+        job->network->cycles = job->network->cycles == 0 ? cycles : (3 * job->network->cycles + cycles) / 4;
+    }
+
+    head = capture->head;
+
+    // The ring is full when head has run a whole ring ahead of tail
+    if ((head + 2 * ETHOSU_PMU_CAPTURE_SIZE - capture->tail) % (2 * ETHOSU_PMU_CAPTURE_SIZE) ==
+        ETHOSU_PMU_CAPTURE_SIZE)
+    {
+        capture->sequence++;
+        capture->dropped++;
+        return;
+    }
+
+    sample                  = &capture->sample[head % ETHOSU_PMU_CAPTURE_SIZE];
+    sample->sequence        = capture->sequence++;
+    sample->result          = job->result == ETHOSU_JOB_RESULT_OK ? 0 : -1;
+    sample->custom_data_ptr = job->custom_data_ptr;
+    sample->user_arg        = job->user_arg;
+    sample->cycles          = cycles;
+
+    for (int i = 0; i < ETHOSU_PMU_NCOUNTERS; i++)
+    {
+        sample->event[i] = capture->event[capture->active + i];
+        sample->count[i] = ETHOSU_PMU_Get_EVCNTR_Total(drv, i);
+    }
+
+    // Publish the sample before advancing head
+    __DMB();
+    capture->head = pmu_capture_index_next(head);
+}
+
+uint64_t ethosu_pmu_capture_elapsed(struct ethosu_driver *drv)
+{
+    return drv->pmu_capture != NULL ? ETHOSU_PMU_Get_CCNTR_Total(drv) : 0;
+}
+
+void ethosu_pmu_handle_overflow(struct ethosu_driver *drv)
+{
+    const uint32_t ovs = drv->dev.reg->PMOVSSET.word;
+
+    if (ovs == 0)
+    {
+        return;
+    }
+
+    drv->dev.reg->PMOVSCLR.word = ovs;
+
+    if (ovs & ETHOSU_PMU_CCNT_Msk)
+    {
+        drv->pmu_cycle_overflow++;
+    }
+
+    for (int i = 0; i < ETHOSU_PMU_NCOUNTERS; i++)
+    {
+        if (ovs & (1u << i))
+        {
+            drv->pmu_event_overflow[i]++;
+        }
+    }
+}
+
+void ETHOSU_PMU_Profile_Init(struct ethosu_pmu_profile *profile, const void *custom_data_ptr)
+{
+    memset(profile, 0, sizeof(*profile));
+    profile->custom_data_ptr = custom_data_ptr;
+}
+
+void ETHOSU_PMU_Profile_Add(struct ethosu_pmu_profile *profile, const struct ethosu_pmu_sample *sample)
+{
+    if (sample->result != 0 ||
+        (profile->custom_data_ptr != NULL && profile->custom_data_ptr != sample->custom_data_ptr))
+    {
+        return;
+    }
+
+    profile->inferences++;
+    profile->cycles += sample->cycles;
+
+    for (int i = 0; i < ETHOSU_PMU_NCOUNTERS; i++)
+    {
+        uint32_t n;
+
+        if (sample->event[i] == ETHOSU_PMU_NO_EVENT)
+        {
+            continue;
+        }
+
+        for (n = 0; n < profile->num_events && profile->event[n] != sample->event[i]; n++)
+        {
+        }
+
+        if (n == profile->num_events)
+        {
+            if (n == ETHOSU_PMU_CAPTURE_MAX_EVENTS)
+            {
+                continue;
+            }
+
+            profile->event[n] = sample->event[i];
+            profile->num_events++;
+        }
+
+        profile->count[n] += sample->count[i];
+        profile->counted[n]++;
+    }
+}
+
+uint64_t ETHOSU_PMU_Profile_Get_Count(const struct ethosu_pmu_profile *profile, enum ethosu_pmu_event_type event)
+{
+    uint64_t count;
+
+    return pmu_profile_count(profile, event, &count) ? count : 0;
+}
+
+uint32_t ETHOSU_PMU_Get_Metric_Events(enum ethosu_pmu_event_type *events, uint32_t max_events)
+{
+    uint32_t num_events = 0;
+
+    for (int i = 0; i < ETHOSU_PMU_METRIC_COUNT; i++)
+    {
+        bool found = false;
+
+        for (int j = 0; j < i && !found; j++)
+        {
+            found = pmu_metrics[j].event == pmu_metrics[i].event;
+        }
+
+        if (found)
+        {
+            continue;
+        }
+
+        if (num_events < max_events)
+        {
+            events[num_events] = pmu_metrics[i].event;
+        }
+
+        num_events++;
+    }
+
+    return num_events;
+}
+
+int ETHOSU_PMU_Get_Metrics(const struct ethosu_pmu_profile *profile, struct ethosu_pmu_metrics *metrics)
+{
+    memset(metrics, 0, sizeof(*metrics));
+
+    if (profile->inferences == 0 || profile->cycles == 0)
+    {
+        LOG_ERR("PMU profile holds no cycles");
+        return -1;
+    }
+
+    metrics->cycles = profile->cycles / profile->inferences;
+
+    for (int i = 0; i < ETHOSU_PMU_METRIC_COUNT; i++)
+    {
+        const struct pmu_metric *metric = &pmu_metrics[i];
+        uint64_t count;
+        uint64_t value;
+
+        if (!pmu_profile_count(profile, metric->event, &count))
+        {
+            continue;
+        }
+
+        value = count * metric->weight * ETHOSU_PMU_METRIC_SCALE / metrics->cycles;
+
+        metrics->value[i] = value < UINT32_MAX ? (uint32_t)value : UINT32_MAX;
+        metrics->valid |= 1u << i;
+    }
+
+    return 0;
+}
+
+const char *ETHOSU_PMU_Get_Metric_Name(enum ethosu_pmu_metric metric)
+{
+    int m = metric;
+
+    if (m < 0 || m >= ETHOSU_PMU_METRIC_COUNT)
+    {
+        return NULL;
+    }
+
+    return pmu_metrics[metric].name;
+}
+
+int ETHOSU_PMU_Tune_AXI_Limits(struct ethosu_driver *drv,
+                               struct ethosu_pmu_capture *capture,
+                               struct ethosu_network *net,
+                               uint64_t *const base_addr,
+                               const size_t *base_addr_size,
+                               int num_base_addr,
+                               struct ethosu_pmu_axi_tune *tune,
+                               uint32_t num_tune,
+                               uint32_t num_runs)
+{
+    static const enum ethosu_pmu_event_type events[] = {
+        PMU_AXI0_RD_STALLED, PMU_AXI1_RD_STALLED, PMU_AXI0_WR_STALLED, PMU_AXI1_WR_STALLED};
+    const struct ethosu_region_profile *saved = net->profile;
+    const int num_limits                      = ethosu_dev_axi_limit_count();
+    struct ethosu_region_profile profile      = {0};
+    int best                                  = -1;
+
+    if (!net->prepared || drv->pmu_capture != NULL)
+    {
+        DRV_LOG_ERR(drv, "AXI limits can only be tuned for a prepared network with PMU capture disabled");
+        return -1;
+    }
+
+    if (num_runs == 0)
+    {
+        DRV_LOG_ERR(drv, "AXI limits must be tuned with at least one inference per setting");
+        return -1;
+    }
+
+    if (ETHOSU_PMU_Capture_Enable(drv, capture, events, sizeof(events) / sizeof(events[0])) != 0)
+    {
+        return -1;
+    }
+
+    // Keep the rest of the region profile of the network
+    if (saved != NULL)
+    {
+        profile = *saved;
+    }
+
+    // The network runs with the local profile until it is restored below,
+    // which is why it must not be invoked concurrently
+    profile.axi_limit_mask = (1u << num_limits) - 1;
+    net->profile           = &profile;
+
+    for (uint32_t i = 0; i < num_tune; i++)
+    {
+        struct ethosu_pmu_axi_tune *t = &tune[i];
+        bool valid                    = true;
+
+        t->result        = -1;
+        t->cycles        = 0;
+        t->read_stalled  = 0;
+        t->write_stalled = 0;
+
+        for (int j = 0; j < num_limits; j++)
+        {
+            valid = valid && ethosu_dev_verify_axi_limit(j, &t->limit[j]);
+        }
+
+        if (!valid)
+        {
+            DRV_LOG_ERR(drv, "Invalid AXI limits. tune=%" PRIu32, i);
+            continue;
+        }
+
+        memcpy(profile.axi_limit, t->limit, sizeof(profile.axi_limit));
+
+        // Sum up the runs, a setting with any failed run is skipped
+        for (uint32_t run = 0; run < num_runs; run++)
+        {
+            struct ethosu_pmu_sample sample;
+
+            if (ethosu_invoke_prepared(drv, net, base_addr, base_addr_size, num_base_addr, NULL) != 0 ||
+                !ETHOSU_PMU_Capture_Read(capture, &sample) || sample.result != 0)
+            {
+                valid = false;
+                break;
+            }
+
+            t->cycles += sample.cycles;
+
+            for (int j = 0; j < ETHOSU_PMU_NCOUNTERS; j++)
+            {
+                if (sample.event[j] == PMU_AXI0_RD_STALLED || sample.event[j] == PMU_AXI1_RD_STALLED)
+                {
+                    t->read_stalled += sample.count[j];
+                }
+                else if (sample.event[j] == PMU_AXI0_WR_STALLED || sample.event[j] == PMU_AXI1_WR_STALLED)
+                {
+                    t->write_stalled += sample.count[j];
+                }
+            }
+        }
+
+        if (!valid)
+        {
+            t->cycles        = 0;
+            t->read_stalled  = 0;
+            t->write_stalled = 0;
+            continue;
+        }
+
+        t->result         = 0;
+        t->cycles        /= num_runs;
+        t->read_stalled  /= num_runs;
+        t->write_stalled /= num_runs;
+
+        DRV_LOG_INFO(drv,
+                     "AXI limits tuned. tune=%" PRIu32 ", runs=%" PRIu32 ", cycles=%" PRIu64
+                     ", read_stalled=%" PRIu64 ", write_stalled=%" PRIu64,
+                     i,
+                     num_runs,
+                     t->cycles,
+                     t->read_stalled,
+                     t->write_stalled);
+
+        if (best < 0 || t->cycles < tune[best].cycles ||
+            (t->cycles == tune[best].cycles &&
+             t->read_stalled + t->write_stalled < tune[best].read_stalled + tune[best].write_stalled))
+        {
+            best = (int)i;
+        }
+    }
+
+    net->profile = saved;
+    ETHOSU_PMU_Capture_Disable(drv);
+
+    return best;
+}
+
+int ETHOSU_PMU_Timeline_Enable(struct ethosu_driver *drv,
+                               struct ethosu_pmu_timeline *timeline,
+                               const void *custom_data_ptr,
+                               uint32_t period_us)
+{
+    struct ethosu_pmu_timeline *current = drv->pmu_timeline;
+
+    if (current != NULL && current->state == ETHOSU_PMU_TIMELINE_RECORDING)
+    {
+        DRV_LOG_ERR(drv, "PMU timeline can not be enabled while a job is recorded");
+        return -1;
+    }
+
+    timeline->custom_data_ptr = custom_data_ptr;
+    timeline->period_us       = period_us;
+    timeline->state           = ETHOSU_PMU_TIMELINE_ARMED;
+    timeline->result          = 0;
+    timeline->cmd_stream      = NULL;
+    timeline->cms_length      = 0;
+    timeline->num_samples     = 0;
+    timeline->dropped         = 0;
+
+    DRV_LOG_DEBUG(drv, "Enable PMU timeline. period_us=%" PRIu32, period_us);
+
+    // Arm the timeline before it is seen by the interrupt handler
+    __DMB();
+    drv->pmu_timeline = timeline;
+
+    return 0;
+}
+
+void ETHOSU_PMU_Timeline_Disable(struct ethosu_driver *drv)
+{
+    struct ethosu_pmu_timeline *timeline = drv->pmu_timeline;
+
+    DRV_LOG_DEBUG(drv, "Disable PMU timeline");
+    drv->pmu_timeline = NULL;
+
+    if (timeline != NULL && timeline->state == ETHOSU_PMU_TIMELINE_RECORDING)
+    {
+        ethosu_pmu_timeline_timer_stop(drv);
+    }
+}
+
+void ETHOSU_PMU_Timeline_Sample(struct ethosu_driver *drv)
+{
+    struct ethosu_pmu_timeline *timeline = drv->pmu_timeline;
+    struct ethosu_pmu_timeline_sample *sample;
+
+    if (timeline == NULL || timeline->state != ETHOSU_PMU_TIMELINE_RECORDING)
+    {
+        return;
+    }
+
+    // Keep the last slot for the sample taken when the job completes
+    if (timeline->num_samples >= ETHOSU_PMU_TIMELINE_SIZE - 1)
+    {
+        timeline->dropped++;
+        return;
+    }
+
+    sample         = &timeline->sample[timeline->num_samples];
+    sample->qread  = drv->dev.reg->QREAD.word;
+    sample->cycles = ETHOSU_PMU_Get_CCNTR_Total(drv);
+    timeline->num_samples++;
+}
+
+int ETHOSU_PMU_Timeline_Get_Cycles(const struct ethosu_pmu_timeline *timeline,
+                                   const struct ethosu_operation *ops,
+                                   uint32_t num_ops,
+                                   uint64_t *cycles)
+{
+    if (timeline->state != ETHOSU_PMU_TIMELINE_DONE)
+    {
+        LOG_ERR("PMU timeline has not been recorded");
+        return -1;
+    }
+
+    if (num_ops == 0)
+    {
+        return 0;
+    }
+
+    memset(cycles, 0, num_ops * sizeof(uint64_t));
+
+    for (uint32_t i = 1; i < timeline->num_samples; i++)
+    {
+        const struct ethosu_pmu_timeline_sample *prev = &timeline->sample[i - 1];
+        const struct ethosu_pmu_timeline_sample *cur  = &timeline->sample[i];
+
+        cycles[pmu_timeline_operation(ops, num_ops, cur->qread)] += cur->cycles - prev->cycles;
+    }
+
+    return 0;
+}
+
+void ethosu_pmu_timeline_start(struct ethosu_driver *drv, const struct ethosu_job *job)
+{
+    struct ethosu_pmu_timeline *timeline = drv->pmu_timeline;
+
+    if (timeline == NULL || timeline->state == ETHOSU_PMU_TIMELINE_DONE)
+    {
+        return;
+    }
+
+    if (timeline->state == ETHOSU_PMU_TIMELINE_ARMED)
+    {
+        if (timeline->custom_data_ptr != NULL && timeline->custom_data_ptr != job->custom_data_ptr)
+        {
+            return;
+        }
+    }
+    else
+    {
+        // The recorded job is restarted after a reset
+        ethosu_pmu_timeline_timer_stop(drv);
+    }
+
+    pmu_timeline_reset_cycle_counter(drv);
+
+    timeline->custom_data_ptr  = job->custom_data_ptr;
+    timeline->cmd_stream       = job->cmd_stream;
+    timeline->cms_length       = job->cms_length;
+    timeline->sample[0].qread  = 0;
+    timeline->sample[0].cycles = 0;
+    timeline->num_samples      = 1;
+    timeline->dropped          = 0;
+    timeline->state            = ETHOSU_PMU_TIMELINE_RECORDING;
+
+    if (ethosu_pmu_timeline_timer_start(drv, timeline->period_us) < 0)
+    {
+        DRV_LOG_DEBUG(drv, "No PMU timeline timer, sampling the start and end of the job only");
+    }
+}
+
+void ethosu_pmu_timeline_end(struct ethosu_driver *drv, const struct ethosu_job *job)
+{
+    struct ethosu_pmu_timeline *timeline = drv->pmu_timeline;
+    struct ethosu_pmu_timeline_sample *sample;
+
+    if (timeline == NULL || timeline->state != ETHOSU_PMU_TIMELINE_RECORDING)
+    {
+        return;
+    }
+
+    ethosu_pmu_timeline_timer_stop(drv);
+
+    // A completed job has read the whole command stream
+    sample         = &timeline->sample[timeline->num_samples++];
+    sample->qread  = job->result == ETHOSU_JOB_RESULT_OK ? job->cms_length : drv->dev.reg->QREAD.word;
+    sample->cycles = ETHOSU_PMU_Get_CCNTR_Total(drv);
+
+    timeline->result = job->result == ETHOSU_JOB_RESULT_OK ? 0 : -1;
+
+    // Publish the samples before the state
+    __DMB();
+    timeline->state = ETHOSU_PMU_TIMELINE_DONE;
+}
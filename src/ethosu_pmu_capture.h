@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ETHOSU_PMU_CAPTURE_H
+#define ETHOSU_PMU_CAPTURE_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "ethosu_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+
+/**
+ * Program the PMU before a job is started, if the automatic capture is enabled.
+ * Selects the next event group of the job's network.
+ */
+void ethosu_pmu_capture_start(struct ethosu_driver *drv, struct ethosu_job *job);
+
+/**
+ * Store the PMU counters of a completed job in the capture ring, if the
+ * automatic capture is enabled. Called from the interrupt handler.
+ */
+void ethosu_pmu_capture_end(struct ethosu_driver *drv, const struct ethosu_job *job);
+
+/**
+ * Get the number of cycles the running job has executed for, if the automatic
+ * capture is enabled, else 0.
+ */
+uint64_t ethosu_pmu_capture_elapsed(struct ethosu_driver *drv);
+
+/**
+ * Count the PMU counter overflows, extending the counters to 64 bits. Called
+ * from the interrupt handler.
+ */
+void ethosu_pmu_handle_overflow(struct ethosu_driver *drv);
+
+/**
+ * Take the first timeline sample and start the sampling timer, if the PMU
+ * timeline is armed for the job. A job restarted after a reset is recorded
+ * again from the beginning.
+ */
+void ethosu_pmu_timeline_start(struct ethosu_driver *drv, const struct ethosu_job *job);
+
+/**
+ * Stop the sampling timer and take the last timeline sample, if the job is
+ * being recorded. Called from the interrupt handler, or when waiting for the
+ * job timed out.
+ */
+void ethosu_pmu_timeline_end(struct ethosu_driver *drv, const struct ethosu_job *job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ETHOSU_PMU_CAPTURE_H
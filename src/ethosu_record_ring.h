@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ETHOSU_RECORD_RING_H
+#define ETHOSU_RECORD_RING_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include <cmsis_compiler.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+/*
+ * Reserve the next record of a ring by incrementing 'head', returning the
+ * record number. Armv6-M has no exclusive access instructions, and an atomic
+ * increment would be a call to a library function that is not provided, so
+ * interrupts are masked around the increment instead. That is only safe
+ * between the contexts of a single core.
+ */
+static inline uint32_t ethosu_record_ring_reserve(volatile uint32_t *head)
+{
+    uint32_t sequence;
+
+#if defined(__ARM_ARCH_6M__) && __ARM_ARCH_6M__
+    const uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    sequence = (*head)++;
+    __set_PRIMASK(primask);
+#elif defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+    do
+    {
+        sequence = __LDREXW(head);
+    } while (__STREXW(sequence + 1, head) != 0);
+#else
+    sequence = __atomic_fetch_add(head, 1, __ATOMIC_RELAXED);
+#endif
+
+    return sequence;
+}
+
+/*
+ * Copy the latest records of a ring, oldest first. Writers reserve a record
+ * by incrementing 'head', and each record starts with a volatile uint32_t
+ * holding the record number plus one, or 0 while the record is written.
+ * Records being written, or overwritten while they are copied, are skipped.
+ */
+static inline uint32_t ethosu_record_ring_read(const void *ring,
+                                               const uint32_t ring_size,
+                                               const uint32_t head,
+                                               const size_t record_size,
+                                               void *records,
+                                               const uint32_t max_records)
+{
+    uint32_t sequence = head > ring_size ? head - ring_size : 0;
+    uint32_t count    = 0;
+
+    if (head - sequence > max_records)
+    {
+        sequence = head - max_records;
+    }
+
+    for (; sequence != head; sequence++)
+    {
+        const uint8_t *record                    = (const uint8_t *)ring + (sequence % ring_size) * record_size;
+        const volatile uint32_t *record_sequence = (const volatile uint32_t *)record;
+
+        if (*record_sequence != sequence + 1)
+        {
+            continue;
+        }
+
+        __DMB();
+        memcpy((uint8_t *)records + count * record_size, record, record_size);
+        __DMB();
+
+        if (*record_sequence == sequence + 1)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+#endif // ETHOSU_RECORD_RING_H
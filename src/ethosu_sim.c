@@ -0,0 +1,786 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_sim.h"
+
+#include "ethosu_driver.h"
+#include "ethosu_interface.h"
+#include "ethosu_log.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#if defined(ETHOSU55)
+#define SIM_PRODUCT 0
+#define SIM_ADDRESS_BITS 32
+#elif defined(ETHOSU65)
+#define SIM_PRODUCT 1
+#define SIM_ADDRESS_BITS 40
+#else
+#define SIM_PRODUCT 2
+#define SIM_ADDRESS_BITS 40
+#endif
+
+// Written to RESET after a reset has been handled, so that the next write is detected
+#define SIM_RESET_IDLE 0xFFFFFFFF
+
+#define SIM_CYCLE_CNT_MASK 0xFFFFFFFFFFFFull
+#define SIM_PMCNTEN_CYCLE_CNT (1U << 31)
+
+#define NSEC_PER_USEC 1000ull
+#define NSEC_PER_SEC 1000000000ull
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+struct ethosu_sim
+{
+    struct NPU_REG reg; // Must be first, the register map base address
+    struct ethosu_sim_config config;
+    struct ethosu_driver *drv;
+    pthread_t thread;
+    volatile bool thread_running;
+    volatile uint32_t latency_us;
+    volatile enum ethosu_sim_fault fault;
+    bool job_running;
+    uint64_t job_start;
+    uint64_t job_deadline;
+    uint32_t job_latency_us;
+    uint64_t job_cycles; // Cycles of the running job counted so far
+    uint32_t pmcntenset; // Last seen PMCNTENSET, to tell driver writes from the register value
+    uint32_t pmintset;   // Last seen PMINTSET
+    uint64_t job_timer;  // Expiry of the driver job timer in nanoseconds, 0 if stopped
+    struct ethosu_sim_stats stats;
+};
+
+struct ethosu_sim_semaphore
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    unsigned int count;
+};
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+// Simulator whose thread is currently running the driver interrupt handler
+static __thread struct ethosu_sim *sim_irq_context;
+
+/******************************************************************************
+ * Static functions
+ ******************************************************************************/
+
+static uint64_t sim_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Atomically clear bits that the driver writes as one-shot commands, returning
+ * the bits that were set.
+ */
+static uint32_t sim_take_bits(volatile uint32_t *word, const uint32_t mask)
+{
+    uint32_t old = __atomic_load_n(word, __ATOMIC_SEQ_CST);
+
+    while ((old & mask) != 0 &&
+           !__atomic_compare_exchange_n(word, &old, old & ~mask, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+    }
+
+    return old & mask;
+}
+
+static void sim_reset(struct ethosu_sim *sim, const uint32_t word)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+    struct reset_r reset;
+    struct prot_r prot;
+
+    reset.word = word;
+
+    prot.word       = 0;
+    prot.active_CPL = reset.pending_CPL;
+    prot.active_CSL = reset.pending_CSL;
+
+    sim->job_running = false;
+
+    reg->STATUS.word = 0;
+    reg->QREAD.word  = 0;
+    reg->PROT.word   = prot.word;
+    reg->RESET.word  = SIM_RESET_IDLE;
+
+    sim->stats.resets++;
+}
+
+/*
+ * Apply the driver writes to a write one to set register and its write one to
+ * clear counterpart. The set register is plain memory, so a write replaces the
+ * enabled bits instead of adding to them. Any value differing from the last
+ * seen value is taken as a write and added to it. Writes to the clear register
+ * are applied first, since the driver disables counters before enabling them.
+ */
+static void sim_set_clear(volatile uint32_t *set, volatile uint32_t *clr, uint32_t *last)
+{
+    uint32_t old   = __atomic_load_n(set, __ATOMIC_SEQ_CST);
+    uint32_t clear = sim_take_bits(clr, UINT32_MAX);
+    uint32_t word  = (*last & ~clear) | (old != *last ? old : 0);
+
+    // A new write to the set register is picked up by the next poll
+    if (__atomic_compare_exchange_n(set, &old, word, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    {
+        *last = word;
+    }
+    else
+    {
+        *last &= ~clear;
+    }
+}
+
+static void sim_pmu_update(struct ethosu_sim *sim)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+    struct pmcr_r pmcr;
+    uint32_t clear;
+
+    pmcr.word = reg->PMCR.word;
+
+    if (pmcr.cycle_cnt_rst || pmcr.event_cnt_rst)
+    {
+        struct pmcr_r reset_bits;
+
+        if (pmcr.cycle_cnt_rst)
+        {
+            reg->PMCCNTR.word[0] = 0;
+            reg->PMCCNTR.word[1] = 0;
+        }
+
+        if (pmcr.event_cnt_rst)
+        {
+            for (int i = 0; i < NPU_REG_PMEVCNTR_ARRLEN; i++)
+            {
+                reg->PMEVCNTR[i].word = 0;
+            }
+        }
+
+        reset_bits.word          = 0;
+        reset_bits.cycle_cnt_rst = 1;
+        reset_bits.event_cnt_rst = 1;
+        (void)sim_take_bits(&reg->PMCR.word, reset_bits.word);
+    }
+
+    sim_set_clear(&reg->PMCNTENSET.word, &reg->PMCNTENCLR.word, &sim->pmcntenset);
+    sim_set_clear(&reg->PMINTSET.word, &reg->PMINTCLR.word, &sim->pmintset);
+
+    // Overflow flags are only set by the simulator
+    clear = sim_take_bits(&reg->PMOVSCLR.word, UINT32_MAX);
+    if (clear != 0)
+    {
+        __atomic_fetch_and(&reg->PMOVSSET.word, ~clear, __ATOMIC_SEQ_CST);
+    }
+}
+
+/*
+ * Advance the cycle counter, and the event counters counting cycles, by a
+ * number of NPU cycles.
+ */
+static void sim_pmu_count(struct ethosu_sim *sim, const uint64_t cycles)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+    const uint32_t enabled       = reg->PMCNTENSET.word;
+
+    if (!reg->PMCR.cnt_en)
+    {
+        return;
+    }
+
+    if (enabled & SIM_PMCNTEN_CYCLE_CNT)
+    {
+        uint64_t cycle_cnt = ((uint64_t)reg->PMCCNTR.word[1] << 32) | reg->PMCCNTR.word[0];
+
+        cycle_cnt += cycles;
+        if (cycle_cnt > SIM_CYCLE_CNT_MASK)
+        {
+            __atomic_fetch_or(&reg->PMOVSSET.word, SIM_PMCNTEN_CYCLE_CNT, __ATOMIC_SEQ_CST);
+        }
+
+        reg->PMCCNTR.word[0] = (uint32_t)cycle_cnt;
+        reg->PMCCNTR.word[1] = (uint32_t)((cycle_cnt & SIM_CYCLE_CNT_MASK) >> 32);
+    }
+
+    for (int i = 0; i < NPU_REG_PMEVCNTR_ARRLEN; i++)
+    {
+        const uint32_t type = reg->PMEVTYPER[i].EV_TYPE;
+        uint64_t count;
+
+        if ((enabled & (1U << i)) == 0 || (type != PMU_EVENT_CYCLE && type != PMU_EVENT_NPU_ACTIVE))
+        {
+            continue;
+        }
+
+        count = (uint64_t)reg->PMEVCNTR[i].word + cycles;
+        if (count > UINT32_MAX)
+        {
+            __atomic_fetch_or(&reg->PMOVSSET.word, 1U << i, __ATOMIC_SEQ_CST);
+        }
+
+        reg->PMEVCNTR[i].word = (uint32_t)count;
+    }
+}
+
+static void sim_start(struct ethosu_sim *sim, const uint64_t now)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+    struct status_r status;
+
+    // Writing to CMD while running has no effect
+    if (sim->job_running)
+    {
+        return;
+    }
+
+    status.word            = reg->STATUS.word;
+    status.state           = 1;
+    status.cmd_end_reached = 0;
+    reg->STATUS.word       = status.word;
+    reg->QREAD.word        = 0;
+
+    sim->job_running    = true;
+    sim->job_latency_us = sim->latency_us;
+    sim->job_start      = now;
+    sim->job_deadline   = now + sim->job_latency_us * NSEC_PER_USEC;
+    sim->job_cycles     = 0;
+
+    sim->stats.started++;
+}
+
+/*
+ * Take the one-shot command bits written to CMD.
+ */
+static uint32_t sim_take_command(struct ethosu_sim *sim)
+{
+    struct cmd_r cmd;
+
+    cmd.word                        = 0;
+    cmd.transition_to_running_state = 1;
+    cmd.clear_irq                   = 1;
+    cmd.stop_request                = 1;
+
+    return sim_take_bits(&sim->reg.CMD.word, cmd.word);
+}
+
+static void sim_command(struct ethosu_sim *sim, const uint32_t word, const uint64_t now)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+    struct cmd_r cmd;
+
+    cmd.word = word;
+
+    if (cmd.clear_irq)
+    {
+        struct status_r status;
+
+        status.word           = reg->STATUS.word;
+        status.irq_raised     = 0;
+        status.pmu_irq_raised = 0;
+        reg->STATUS.word      = status.word;
+    }
+
+    // A hung NPU does not stop, it must be reset
+    if (cmd.stop_request && sim->job_running && sim->fault != ETHOSU_SIM_FAULT_HANG)
+    {
+        struct status_r status;
+
+        status.word      = reg->STATUS.word;
+        status.state     = 0;
+        reg->STATUS.word = status.word;
+        sim->job_running = false;
+        sim->stats.stopped++;
+    }
+
+    if (cmd.transition_to_running_state)
+    {
+        sim_start(sim, now);
+    }
+}
+
+/*
+ * Count the cycles elapsed since the job was started, so that the counters
+ * can be sampled while the job is running.
+ */
+static void sim_pmu_progress(struct ethosu_sim *sim, const uint64_t now)
+{
+    const uint64_t total = (uint64_t)sim->job_latency_us * sim->config.cycles_per_us;
+    uint64_t cycles      = (now - sim->job_start) * sim->config.cycles_per_us / NSEC_PER_USEC;
+
+    if (cycles > total)
+    {
+        cycles = total;
+    }
+
+    if (cycles > sim->job_cycles)
+    {
+        sim_pmu_count(sim, cycles - sim->job_cycles);
+        sim->job_cycles = cycles;
+    }
+}
+
+/*
+ * Raise a PMU interrupt for a counter that overflowed while the job is
+ * running. The interrupt stays raised until the driver clears it.
+ */
+static void sim_pmu_interrupt(struct ethosu_sim *sim)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+    struct status_r status;
+
+    status.word = reg->STATUS.word;
+    if (status.irq_raised || (reg->PMOVSSET.word & reg->PMINTSET.word) == 0)
+    {
+        return;
+    }
+
+    status.irq_raised     = 1;
+    status.pmu_irq_raised = 1;
+    reg->STATUS.word      = status.word;
+    sim->stats.pmu_irqs++;
+
+    sim_irq_context = sim;
+    ethosu_irq_handler(sim->drv);
+    sim_irq_context = NULL;
+}
+
+static void sim_complete(struct ethosu_sim *sim)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+    struct status_r status;
+    uint64_t start;
+
+    status.word       = reg->STATUS.word;
+    status.state      = 0;
+    status.irq_raised = 1;
+
+    if (sim->fault == ETHOSU_SIM_FAULT_BUS_ERROR)
+    {
+        status.bus_status = 1;
+    }
+    else
+    {
+        status.cmd_end_reached = 1;
+        reg->QREAD.word        = reg->QSIZE.word;
+    }
+
+    sim_pmu_count(sim, (uint64_t)sim->job_latency_us * sim->config.cycles_per_us - sim->job_cycles);
+
+    if (reg->PMOVSSET.word & reg->PMINTSET.word)
+    {
+        status.pmu_irq_raised = 1;
+    }
+
+    reg->STATUS.word = status.word;
+    sim->job_running = false;
+    sim->stats.completed++;
+
+    start           = sim_time_ns();
+    sim_irq_context = sim;
+    ethosu_irq_handler(sim->drv);
+    sim_irq_context           = NULL;
+    sim->stats.irq_handler_ns = sim_time_ns() - start;
+
+    __atomic_add_fetch(&sim->stats.irq_handled, 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Apply the driver writes to RESET and CMD.
+ */
+static void sim_writes(struct ethosu_sim *sim, const uint64_t now)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+
+    // Take the commands before looking at RESET. The driver starts the NPU
+    // after resetting it, so commands seen together with a reset were written
+    // after the reset.
+    const uint32_t cmd   = sim_take_command(sim);
+    const uint32_t reset = __atomic_load_n(&reg->RESET.word, __ATOMIC_SEQ_CST);
+
+    if (reset != SIM_RESET_IDLE)
+    {
+        sim_reset(sim, reset);
+    }
+
+    sim_pmu_update(sim);
+    sim_command(sim, cmd, now);
+}
+
+static void sim_timeout(struct ethosu_sim *sim)
+{
+    __atomic_store_n(&sim->job_timer, 0, __ATOMIC_SEQ_CST);
+
+    sim_irq_context = sim;
+    ethosu_job_timeout(sim->drv);
+    sim_irq_context = NULL;
+}
+
+static void sim_poll(struct ethosu_sim *sim)
+{
+    volatile struct NPU_REG *reg = &sim->reg;
+    const uint64_t now           = sim_time_ns();
+
+    sim_writes(sim, now);
+
+    // The job timer runs in the simulator thread, like the interrupt handler
+    const uint64_t timer = __atomic_load_n(&sim->job_timer, __ATOMIC_SEQ_CST);
+    if (timer != 0 && now >= timer)
+    {
+        sim_timeout(sim);
+        return;
+    }
+
+    if (!sim->job_running)
+    {
+        return;
+    }
+
+    if (sim->fault == ETHOSU_SIM_FAULT_HANG || now < sim->job_deadline)
+    {
+        // Progress through the command stream in proportion to the elapsed time
+        if (sim->job_deadline > sim->job_start)
+        {
+            uint64_t qread = (uint64_t)reg->QSIZE.word * (now - sim->job_start) / (sim->job_deadline - sim->job_start);
+            reg->QREAD.word = (uint32_t)(qread < reg->QSIZE.word ? qread : reg->QSIZE.word) & ~3U;
+        }
+
+        sim_pmu_progress(sim, now);
+        sim_pmu_interrupt(sim);
+
+        return;
+    }
+
+    sim_complete(sim);
+}
+
+static void *sim_thread(void *arg)
+{
+    struct ethosu_sim *sim = arg;
+
+    while (sim->thread_running)
+    {
+        sim_poll(sim);
+        sched_yield();
+    }
+
+    return NULL;
+}
+
+/******************************************************************************
+ * Driver hooks
+ *
+ * Mutexes and semaphores backed by pthreads, since the interrupt handler is
+ * called from the simulator thread. Semaphore timeouts are in microseconds.
+ * The job timer expires in the simulator thread.
+ ******************************************************************************/
+
+uint64_t ethosu_address_remap(uint64_t address, int index)
+{
+    // Command streams are not executed, the upper bits are never needed
+    (void)index;
+    return address & ((1ull << SIM_ADDRESS_BITS) - 1);
+}
+
+#if ETHOSU_TRACE_ENABLE
+uint64_t ethosu_trace_timestamp(void)
+{
+    // Trace timestamps in nanoseconds
+    return sim_time_ns();
+}
+#endif
+
+void *ethosu_mutex_create(void)
+{
+    pthread_mutex_t *mutex = malloc(sizeof(*mutex));
+
+    if (mutex != NULL && pthread_mutex_init(mutex, NULL) != 0)
+    {
+        free(mutex);
+        return NULL;
+    }
+
+    return mutex;
+}
+
+void ethosu_mutex_destroy(void *mutex)
+{
+    pthread_mutex_destroy(mutex);
+    free(mutex);
+}
+
+int ethosu_mutex_lock(void *mutex)
+{
+    return pthread_mutex_lock(mutex) == 0 ? 0 : -1;
+}
+
+int ethosu_mutex_unlock(void *mutex)
+{
+    return pthread_mutex_unlock(mutex) == 0 ? 0 : -1;
+}
+
+void *ethosu_semaphore_create(void)
+{
+    struct ethosu_sim_semaphore *sem = calloc(1, sizeof(*sem));
+
+    if (sem == NULL)
+    {
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&sem->mutex, NULL) != 0 || pthread_cond_init(&sem->cond, NULL) != 0)
+    {
+        free(sem);
+        return NULL;
+    }
+
+    return sem;
+}
+
+void ethosu_semaphore_destroy(void *sem)
+{
+    struct ethosu_sim_semaphore *s = sem;
+
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->mutex);
+    free(s);
+}
+
+int ethosu_semaphore_take(void *sem, uint64_t timeout)
+{
+    struct ethosu_sim_semaphore *s = sem;
+    struct timespec deadline;
+    int ret = 0;
+
+    if (timeout != ETHOSU_SEMAPHORE_WAIT_FOREVER)
+    {
+        uint64_t ns;
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        ns                = (uint64_t)deadline.tv_nsec + timeout * NSEC_PER_USEC;
+        deadline.tv_sec  += (time_t)(ns / NSEC_PER_SEC);
+        deadline.tv_nsec  = (long)(ns % NSEC_PER_SEC);
+    }
+
+    pthread_mutex_lock(&s->mutex);
+
+    while (s->count == 0 && ret == 0)
+    {
+        if (timeout == ETHOSU_SEMAPHORE_WAIT_FOREVER)
+        {
+            pthread_cond_wait(&s->cond, &s->mutex);
+        }
+        else if (pthread_cond_timedwait(&s->cond, &s->mutex, &deadline) == ETIMEDOUT)
+        {
+            ret = -1;
+        }
+    }
+
+    if (ret == 0)
+    {
+        s->count--;
+    }
+
+    pthread_mutex_unlock(&s->mutex);
+
+    return ret;
+}
+
+int ethosu_semaphore_give(void *sem)
+{
+    struct ethosu_sim_semaphore *s = sem;
+
+    // The woken up driver may rewrite CMD right away, so take the commands
+    // written by the interrupt handler before they can be lost
+    if (sim_irq_context != NULL)
+    {
+        sim_writes(sim_irq_context, sim_time_ns());
+    }
+
+    pthread_mutex_lock(&s->mutex);
+    s->count++;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+
+    return 0;
+}
+
+int ethosu_job_timer_start(struct ethosu_driver *drv, uint32_t timeout_us)
+{
+    // The register map is the first member of the simulator
+    struct ethosu_sim *sim = (struct ethosu_sim *)(uintptr_t)drv->dev.reg;
+
+    __atomic_store_n(&sim->job_timer, sim_time_ns() + timeout_us * NSEC_PER_USEC, __ATOMIC_SEQ_CST);
+
+    return 0;
+}
+
+void ethosu_job_timer_stop(struct ethosu_driver *drv)
+{
+    struct ethosu_sim *sim = (struct ethosu_sim *)(uintptr_t)drv->dev.reg;
+
+    __atomic_store_n(&sim->job_timer, 0, __ATOMIC_SEQ_CST);
+}
+
+/******************************************************************************
+ * API functions
+ ******************************************************************************/
+
+struct ethosu_sim *ethosu_sim_create(const struct ethosu_sim_config *config)
+{
+    struct ethosu_sim *sim;
+    struct config_r cfg;
+    struct id_r id;
+    struct prot_r prot;
+
+    assert(config != NULL);
+
+    sim = calloc(1, sizeof(*sim));
+    if (sim == NULL)
+    {
+        LOG_ERR("Failed to allocate simulator");
+        return NULL;
+    }
+
+    sim->config     = *config;
+    sim->latency_us = config->latency_us;
+    sim->fault      = ETHOSU_SIM_FAULT_NONE;
+
+    cfg.word = config->config;
+    if (cfg.word == 0)
+    {
+        cfg.product = SIM_PRODUCT;
+        for (uint32_t macs = ETHOSU_MACS; macs > 1; macs >>= 1)
+        {
+            cfg.macs_per_cc++;
+        }
+    }
+
+    id.word = config->id;
+    if (id.word == 0)
+    {
+        id.arch_major_rev = NNX_ARCH_VERSION_MAJOR;
+        id.arch_minor_rev = NNX_ARCH_VERSION_MINOR;
+        id.arch_patch_rev = NNX_ARCH_VERSION_PATCH;
+    }
+
+    prot.word       = 0;
+    prot.active_CPL = config->privileged ? PRIVILEGE_LEVEL_PRIVILEGED : PRIVILEGE_LEVEL_USER;
+    prot.active_CSL = config->secure ? SECURITY_LEVEL_SECURE : SECURITY_LEVEL_NON_SECURE;
+
+    sim->reg.CONFIG.word = cfg.word;
+    sim->reg.ID.word     = id.word;
+    sim->reg.PROT.word   = prot.word;
+    sim->reg.RESET.word  = SIM_RESET_IDLE;
+
+    return sim;
+}
+
+void ethosu_sim_destroy(struct ethosu_sim *sim)
+{
+    assert(sim != NULL);
+
+    if (sim->thread_running)
+    {
+        sim->thread_running = false;
+        pthread_join(sim->thread, NULL);
+    }
+
+    free(sim);
+}
+
+void *ethosu_sim_base_address(struct ethosu_sim *sim)
+{
+    assert(sim != NULL);
+
+    return &sim->reg;
+}
+
+int ethosu_sim_start(struct ethosu_sim *sim, struct ethosu_driver *drv)
+{
+    assert(sim != NULL);
+    assert(drv != NULL);
+
+    if (sim->thread_running)
+    {
+        LOG_ERR("Simulator already started");
+        return -1;
+    }
+
+    sim->drv            = drv;
+    sim->thread_running = true;
+
+    if (pthread_create(&sim->thread, NULL, sim_thread, sim) != 0)
+    {
+        LOG_ERR("Failed to create simulator thread");
+        sim->thread_running = false;
+        return -1;
+    }
+
+    return 0;
+}
+
+void ethosu_sim_set_latency(struct ethosu_sim *sim, uint32_t latency_us)
+{
+    assert(sim != NULL);
+
+    sim->latency_us = latency_us;
+}
+
+void ethosu_sim_set_fault(struct ethosu_sim *sim, enum ethosu_sim_fault fault)
+{
+    assert(sim != NULL);
+
+    sim->fault = fault;
+}
+
+void ethosu_sim_get_stats(struct ethosu_sim *sim, struct ethosu_sim_stats *stats)
+{
+    assert(sim != NULL);
+    assert(stats != NULL);
+
+    // Pairs with the release in sim_complete(), so irq_handler_ns is at least as new as irq_handled
+    const uint32_t irq_handled = __atomic_load_n(&sim->stats.irq_handled, __ATOMIC_ACQUIRE);
+
+    *stats             = sim->stats;
+    stats->irq_handled = irq_handled;
+}
@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_record_ring.h"
+#include "ethosu_trace.h"
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Weak functions - Trace timestamp
+ ******************************************************************************/
+
+uint64_t __attribute__((weak)) ethosu_trace_timestamp(void)
+{
+    return 0;
+}
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+uint32_t ethosu_trace_read(struct ethosu_driver *drv, struct ethosu_trace_record *records, uint32_t max_records)
+{
+    return ethosu_record_ring_read(
+        drv->trace.record, ETHOSU_TRACE_SIZE, drv->trace.head, sizeof(*records), records, max_records);
+}
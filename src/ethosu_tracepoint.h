@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ETHOSU_TRACEPOINT_H
+#define ETHOSU_TRACEPOINT_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_record_ring.h"
+#include "ethosu_trace.h"
+
+#include <cmsis_compiler.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#if ETHOSU_TRACE_ENABLE
+#define ETHOSU_TRACE(drv, event, arg0, arg1)                                                                           \
+    ethosu_trace_write(&(drv)->trace, (drv), (event), (uint64_t)(arg0), (uint64_t)(arg1))
+#else
+#define ETHOSU_TRACE(drv, event, arg0, arg1)                                                                           \
+    do                                                                                                                 \
+    {                                                                                                                  \
+    } while (0)
+#endif
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+#if ETHOSU_TRACE_ENABLE
+static inline void ethosu_trace_write(struct ethosu_trace *trace,
+                                      const struct ethosu_driver *drv,
+                                      const enum ethosu_trace_event event,
+                                      const uint64_t arg0,
+                                      const uint64_t arg1)
+{
+    const uint32_t sequence            = ethosu_record_ring_reserve(&trace->head);
+    struct ethosu_trace_record *record = &trace->record[sequence % ETHOSU_TRACE_SIZE];
+
+    // Invalidate the record while it is written
+    record->sequence = 0;
+    __DMB();
+
+    record->event     = event;
+    record->timestamp = ethosu_trace_timestamp();
+    record->drv       = (uintptr_t)drv;
+    record->arg[0]    = arg0;
+    record->arg[1]    = arg1;
+
+    __DMB();
+    record->sequence = sequence + 1;
+}
+#endif
+
+#endif // ETHOSU_TRACEPOINT_H
@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ETHOSU_HOST_CMSIS_COMPILER_H
+#define ETHOSU_HOST_CMSIS_COMPILER_H
+
+/*
+ * Host replacement for the CMSIS intrinsics used by the driver, when it is
+ * built with ETHOSU_HOST_SIM.
+ */
+
+#include <sched.h>
+
+#define __WFE() ((void)sched_yield())
+#define __SEV() ((void)0)
+#define __DMB() __sync_synchronize()
+
+#endif // ETHOSU_HOST_CMSIS_COMPILER_H
@@ -0,0 +1,312 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Unit test of the command stream analyzer. The command streams are built by
+ * hand, so the expected footprints can be computed from the register values.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_cmd_analyzer.h"
+#include "ethosu_interface.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define TEST_MAX_CMS_WORDS 64
+
+#define CMD_CONTROL_SHIFT 14
+#define CMD_PARAM_SHIFT 16
+#define FM_FORMAT_SHIFT 6
+#define DMA_STRIDE_MODE_SHIFT 9
+#define DMA_IDX_MODE_SHIFT 11
+
+#define CHECK(cond)                                                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond);                                            \
+            return -1;                                                                                                 \
+        }                                                                                                              \
+    } while (0)
+
+#define CHECK_RANGE(range, expected_offset, expected_size)                                                             \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        CHECK((range).offset == (expected_offset));                                                                    \
+        CHECK((range).size == (expected_size));                                                                        \
+    } while (0)
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+struct cms
+{
+    uint32_t words[TEST_MAX_CMS_WORDS];
+    uint32_t num_words;
+};
+
+/******************************************************************************
+ * Static functions
+ ******************************************************************************/
+
+static void cms_cmd0(struct cms *cms, const uint32_t opcode, const uint32_t param)
+{
+    cms->words[cms->num_words++] = opcode | (CMD_CTRL_CMD0_CTRL << CMD_CONTROL_SHIFT) | (param << CMD_PARAM_SHIFT);
+}
+
+static void cms_cmd1(struct cms *cms, const uint32_t opcode, const uint32_t value)
+{
+    cms->words[cms->num_words++] = opcode | (CMD_CTRL_CMD1_CTRL << CMD_CONTROL_SHIFT);
+    cms->words[cms->num_words++] = value;
+}
+
+static int cms_analyze(struct cms *cms, struct ethosu_footprint *footprint)
+{
+    cms_cmd0(cms, CMD0_OPCODE_NPU_OP_STOP, 0xffff);
+
+    return ethosu_analyze_command_stream((const uint8_t *)cms->words, cms->num_words * sizeof(uint32_t), footprint);
+}
+
+/*
+ * Program a 1x1 pooling of a 'height' x 'width' x 'depth' NHWC IFM in
+ * region 1 at offset 0x100.
+ */
+static void cms_ifm_nhwc(struct cms *cms, const uint32_t height, const uint32_t width, const uint32_t depth)
+{
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_IFM_REGION, 1);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_IFM_PRECISION, ACTIVATION_FORMAT_NHWC << FM_FORMAT_SHIFT);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_IFM_DEPTH_M1, depth - 1);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_IFM_WIDTH0_M1, width - 1);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_IFM_HEIGHT0_M1, height - 1);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_IFM_HEIGHT1_M1, height - 1);
+    cms_cmd1(cms, CMD1_OPCODE_NPU_SET_IFM_BASE0, 0x100);
+    cms_cmd1(cms, CMD1_OPCODE_NPU_SET_IFM_STRIDE_X, depth);
+    cms_cmd1(cms, CMD1_OPCODE_NPU_SET_IFM_STRIDE_Y, width * depth);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_KERNEL_WIDTH_M1, 0);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_KERNEL_HEIGHT_M1, 0);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_KERNEL_STRIDE, 0);
+}
+
+static void cms_ofm_shape(struct cms *cms, const uint32_t height, const uint32_t width, const uint32_t depth)
+{
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_OFM_REGION, 2);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_OFM_HEIGHT_M1, height - 1);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_OFM_WIDTH_M1, width - 1);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_OFM_DEPTH_M1, depth - 1);
+}
+
+static void cms_dma(struct cms *cms, const uint32_t src_region, const uint32_t dst_region)
+{
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_DMA0_SRC_REGION, src_region);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_SET_DMA0_DST_REGION, dst_region);
+    cms_cmd1(cms, CMD1_OPCODE_NPU_SET_DMA0_SRC, 0x40);
+    cms_cmd1(cms, CMD1_OPCODE_NPU_SET_DMA0_DST, 0x80);
+    cms_cmd1(cms, CMD1_OPCODE_NPU_SET_DMA0_LEN, 16);
+    cms_cmd0(cms, CMD0_OPCODE_NPU_OP_DMA_START, 0);
+}
+
+static int test_nhwc(void)
+{
+    struct ethosu_footprint footprint;
+    struct cms cms = {0};
+
+    // 2x4x8 IFM and OFM in a single tile
+    cms_ifm_nhwc(&cms, 2, 4, 8);
+    cms_ofm_shape(&cms, 2, 4, 8);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_OFM_PRECISION, ACTIVATION_FORMAT_NHWC << FM_FORMAT_SHIFT);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_OFM_WIDTH0_M1, 3);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_OFM_HEIGHT0_M1, 1);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_OFM_HEIGHT1_M1, 1);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_BASE0, 0x200);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_STRIDE_X, 8);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_STRIDE_Y, 32);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_OP_POOL, 0);
+
+    CHECK(cms_analyze(&cms, &footprint) == 0);
+    CHECK(footprint.complete);
+
+    // (rows - 1) * stride_y + (cols - 1) * stride_x + depth
+    CHECK_RANGE(footprint.read[1], 0x100, 1 * 32 + 3 * 8 + 8);
+    CHECK_RANGE(footprint.write[2], 0x200, 1 * 32 + 3 * 8 + 8);
+    CHECK_RANGE(footprint.read[2], 0, 0);
+    CHECK_RANGE(footprint.write[1], 0, 0);
+
+    return 0;
+}
+
+static int test_nhcwb16_tiles(void)
+{
+    struct ethosu_footprint footprint;
+    struct cms cms = {0};
+
+    /*
+     * 2x4x20 OFM in two bricks of 16 channels, stride_c = 4 * 16. Tile 0 is
+     * 1x2, tile 1 2x2 and tile 2 1x2.
+     */
+    cms_ifm_nhwc(&cms, 2, 4, 20);
+    cms_ofm_shape(&cms, 2, 4, 20);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_OFM_PRECISION, ACTIVATION_FORMAT_NHCWB16 << FM_FORMAT_SHIFT);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_OFM_WIDTH0_M1, 1);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_OFM_HEIGHT0_M1, 0);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_OFM_HEIGHT1_M1, 1);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_BASE0, 0x0000);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_BASE1, 0x1000);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_BASE2, 0x2000);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_BASE3, 0x3000);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_STRIDE_X, 16);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_STRIDE_Y, 128);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_OFM_STRIDE_C, 64);
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_OP_POOL, 0);
+
+    CHECK(cms_analyze(&cms, &footprint) == 0);
+    CHECK(footprint.complete);
+    CHECK_RANGE(footprint.read[1], 0x100, 1 * 80 + 3 * 20 + 20);
+
+    // Tile 2 is 1x2 and ends at 0x2000 + (2 - 1) * stride_x + stride_c + 16, tile 3 is empty
+    CHECK_RANGE(footprint.write[2], 0, 0x2000 + 16 + 64 + 16);
+
+    return 0;
+}
+
+static int test_dma(void)
+{
+    struct ethosu_footprint footprint;
+    struct cms cms = {0};
+
+    cms_dma(&cms, 1, 2);
+
+    CHECK(cms_analyze(&cms, &footprint) == 0);
+    CHECK(footprint.complete);
+    CHECK_RANGE(footprint.read[1], 0x40, 16);
+    CHECK_RANGE(footprint.write[2], 0x80, 16);
+
+    return 0;
+}
+
+#if defined(ETHOSU65) || defined(ETHOSU85)
+static int test_dma_strided(void)
+{
+    struct ethosu_footprint footprint;
+    struct cms cms = {0};
+
+    cms_dma(&cms, 1 | (DMA_STRIDE_MODE_D2 << DMA_STRIDE_MODE_SHIFT), 2);
+
+    CHECK(cms_analyze(&cms, &footprint) == 0);
+    CHECK(footprint.complete);
+    CHECK_RANGE(footprint.read[1], 0, SIZE_MAX);
+    CHECK_RANGE(footprint.write[2], 0, SIZE_MAX);
+    CHECK_RANGE(footprint.read[0], 0, 0);
+
+    return 0;
+}
+#endif
+
+#if defined(ETHOSU85)
+static int test_dma_indexed(void)
+{
+    struct ethosu_footprint footprint;
+    struct cms cms = {0};
+
+    cms_cmd0(&cms, CMD0_OPCODE_NPU_SET_DMA0_IDX_REGION, 3);
+    cms_dma(&cms, 1 | (DMA_IDX_MODE_ENABLED << DMA_IDX_MODE_SHIFT), 2);
+
+    CHECK(cms_analyze(&cms, &footprint) == 0);
+    CHECK(footprint.complete);
+    CHECK_RANGE(footprint.read[1], 0, SIZE_MAX);
+    CHECK_RANGE(footprint.read[3], 0, SIZE_MAX);
+    CHECK_RANGE(footprint.write[2], 0, SIZE_MAX);
+
+    return 0;
+}
+
+static int test_branch(void)
+{
+    struct ethosu_footprint footprint;
+    struct cms cms = {0};
+
+    cms_dma(&cms, 1, 2);
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_OP_BRANCH, 0);
+    cms_dma(&cms, 3, 4);
+
+    CHECK(cms_analyze(&cms, &footprint) == 0);
+    CHECK(!footprint.complete);
+    CHECK_RANGE(footprint.read[1], 0, 0);
+    CHECK_RANGE(footprint.write[2], 0, 0);
+
+    return 0;
+}
+#endif
+
+static int test_truncated(void)
+{
+    struct ethosu_footprint footprint;
+    struct cms cms = {0};
+
+    cms_cmd1(&cms, CMD1_OPCODE_NPU_SET_DMA0_LEN, 16);
+
+    // Drop the payload of the last command
+    CHECK(ethosu_analyze_command_stream((const uint8_t *)cms.words, sizeof(uint32_t), &footprint) < 0);
+
+    return 0;
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(void)
+{
+    static const struct
+    {
+        const char *name;
+        int (*func)(void);
+    } tests[] = {
+        {"nhwc", test_nhwc},
+        {"nhcwb16_tiles", test_nhcwb16_tiles},
+        {"dma", test_dma},
+#if defined(ETHOSU65) || defined(ETHOSU85)
+        {"dma_strided", test_dma_strided},
+#endif
+#if defined(ETHOSU85)
+        {"dma_indexed", test_dma_indexed},
+        {"branch", test_branch},
+#endif
+        {"truncated", test_truncated},
+    };
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+    {
+        const int ret = tests[i].func();
+
+        printf("%-16s %s\n", tests[i].name, ret == 0 ? "PASS" : "FAIL");
+        failed += ret != 0;
+    }
+
+    return failed == 0 ? 0 : 1;
+}
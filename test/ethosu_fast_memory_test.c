@@ -0,0 +1,257 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test of fast memory residency. Two networks with backing buffers share a
+ * fast memory slot. Invoking the resident network again must copy nothing,
+ * while switching networks must save the contents of the resident network
+ * and restore the other one. The copies must be made by the thread invoking
+ * the jobs, never by the interrupt handler.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_sim.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define TEST_COP_FOURCC ('1' << 24 | 'P' << 16 | 'O' << 8 | 'C')
+#define TEST_COP_COMMAND_STREAM 2
+#define TEST_CMS_WORDS 4
+
+#define TEST_LATENCY_US 2000
+#define TEST_BACKING_SIZE 64
+
+#define CHECK(cond)                                                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond);                                            \
+            return -1;                                                                                                 \
+        }                                                                                                              \
+    } while (0)
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+// The command stream after the two word header must be 16 byte aligned
+static uint32_t custom_data_buf[4 + TEST_CMS_WORDS] __attribute__((aligned(16)));
+static uint32_t *const custom_data = &custom_data_buf[2];
+static uint8_t region[2][256] __attribute__((aligned(16)));
+static uint8_t fast_memory[1024] __attribute__((aligned(32)));
+
+static struct ethosu_network net_a;
+static struct ethosu_network net_b;
+static uint8_t backing_a[TEST_BACKING_SIZE];
+static uint8_t backing_b[TEST_BACKING_SIZE];
+
+static pthread_t main_thread;
+static int copies;
+static int copies_elsewhere;
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+void ethosu_fast_memory_copy(struct ethosu_driver *drv, void *dst, const void *src, size_t size)
+{
+    (void)drv;
+
+    if (!pthread_equal(pthread_self(), main_thread))
+    {
+        copies_elsewhere++;
+    }
+
+    copies++;
+    memcpy(dst, src, size);
+}
+
+static int test_invoke_async(struct ethosu_driver *drv, struct ethosu_network *net)
+{
+    // Base address 2 is placed in fast memory
+    uint64_t base_addr[3]     = {(uintptr_t)region[0], (uintptr_t)region[1], 0};
+    const size_t base_size[3] = {sizeof(region[0]), sizeof(region[1]), TEST_BACKING_SIZE};
+
+    return ethosu_invoke_prepared_async(drv, net, base_addr, base_size, 3, NULL);
+}
+
+static int test_invoke(struct ethosu_driver *drv, struct ethosu_network *net)
+{
+    if (test_invoke_async(drv, net) < 0)
+    {
+        return -1;
+    }
+
+    return ethosu_wait(drv, true);
+}
+
+static int test_resident(struct ethosu_driver *drv)
+{
+    // The first invocation restores the contents from the backing buffer
+    CHECK(test_invoke(drv, &net_a) == 0);
+    CHECK(copies == 1);
+    CHECK(net_a.fast_memory_owner == drv);
+    CHECK(fast_memory[0] == 0xa0);
+
+    // The network updates its state, which stays in fast memory
+    fast_memory[0] = 0xa1;
+    CHECK(test_invoke(drv, &net_a) == 0);
+    CHECK(test_invoke(drv, &net_a) == 0);
+    CHECK(copies == 1);
+    CHECK(backing_a[0] == 0xa0);
+
+    return 0;
+}
+
+static int test_switch(struct ethosu_driver *drv)
+{
+    const int start = copies;
+
+    // Saves the state of the first network, and restores the second one
+    CHECK(test_invoke(drv, &net_b) == 0);
+    CHECK(copies == start + 2);
+    CHECK(backing_a[0] == 0xa1);
+    CHECK(fast_memory[0] == 0xb0);
+    CHECK(net_a.fast_memory_owner == NULL);
+    CHECK(net_b.fast_memory_owner == drv);
+
+    CHECK(test_invoke(drv, &net_a) == 0);
+    CHECK(copies == start + 4);
+    CHECK(fast_memory[0] == 0xa1);
+
+    return 0;
+}
+
+static int test_switch_queued(struct ethosu_driver *drv)
+{
+    const int start = copies;
+
+    // The switch is made when the queued job is started
+    CHECK(test_invoke_async(drv, &net_a) == 0);
+    CHECK(test_invoke_async(drv, &net_b) == 0);
+    CHECK(ethosu_wait(drv, true) == 0);
+    CHECK(ethosu_wait(drv, true) == 0);
+    CHECK(copies == start + 2);
+    CHECK(net_b.fast_memory_owner == drv);
+
+    return 0;
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(void)
+{
+    const struct ethosu_sim_config config = {.latency_us = TEST_LATENCY_US, .cycles_per_us = 100};
+    const int custom_data_size            = (2 + TEST_CMS_WORDS) * sizeof(uint32_t);
+    static struct ethosu_driver drv;
+    struct ethosu_sim *sim;
+    int ret = 0;
+
+    main_thread = pthread_self();
+
+    sim = ethosu_sim_create(&config);
+    if (sim == NULL ||
+        ethosu_init(&drv, ethosu_sim_base_address(sim), fast_memory, sizeof(fast_memory), 0, 0) < 0 ||
+        ethosu_sim_start(sim, &drv) < 0)
+    {
+        printf("Failed to initialize NPU\n");
+        return 1;
+    }
+
+    custom_data[0] = TEST_COP_FOURCC;
+    custom_data[1] = TEST_COP_COMMAND_STREAM | TEST_CMS_WORDS << 16;
+
+    // The simulator does not execute the command stream, zero words are NPU_OP_STOP
+    memset(&custom_data[2], 0, TEST_CMS_WORDS * sizeof(uint32_t));
+
+    memset(backing_a, 0xa0, sizeof(backing_a));
+    memset(backing_b, 0xb0, sizeof(backing_b));
+
+    if (ethosu_prepare(&drv, &net_a, custom_data, custom_data_size) < 0 ||
+        ethosu_prepare(&drv, &net_b, custom_data, custom_data_size) < 0 ||
+        ethosu_fast_memory_assign(&drv, &net_a, 0, TEST_BACKING_SIZE) < 0 ||
+        ethosu_fast_memory_assign(&drv, &net_b, 0, TEST_BACKING_SIZE) < 0 ||
+        ethosu_fast_memory_set_backing(&net_a, backing_a, sizeof(backing_a)) < 0 ||
+        ethosu_fast_memory_set_backing(&net_b, backing_b, sizeof(backing_b)) < 0)
+    {
+        printf("Failed to set up fast memory\n");
+        return 1;
+    }
+
+    if (test_resident(&drv) != 0)
+    {
+        printf("%-16s %s\n", "resident", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "resident", "PASS");
+    }
+
+    if (test_switch(&drv) != 0)
+    {
+        printf("%-16s %s\n", "switch", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "switch", "PASS");
+    }
+
+    if (ETHOSU_JOB_QUEUE_SIZE < 2)
+    {
+        printf("%-16s %s\n", "switch_queued", "SKIP, requires ETHOSU_JOB_QUEUE_SIZE >= 2");
+    }
+    else if (test_switch_queued(&drv) != 0)
+    {
+        printf("%-16s %s\n", "switch_queued", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "switch_queued", "PASS");
+    }
+
+    if (copies_elsewhere != 0)
+    {
+        printf("%-16s %s\n", "copy_context", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "copy_context", "PASS");
+    }
+
+    ethosu_deinit(&drv);
+    ethosu_sim_destroy(sim);
+
+    return ret;
+}
@@ -0,0 +1,221 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test of the job queue. Queued jobs must be started and finished up in
+ * submission order, a full queue must reject another job, and releasing a
+ * driver must fail the jobs that have not completed, in submission order.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_sim.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define TEST_COP_FOURCC ('1' << 24 | 'P' << 16 | 'O' << 8 | 'C')
+#define TEST_COP_COMMAND_STREAM 2
+#define TEST_CMS_WORDS 4
+
+#define TEST_LATENCY_US 20000
+
+#define CHECK(cond)                                                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond);                                            \
+            return -1;                                                                                                 \
+        }                                                                                                              \
+    } while (0)
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+// The command stream after the two word header must be 16 byte aligned
+static uint32_t custom_data_buf[4 + TEST_CMS_WORDS] __attribute__((aligned(16)));
+static uint32_t *const custom_data = &custom_data_buf[2];
+static uint8_t region[256] __attribute__((aligned(16)));
+static struct ethosu_network net;
+
+static uintptr_t begun[ETHOSU_JOB_QUEUE_SIZE];
+static int num_begun;
+static uintptr_t completed[ETHOSU_JOB_QUEUE_SIZE];
+static int results[ETHOSU_JOB_QUEUE_SIZE];
+static int num_completed;
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+void ethosu_inference_begin(struct ethosu_driver *drv, void *user_arg)
+{
+    (void)drv;
+
+    if (num_begun < ETHOSU_JOB_QUEUE_SIZE)
+    {
+        begun[num_begun++] = (uintptr_t)user_arg;
+    }
+}
+
+static void test_callback(struct ethosu_driver *drv, int result, void *user_arg)
+{
+    (void)drv;
+
+    if (num_completed < ETHOSU_JOB_QUEUE_SIZE)
+    {
+        completed[num_completed] = (uintptr_t)user_arg;
+        results[num_completed++] = result;
+    }
+}
+
+static void test_reset(void)
+{
+    num_begun     = 0;
+    num_completed = 0;
+}
+
+static int test_queue_order(struct ethosu_driver *drv)
+{
+    uint64_t base_addr[1]     = {(uintptr_t)region};
+    const size_t base_size[1] = {sizeof(region)};
+
+    test_reset();
+
+    for (uintptr_t i = 0; i < ETHOSU_JOB_QUEUE_SIZE; i++)
+    {
+        CHECK(ethosu_invoke_prepared_async(drv, &net, base_addr, base_size, 1, (void *)(i + 1)) == 0);
+    }
+
+    // The queue is full
+    CHECK(ethosu_invoke_prepared_async(drv, &net, base_addr, base_size, 1, NULL) < 0);
+
+    for (int i = 0; i < ETHOSU_JOB_QUEUE_SIZE; i++)
+    {
+        CHECK(ethosu_wait(drv, true) == 0);
+    }
+
+    CHECK(num_begun == ETHOSU_JOB_QUEUE_SIZE);
+    for (int i = 0; i < ETHOSU_JOB_QUEUE_SIZE; i++)
+    {
+        CHECK(begun[i] == (uintptr_t)i + 1);
+    }
+
+    return 0;
+}
+
+static int test_queue_release(struct ethosu_driver *expected)
+{
+    uint64_t base_addr[1]     = {(uintptr_t)region};
+    const size_t base_size[1] = {sizeof(region)};
+    struct ethosu_driver *drv;
+
+    test_reset();
+
+    drv = ethosu_reserve_driver();
+    CHECK(drv == expected);
+
+    for (uintptr_t i = 0; i < ETHOSU_JOB_QUEUE_SIZE; i++)
+    {
+        CHECK(ethosu_invoke_prepared_callback(drv, &net, base_addr, base_size, 1, (void *)(i + 1), test_callback) ==
+              0);
+    }
+
+    // None of the jobs has completed, so all of them fail
+    ethosu_release_driver(drv);
+
+    CHECK(!drv->reserved);
+    CHECK(num_completed == ETHOSU_JOB_QUEUE_SIZE);
+    for (int i = 0; i < ETHOSU_JOB_QUEUE_SIZE; i++)
+    {
+        CHECK(completed[i] == (uintptr_t)i + 1);
+        CHECK(results[i] == -1);
+    }
+
+    // The NPU runs jobs again after the release
+    CHECK(ethosu_invoke_prepared(drv, &net, base_addr, base_size, 1, NULL) == 0);
+
+    return 0;
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(void)
+{
+    const struct ethosu_sim_config config = {.latency_us = TEST_LATENCY_US, .cycles_per_us = 100};
+    const int custom_data_size            = (2 + TEST_CMS_WORDS) * sizeof(uint32_t);
+    static struct ethosu_driver drv;
+    struct ethosu_sim *sim;
+    int ret = 0;
+
+    sim = ethosu_sim_create(&config);
+    if (sim == NULL || ethosu_init(&drv, ethosu_sim_base_address(sim), NULL, 0, 0, 0) < 0 ||
+        ethosu_sim_start(sim, &drv) < 0)
+    {
+        printf("Failed to initialize NPU\n");
+        return 1;
+    }
+
+    custom_data[0] = TEST_COP_FOURCC;
+    custom_data[1] = TEST_COP_COMMAND_STREAM | TEST_CMS_WORDS << 16;
+
+    // The simulator does not execute the command stream, zero words are NPU_OP_STOP
+    memset(&custom_data[2], 0, TEST_CMS_WORDS * sizeof(uint32_t));
+
+    if (ethosu_prepare(&drv, &net, custom_data, custom_data_size) < 0)
+    {
+        printf("Failed to prepare network\n");
+        return 1;
+    }
+
+    if (test_queue_order(&drv) != 0)
+    {
+        printf("%-16s %s\n", "queue_order", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "queue_order", "PASS");
+    }
+
+    if (test_queue_release(&drv) != 0)
+    {
+        printf("%-16s %s\n", "queue_release", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "queue_release", "PASS");
+    }
+
+    ethosu_deinit(&drv);
+    ethosu_sim_destroy(sim);
+
+    return ret;
+}
@@ -0,0 +1,142 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test of a PMU overflow interrupt raised while the NPU is running. The
+ * interrupt must be cleared without completing the job, and the overflow must
+ * be counted in the 64-bit counter total.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_sim.h"
+#include "pmu_ethosu.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define TEST_COP_FOURCC ('1' << 24 | 'P' << 16 | 'O' << 8 | 'C')
+#define TEST_COP_COMMAND_STREAM 2
+#define TEST_CMS_WORDS 4
+
+#define TEST_LATENCY_US 20000
+#define TEST_CYCLES_PER_US 100
+#define TEST_JOB_CYCLES ((uint64_t)TEST_LATENCY_US * TEST_CYCLES_PER_US)
+
+// Overflow after a tenth of the job
+#define TEST_COUNTER_START (UINT32_MAX - (uint32_t)(TEST_JOB_CYCLES / 10))
+
+#define CHECK(cond)                                                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond);                                            \
+            return -1;                                                                                                 \
+        }                                                                                                              \
+    } while (0)
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+// The command stream after the two word header must be 16 byte aligned
+static uint32_t custom_data_buf[4 + TEST_CMS_WORDS] __attribute__((aligned(16)));
+static uint32_t *const custom_data = &custom_data_buf[2];
+static uint8_t region[256] __attribute__((aligned(16)));
+static uint64_t counter_total;
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+void ethosu_inference_begin(struct ethosu_driver *drv, void *user_arg)
+{
+    (void)user_arg;
+
+    ETHOSU_PMU_Enable(drv);
+    ETHOSU_PMU_Set_EVTYPER(drv, 0, ETHOSU_PMU_CYCLE);
+    ETHOSU_PMU_Set_EVCNTR(drv, 0, TEST_COUNTER_START);
+    ETHOSU_PMU_CNTR_Enable(drv, ETHOSU_PMU_CNT1_Msk);
+}
+
+void ethosu_inference_end(struct ethosu_driver *drv, void *user_arg)
+{
+    (void)user_arg;
+
+    counter_total = ETHOSU_PMU_Get_EVCNTR_Total(drv, 0);
+    ETHOSU_PMU_Disable(drv);
+}
+
+static int test_pmu_irq(struct ethosu_driver *drv, struct ethosu_sim *sim)
+{
+    uint64_t base_addr[1]      = {(uintptr_t)region};
+    const size_t base_size[1]  = {sizeof(region)};
+    const int custom_data_size = (2 + TEST_CMS_WORDS) * sizeof(uint32_t);
+    struct ethosu_sim_stats stats;
+
+    custom_data[0] = TEST_COP_FOURCC;
+    custom_data[1] = TEST_COP_COMMAND_STREAM | TEST_CMS_WORDS << 16;
+
+    // The simulator does not execute the command stream, zero words are NPU_OP_STOP
+    memset(&custom_data[2], 0, TEST_CMS_WORDS * sizeof(uint32_t));
+
+    CHECK(ethosu_invoke_v3(drv, custom_data, custom_data_size, base_addr, base_size, 1, NULL) == 0);
+
+    ethosu_sim_get_stats(sim, &stats);
+    CHECK(stats.pmu_irqs == 1);
+    CHECK(stats.completed == 1);
+    CHECK(counter_total == TEST_COUNTER_START + TEST_JOB_CYCLES);
+
+    return 0;
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(void)
+{
+    const struct ethosu_sim_config config = {.latency_us = TEST_LATENCY_US, .cycles_per_us = TEST_CYCLES_PER_US};
+    static struct ethosu_driver drv;
+    struct ethosu_sim *sim;
+    int ret;
+
+    sim = ethosu_sim_create(&config);
+    if (sim == NULL || ethosu_init(&drv, ethosu_sim_base_address(sim), NULL, 0, 0, 0) < 0 ||
+        ethosu_sim_start(sim, &drv) < 0)
+    {
+        printf("Failed to initialize NPU\n");
+        return 1;
+    }
+
+    ret = test_pmu_irq(&drv, sim);
+    printf("%-16s %s\n", "pmu_irq", ret == 0 ? "PASS" : "FAIL");
+
+    ethosu_deinit(&drv);
+    ethosu_sim_destroy(sim);
+
+    return ret == 0 ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test of driver reservation with priorities. Threads waiting for the only
+ * driver must be handed it in order of priority, and in order of arrival
+ * between threads with the same priority, also when the semaphores of
+ * earlier waiters are reused. A newly registered driver must be handed to a
+ * waiting thread.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_sim.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define TEST_NUM_WAITERS 5
+
+// Time for a thread to start waiting for a driver
+#define TEST_WAIT_US 50000
+
+#define CHECK(cond)                                                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond);                                            \
+            return -1;                                                                                                 \
+        }                                                                                                              \
+    } while (0)
+
+/******************************************************************************
+ * Types
+ ******************************************************************************/
+
+struct test_waiter
+{
+    pthread_t thread;
+    int index;
+    int priority;
+    struct ethosu_driver *drv;
+};
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+static pthread_mutex_t order_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int order[TEST_NUM_WAITERS];
+static int num_order;
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+static void *test_waiter_thread(void *arg)
+{
+    struct test_waiter *waiter = arg;
+
+    waiter->drv = ethosu_reserve_driver_priority(waiter->priority);
+
+    pthread_mutex_lock(&order_mutex);
+    order[num_order++] = waiter->index;
+    pthread_mutex_unlock(&order_mutex);
+
+    ethosu_release_driver(waiter->drv);
+
+    return NULL;
+}
+
+static int test_priority_order(struct ethosu_driver *expected)
+{
+    static const int priority[TEST_NUM_WAITERS]       = {0, 10, 5, 10, -1};
+    static const int expected_order[TEST_NUM_WAITERS] = {1, 3, 2, 0, 4};
+    struct test_waiter waiter[TEST_NUM_WAITERS];
+    struct ethosu_driver *drv;
+
+    num_order = 0;
+
+    drv = ethosu_reserve_driver();
+    CHECK(drv == expected);
+
+    for (int i = 0; i < TEST_NUM_WAITERS; i++)
+    {
+        waiter[i].index    = i;
+        waiter[i].priority = priority[i];
+        waiter[i].drv      = NULL;
+        CHECK(pthread_create(&waiter[i].thread, NULL, test_waiter_thread, &waiter[i]) == 0);
+        usleep(TEST_WAIT_US);
+    }
+
+    CHECK(num_order == 0);
+    ethosu_release_driver(drv);
+
+    for (int i = 0; i < TEST_NUM_WAITERS; i++)
+    {
+        pthread_join(waiter[i].thread, NULL);
+        CHECK(waiter[i].drv == expected);
+    }
+
+    CHECK(num_order == TEST_NUM_WAITERS);
+    for (int i = 0; i < TEST_NUM_WAITERS; i++)
+    {
+        CHECK(order[i] == expected_order[i]);
+    }
+
+    return 0;
+}
+
+static int test_register_handover(struct ethosu_driver *first, struct ethosu_driver *second, struct ethosu_sim *sim)
+{
+    struct test_waiter waiter = {.index = 0, .priority = 0, .drv = NULL};
+    struct ethosu_driver *drv;
+
+    num_order = 0;
+
+    drv = ethosu_reserve_driver();
+    CHECK(drv == first);
+
+    CHECK(pthread_create(&waiter.thread, NULL, test_waiter_thread, &waiter) == 0);
+    usleep(TEST_WAIT_US);
+    CHECK(num_order == 0);
+
+    // The new driver goes to the waiting thread
+    CHECK(ethosu_init(second, ethosu_sim_base_address(sim), NULL, 0, 0, 0) == 0);
+    CHECK(ethosu_sim_start(sim, second) == 0);
+
+    pthread_join(waiter.thread, NULL);
+    CHECK(waiter.drv == second);
+    CHECK(!second->reserved);
+
+    ethosu_release_driver(drv);
+
+    return 0;
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(void)
+{
+    const struct ethosu_sim_config config = {.latency_us = 1000, .cycles_per_us = 100};
+    static struct ethosu_driver drv;
+    static struct ethosu_driver drv2;
+    struct ethosu_sim *sim;
+    struct ethosu_sim *sim2;
+    int ret = 0;
+
+    sim  = ethosu_sim_create(&config);
+    sim2 = ethosu_sim_create(&config);
+    if (sim == NULL || sim2 == NULL || ethosu_init(&drv, ethosu_sim_base_address(sim), NULL, 0, 0, 0) < 0 ||
+        ethosu_sim_start(sim, &drv) < 0)
+    {
+        printf("Failed to initialize NPU\n");
+        return 1;
+    }
+
+    // The second round reuses the semaphores of the first one
+    for (int i = 0; i < 2; i++)
+    {
+        if (test_priority_order(&drv) != 0)
+        {
+            printf("%-16s %s\n", "priority_order", "FAIL");
+            ret = 1;
+        }
+        else
+        {
+            printf("%-16s %s\n", "priority_order", "PASS");
+        }
+    }
+
+    if (test_register_handover(&drv, &drv2, sim2) != 0)
+    {
+        printf("%-16s %s\n", "handover", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "handover", "PASS");
+    }
+
+    ethosu_deinit(&drv2);
+    ethosu_deinit(&drv);
+    ethosu_sim_destroy(sim2);
+    ethosu_sim_destroy(sim);
+
+    return ret;
+}
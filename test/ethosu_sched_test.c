@@ -0,0 +1,246 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test of the scheduler. For the NPU selection, jobs are queued directly on
+ * three scheduled NPUs, and a job is then invoked through the scheduler. The
+ * NPU with the least cycles left must be selected when the cycles of all
+ * queued jobs are known, and the NPU with the shortest queue otherwise.
+ *
+ * ethosu_sched_poll() must finish up only the completed jobs when not
+ * blocking, and wait for all jobs when blocking.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_sim.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define TEST_COP_FOURCC ('1' << 24 | 'P' << 16 | 'O' << 8 | 'C')
+#define TEST_COP_COMMAND_STREAM 2
+#define TEST_CMS_WORDS 4
+
+#define TEST_NUM_NPUS 3
+#define TEST_LATENCY_US 50000
+
+#define TEST_LONG_CYCLES 1000000
+#define TEST_SHORT_CYCLES 1000
+
+#define CHECK(cond)                                                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond);                                            \
+            return -1;                                                                                                 \
+        }                                                                                                              \
+    } while (0)
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+// The command stream after the two word header must be 16 byte aligned
+static uint32_t custom_data_buf[4 + TEST_CMS_WORDS] __attribute__((aligned(16)));
+static uint32_t *const custom_data = &custom_data_buf[2];
+static uint8_t region[256] __attribute__((aligned(16)));
+
+static struct ethosu_driver drv[TEST_NUM_NPUS];
+static struct ethosu_network long_net;
+static struct ethosu_network short_net;
+static struct ethosu_network unknown_net;
+static struct ethosu_driver *selected;
+static int num_callbacks;
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+static void test_callback(struct ethosu_driver *callback_drv, int result, void *user_arg)
+{
+    (void)user_arg;
+
+    if (result == 0)
+    {
+        selected = callback_drv;
+        num_callbacks++;
+    }
+}
+
+static int test_queue(struct ethosu_driver *queue_drv, struct ethosu_network *net)
+{
+    uint64_t base_addr[1]     = {(uintptr_t)region};
+    const size_t base_size[1] = {sizeof(region)};
+
+    return ethosu_invoke_prepared_async(queue_drv, net, base_addr, base_size, 1, NULL);
+}
+
+static int test_sched(struct ethosu_driver *expected, int queued)
+{
+    uint64_t base_addr[1]     = {(uintptr_t)region};
+    const size_t base_size[1] = {sizeof(region)};
+
+    selected = NULL;
+    CHECK(ethosu_sched_invoke(&short_net, base_addr, base_size, 1, NULL, test_callback) == 0);
+    CHECK(ethosu_sched_poll(true) == queued + 1);
+    CHECK(selected == expected);
+
+    return 0;
+}
+
+static int test_sched_cycles(void)
+{
+    // Cycles left 1000000, 2000 and 2000000. Shortest queue on the first NPU.
+    CHECK(test_queue(&drv[0], &long_net) == 0);
+    CHECK(test_queue(&drv[1], &short_net) == 0);
+    CHECK(test_queue(&drv[1], &short_net) == 0);
+    CHECK(test_queue(&drv[2], &long_net) == 0);
+    CHECK(test_queue(&drv[2], &long_net) == 0);
+
+    return test_sched(&drv[1], 5);
+}
+
+static int test_sched_load(void)
+{
+    // The cycles left on the last NPU are unknown, so the cycles of the
+    // others must not be compared either
+    CHECK(test_queue(&drv[0], &long_net) == 0);
+    CHECK(test_queue(&drv[1], &short_net) == 0);
+    CHECK(test_queue(&drv[1], &short_net) == 0);
+    CHECK(test_queue(&drv[2], &unknown_net) == 0);
+    CHECK(test_queue(&drv[2], &short_net) == 0);
+
+    return test_sched(&drv[0], 5);
+}
+
+static int test_sched_poll(void)
+{
+    uint64_t base_addr[1]     = {(uintptr_t)region};
+    const size_t base_size[1] = {sizeof(region)};
+
+    num_callbacks = 0;
+
+    // Nothing has completed yet
+    CHECK(ethosu_sched_invoke(&short_net, base_addr, base_size, 1, NULL, test_callback) == 0);
+    CHECK(ethosu_sched_invoke(&short_net, base_addr, base_size, 1, NULL, test_callback) == 0);
+    CHECK(ethosu_sched_poll(false) == 0);
+    CHECK(num_callbacks == 0);
+
+    // Completed jobs are finished up without blocking, several times over
+    for (int i = 0; i < 3; i++)
+    {
+        usleep(TEST_LATENCY_US * 2);
+        CHECK(ethosu_sched_poll(false) == 2);
+        CHECK(num_callbacks == 2 * (i + 1));
+        CHECK(ethosu_sched_poll(false) == 0);
+
+        CHECK(ethosu_sched_invoke(&short_net, base_addr, base_size, 1, NULL, test_callback) == 0);
+        CHECK(ethosu_sched_invoke(&short_net, base_addr, base_size, 1, NULL, test_callback) == 0);
+    }
+
+    // Blocking waits for the running jobs
+    CHECK(ethosu_sched_poll(true) == 2);
+    CHECK(num_callbacks == 8);
+    CHECK(ethosu_sched_poll(true) == 0);
+
+    return 0;
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(void)
+{
+    const struct ethosu_sim_config config = {.latency_us = TEST_LATENCY_US, .cycles_per_us = 100};
+    const int custom_data_size            = (2 + TEST_CMS_WORDS) * sizeof(uint32_t);
+    struct ethosu_sim *sim[TEST_NUM_NPUS];
+    int ret = 0;
+
+    // Drivers are registered first in the list, initialize the last NPU first
+    for (int i = TEST_NUM_NPUS - 1; i >= 0; i--)
+    {
+        sim[i] = ethosu_sim_create(&config);
+        if (sim[i] == NULL || ethosu_init(&drv[i], ethosu_sim_base_address(sim[i]), NULL, 0, 0, 0) < 0 ||
+            ethosu_sim_start(sim[i], &drv[i]) < 0)
+        {
+            printf("Failed to initialize NPU\n");
+            return 1;
+        }
+    }
+
+    custom_data[0] = TEST_COP_FOURCC;
+    custom_data[1] = TEST_COP_COMMAND_STREAM | TEST_CMS_WORDS << 16;
+
+    // The simulator does not execute the command stream, zero words are NPU_OP_STOP
+    memset(&custom_data[2], 0, TEST_CMS_WORDS * sizeof(uint32_t));
+
+    if (ethosu_prepare(&drv[0], &long_net, custom_data, custom_data_size) < 0 ||
+        ethosu_prepare(&drv[0], &short_net, custom_data, custom_data_size) < 0 ||
+        ethosu_prepare(&drv[0], &unknown_net, custom_data, custom_data_size) < 0 ||
+        ethosu_set_network_cycles(&long_net, TEST_LONG_CYCLES) < 0 ||
+        ethosu_set_network_cycles(&short_net, TEST_SHORT_CYCLES) < 0 || ethosu_sched_init(TEST_NUM_NPUS) < 0)
+    {
+        printf("Failed to initialize scheduler\n");
+        return 1;
+    }
+
+    if (ETHOSU_JOB_QUEUE_SIZE < 3)
+    {
+        printf("%-16s %s\n", "sched_select", "SKIP, requires ETHOSU_JOB_QUEUE_SIZE >= 3");
+    }
+    else if (test_sched_cycles() != 0 || test_sched_load() != 0)
+    {
+        printf("%-16s %s\n", "sched_select", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "sched_select", "PASS");
+    }
+
+    if (test_sched_poll() != 0)
+    {
+        printf("%-16s %s\n", "sched_poll", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "sched_poll", "PASS");
+    }
+
+    ethosu_sched_deinit();
+
+    for (int i = 0; i < TEST_NUM_NPUS; i++)
+    {
+        ethosu_deinit(&drv[i]);
+        ethosu_sim_destroy(sim[i]);
+    }
+
+    return ret;
+}
@@ -0,0 +1,225 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test of double buffered weight staging. The weights of three networks are
+ * staged in the two halves of the staging buffer. Weights still staged must
+ * not be copied again, a half used by a queued job must not be overwritten,
+ * and the weights must be read in place when both halves are in use.
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include "ethosu_driver.h"
+#include "ethosu_sim.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define TEST_COP_FOURCC ('1' << 24 | 'P' << 16 | 'O' << 8 | 'C')
+#define TEST_COP_COMMAND_STREAM 2
+#define TEST_CMS_WORDS 4
+
+#define TEST_LATENCY_US 20000
+#define TEST_NUM_NETWORKS 3
+#define TEST_WEIGHTS_SIZE 200
+
+// Each half of the staging buffer is rounded down to the cache line size
+#define TEST_STAGE_SIZE 1000
+#define TEST_STAGE_HALF 480
+
+#define CHECK(cond)                                                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond);                                            \
+            return -1;                                                                                                 \
+        }                                                                                                              \
+    } while (0)
+
+/******************************************************************************
+ * Variables
+ ******************************************************************************/
+
+// The command stream after the two word header must be 16 byte aligned
+static uint32_t custom_data_buf[4 + TEST_CMS_WORDS] __attribute__((aligned(16)));
+static uint32_t *const custom_data = &custom_data_buf[2];
+static uint8_t stage[TEST_STAGE_SIZE] __attribute__((aligned(32)));
+static uint8_t weights[TEST_NUM_NETWORKS][256] __attribute__((aligned(16)));
+static uint8_t activations[256] __attribute__((aligned(16)));
+
+static struct ethosu_network net[TEST_NUM_NETWORKS];
+
+/******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+static int test_invoke_async(struct ethosu_driver *drv, int index)
+{
+    uint64_t base_addr[2]     = {(uintptr_t)weights[index], (uintptr_t)activations};
+    const size_t base_size[2] = {sizeof(weights[index]), sizeof(activations)};
+
+    return ethosu_invoke_prepared_async(drv, &net[index], base_addr, base_size, 2, NULL);
+}
+
+static int test_invoke(struct ethosu_driver *drv, int index)
+{
+    if (test_invoke_async(drv, index) < 0)
+    {
+        return -1;
+    }
+
+    return ethosu_wait(drv, true);
+}
+
+static int test_staging_hit(struct ethosu_driver *drv)
+{
+    struct ethosu_weight_stats stats;
+
+    // Only the weights covered by the region access are copied
+    CHECK(test_invoke(drv, 0) == 0);
+    CHECK(stage[0] == 1 && stage[TEST_WEIGHTS_SIZE - 1] == 1 && stage[TEST_WEIGHTS_SIZE] == 0);
+
+    CHECK(test_invoke(drv, 0) == 0);
+    ethosu_get_weight_stats(drv, &stats);
+    CHECK(stats.copies == 1 && stats.hits == 1 && stats.misses == 0);
+
+    return 0;
+}
+
+static int test_staging_queued(struct ethosu_driver *drv)
+{
+    struct ethosu_weight_stats stats;
+
+    // The other half is filled, leaving the staged weights of the first network
+    CHECK(test_invoke_async(drv, 1) == 0);
+    CHECK(stage[TEST_STAGE_HALF] == 2);
+    CHECK(test_invoke_async(drv, 0) == 0);
+
+    ethosu_get_weight_stats(drv, &stats);
+    CHECK(stats.copies == 2 && stats.hits == 2 && stats.misses == 0);
+
+    // Both halves are used by queued jobs, so the weights are read in place
+    if (ETHOSU_JOB_QUEUE_SIZE > 2)
+    {
+        CHECK(test_invoke_async(drv, 2) == 0);
+        CHECK(stage[0] == 1 && stage[TEST_STAGE_HALF] == 2);
+
+        ethosu_get_weight_stats(drv, &stats);
+        CHECK(stats.copies == 2 && stats.misses == 1);
+        CHECK(ethosu_wait(drv, true) == 0);
+    }
+
+    CHECK(ethosu_wait(drv, true) == 0);
+    CHECK(ethosu_wait(drv, true) == 0);
+
+    // The least recently used half is replaced
+    CHECK(test_invoke(drv, 2) == 0);
+    CHECK(stage[0] == 1 && stage[TEST_STAGE_HALF] == 3);
+
+    return 0;
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(void)
+{
+    const struct ethosu_sim_config config = {.latency_us = TEST_LATENCY_US, .cycles_per_us = 100};
+    const int custom_data_size            = (2 + TEST_CMS_WORDS) * sizeof(uint32_t);
+    static struct ethosu_driver drv;
+    struct ethosu_sim *sim;
+    int ret = 0;
+
+    sim = ethosu_sim_create(&config);
+    if (sim == NULL || ethosu_init(&drv, ethosu_sim_base_address(sim), NULL, 0, 0, 0) < 0 ||
+        ethosu_sim_start(sim, &drv) < 0)
+    {
+        printf("Failed to initialize NPU\n");
+        return 1;
+    }
+
+    if (ETHOSU_JOB_QUEUE_SIZE < 2)
+    {
+        ret = ethosu_weight_staging_init(&drv, stage, sizeof(stage), 0) < 0 ? 0 : 1;
+        printf("%-16s %s\n", "weight_staging", ret == 0 ? "SKIP, requires ETHOSU_JOB_QUEUE_SIZE >= 2" : "FAIL");
+
+        ethosu_deinit(&drv);
+        ethosu_sim_destroy(sim);
+
+        return ret;
+    }
+
+    custom_data[0] = TEST_COP_FOURCC;
+    custom_data[1] = TEST_COP_COMMAND_STREAM | TEST_CMS_WORDS << 16;
+
+    // The simulator does not execute the command stream, zero words are NPU_OP_STOP
+    memset(&custom_data[2], 0, TEST_CMS_WORDS * sizeof(uint32_t));
+
+    if (ethosu_weight_staging_init(&drv, stage, sizeof(stage), 0) < 0)
+    {
+        printf("Failed to set up weight staging\n");
+        return 1;
+    }
+
+    for (int i = 0; i < TEST_NUM_NETWORKS; i++)
+    {
+        memset(weights[i], i + 1, sizeof(weights[i]));
+
+        if (ethosu_prepare(&drv, &net[i], custom_data, custom_data_size) < 0 ||
+            ethosu_set_region_access(&net[i], 0, ETHOSU_REGION_ACCESS_READ, 0, TEST_WEIGHTS_SIZE) < 0 ||
+            ethosu_set_weight_staging(&net[i], true) < 0)
+        {
+            printf("Failed to prepare network\n");
+            return 1;
+        }
+    }
+
+    if (test_staging_hit(&drv) != 0)
+    {
+        printf("%-16s %s\n", "staging_hit", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "staging_hit", "PASS");
+    }
+
+    if (test_staging_queued(&drv) != 0)
+    {
+        printf("%-16s %s\n", "staging_queued", "FAIL");
+        ret = 1;
+    }
+    else
+    {
+        printf("%-16s %s\n", "staging_queued", "PASS");
+    }
+
+    ethosu_deinit(&drv);
+    ethosu_sim_destroy(sim);
+
+    return ret;
+}
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+#
+# SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""
+Format a dump of Ethos-U driver log records, as copied by ethosu_log_read(),
+using the format strings of the application image the records were written by.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# struct ethosu_log_record, little endian
+ETHOSU_LOG_MAX_ARGS = 8
+RECORD = struct.Struct("<IIQ%dQ" % ETHOSU_LOG_MAX_ARGS)
+
+FLAG_NUM_ARGS_MASK = 0xff
+FLAG_TRUNCATED = 1 << 9
+
+CONVERSION = re.compile(r"%([-+ #0-9.*]*)(hh|h|ll|l|z|j|t)?([diouxXcpsfFeEgGaA%])")
+
+PT_LOAD = 1
+
+
+class Image:
+    """Read memory of an ELF image, from the file contents of its loadable segments."""
+
+    def __init__(self, data):
+        if data[:4] != b"\x7fELF":
+            raise ValueError("Not an ELF file")
+
+        if data[4] == 1:
+            phoff, = struct.unpack_from("<I", data, 28)
+            phentsize, phnum = struct.unpack_from("<HH", data, 42)
+            segment = struct.Struct("<IIIIIIII")
+        else:
+            phoff, = struct.unpack_from("<Q", data, 32)
+            phentsize, phnum = struct.unpack_from("<HH", data, 54)
+            segment = struct.Struct("<IIQQQQQQ")
+
+        self.data = data
+        self.segments = []
+
+        for i in range(phnum):
+            fields = segment.unpack_from(data, phoff + i * phentsize)
+            if data[4] == 1:
+                p_type, p_offset, p_vaddr, p_paddr, p_filesz = fields[:5]
+            else:
+                p_type, _, p_offset, p_vaddr, p_paddr, p_filesz = fields[:6]
+
+            if p_type == PT_LOAD:
+                self.segments.append((p_vaddr, p_offset, p_filesz))
+                if p_paddr != p_vaddr:
+                    self.segments.append((p_paddr, p_offset, p_filesz))
+
+    def string(self, address):
+        for vaddr, offset, size in self.segments:
+            if vaddr <= address < vaddr + size:
+                start = offset + address - vaddr
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("utf-8", errors="replace")
+
+        return None
+
+
+def signed(value):
+    return value - (1 << 64) if value >= 1 << 63 else value
+
+
+def expand_stars(flags, stars):
+    """Replace each '*' in the flags with its field width or precision argument."""
+    out = ""
+    for c in flags:
+        if c != "*":
+            out += c
+            continue
+
+        value = signed(stars.pop(0))
+        if value < 0 and out.endswith("."):
+            # A negative precision is taken as if the precision were omitted
+            out = out[:-1]
+        else:
+            out += str(value)
+
+    return out
+
+
+def format_arg(image, flags, conversion, value):
+    if conversion in "di":
+        return "%" + flags + "d", signed(value)
+    if conversion in "ouxXc":
+        return "%" + flags + conversion, value
+    if conversion == "p":
+        return "%s", "0x%x" % value
+    if conversion == "s":
+        string = image.string(value)
+        return "%" + flags + "s", string if string is not None else "<0x%x>" % value
+
+    return "%" + flags + conversion, struct.unpack("<d", struct.pack("<Q", value))[0]
+
+
+def format_record(image, flags, format_address, args):
+    fmt = image.string(format_address)
+    if fmt is None:
+        return "<unknown format 0x%x>\n" % format_address
+
+    num_args = flags & FLAG_NUM_ARGS_MASK
+    pos = 0
+    out = []
+    i = 0
+
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[pos:match.start()])
+        pos = match.end()
+
+        if match.group(3) == "%":
+            out.append("%")
+        elif i + match.group(1).count("*") < num_args:
+            num_stars = match.group(1).count("*")
+            flags = expand_stars(match.group(1), list(args[i:i + num_stars]))
+            spec, value = format_arg(image, flags, match.group(3), args[i + num_stars])
+            out.append(spec % value)
+            i += num_stars + 1
+        else:
+            out.append(match.group(0))
+
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def decode(image, data, output):
+    if len(data) % RECORD.size != 0:
+        raise ValueError("Dump size %d is not a multiple of the record size %d" % (len(data), RECORD.size))
+
+    records = []
+    for offset in range(0, len(data), RECORD.size):
+        sequence, flags, format_address, *args = RECORD.unpack_from(data, offset)
+        if sequence != 0:
+            records.append((sequence, flags, format_address, args))
+
+    for sequence, flags, format_address, args in sorted(records):
+        message = format_record(image, flags, format_address, args)
+        if flags & FLAG_TRUNCATED:
+            message = message.rstrip("\n") + " <truncated>\n"
+        output.write(message)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("elf", help="ELF image of the application, with the driver format strings")
+    parser.add_argument("dump", help="Binary dump of log records")
+    parser.add_argument("-o", "--output", help="Output file, stdout if not given")
+    args = parser.parse_args()
+
+    with open(args.elf, "rb") as f:
+        image = Image(f.read())
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+
+    if args.output:
+        with open(args.output, "w") as f:
+            decode(image, data, f)
+    else:
+        decode(image, data, sys.stdout)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+#
+# SPDX-FileCopyrightText: Copyright 2025 Arm Limited and/or its affiliates <open-source-office@arm.com>
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""
+Convert a dump of Ethos-U driver trace records, as copied by ethosu_trace_read(),
+to the Chrome trace event format, which can be opened in Perfetto or
+chrome://tracing.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+# struct ethosu_trace_record, little endian
+RECORD = struct.Struct("<IIQQQQ")
+
+# enum ethosu_trace_event: name, phase and argument names. Begin and end events
+# are paired to slices, the other events are instants.
+EVENTS = {
+    1: ("invoke", "i", ("custom_data", "num_base_addr")),
+    2: ("cop_parse", "B", ("custom_data", "custom_data_size")),
+    3: ("cop_parse", "E", ("result", "cms_length")),
+    4: ("power_request", "i", ("requests", "idle")),
+    5: ("power_release", "i", ("requests",)),
+    6: ("program", "B", ("cmd_stream", "cms_length")),
+    7: ("program", "E", ("num_base_addr",)),
+    8: ("irq", "B", ()),
+    9: ("irq", "E", ("result",)),
+    10: ("wait", "B", ("job_state", "block")),
+    11: ("wait", "E", ("result",)),
+    12: ("release", "i", ("jobs",)),
+    13: ("fast_memory_save", "i", ("custom_data", "size")),
+    14: ("fast_memory_restore", "i", ("custom_data", "size")),
+    15: ("reserve", "i", ("priority", "waited")),
+}
+
+ADDRESS_ARGS = ("custom_data", "cmd_stream")
+
+
+def signed(value):
+    return value - (1 << 64) if value >= 1 << 63 else value
+
+
+def read_records(data):
+    if len(data) % RECORD.size != 0:
+        raise ValueError("Dump size %d is not a multiple of the record size %d" % (len(data), RECORD.size))
+
+    for offset in range(0, len(data), RECORD.size):
+        sequence, event, timestamp, drv, arg0, arg1 = RECORD.unpack_from(data, offset)
+        if sequence != 0:
+            yield sequence, event, timestamp, drv, (arg0, arg1)
+
+
+def decode(data, ticks_per_us):
+    records = sorted(read_records(data))
+    npus = {}
+    trace = []
+
+    for sequence, event, timestamp, drv, args in records:
+        if drv not in npus:
+            npus[drv] = len(npus)
+            trace.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": npus[drv],
+                          "args": {"name": "NPU driver 0x%x" % drv}})
+
+        name, phase, arg_names = EVENTS.get(event, ("event_%d" % event, "i", ("arg0", "arg1")))
+        entry = {"name": name, "ph": phase, "ts": timestamp / ticks_per_us, "pid": 0, "tid": npus[drv],
+                 "args": {"sequence": sequence - 1}}
+
+        for arg_name, value in zip(arg_names, args):
+            entry["args"][arg_name] = "0x%x" % value if arg_name in ADDRESS_ARGS else signed(value)
+
+        if phase == "i":
+            entry["s"] = "t"
+
+        trace.append(entry)
+
+    return {"traceEvents": trace, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("dump", help="Binary dump of trace records")
+    parser.add_argument("-o", "--output", help="Output file, stdout if not given")
+    parser.add_argument("--ticks-per-us", type=float, default=1.0,
+                        help="Timestamp ticks per microsecond, for example the CPU clock in MHz (default: 1)")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        trace = decode(f.read(), args.ticks_per_us)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f, indent=1)
+    else:
+        json.dump(trace, sys.stdout, indent=1)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())